@@ -1045,7 +1045,8 @@ read_interfile_PDFS_SPECT(istream& input,
        return 0;
      }
 
-   return new ProjDataFromStream(hdr.get_exam_info_sptr(), 
+   ProjDataFromStream * const proj_data_ptr =
+     new ProjDataFromStream(hdr.get_exam_info_sptr(), 
 				 hdr.data_info_sptr,
 				 data_in,
 				 hdr.data_offset_each_dataset[0],
@@ -1054,6 +1055,10 @@ read_interfile_PDFS_SPECT(istream& input,
 				 hdr.type_of_numbers,
 				 hdr.file_byte_order,
 				 static_cast<float>(hdr.image_scaling_factors[0][0]));
+   // threads can read in parallel if nobody writes
+   if (!(open_mode & ios::out))
+     proj_data_ptr->set_filename_for_concurrent_reading(full_data_file_name);
+   return proj_data_ptr;
 
 
 }
@@ -1087,7 +1092,8 @@ read_interfile_PDFS_Siemens(istream& input,
   if (hdr.compression)
     warning("Siemens projection data is compressed. Reading of raw data will fail.");
 
-  return new ProjDataFromStream(hdr.get_exam_info_sptr(),
+  ProjDataFromStream * const proj_data_ptr =
+    new ProjDataFromStream(hdr.get_exam_info_sptr(),
     hdr.data_info_ptr->create_shared_clone(),
     data_in,
     hdr.data_offset_each_dataset[0],
@@ -1096,6 +1102,10 @@ read_interfile_PDFS_Siemens(istream& input,
     hdr.type_of_numbers,
     hdr.file_byte_order,
     1.);
+  // threads can read in parallel if nobody writes
+  if (!(open_mode & ios::out))
+    proj_data_ptr->set_filename_for_concurrent_reading(full_data_file_name);
+  return proj_data_ptr;
 
 }
 
@@ -1160,7 +1170,8 @@ read_interfile_PDFS(istream& input,
        return 0;
      }
 
-   return new ProjDataFromStream(hdr.get_exam_info_sptr(),
+   ProjDataFromStream * const proj_data_ptr =
+     new ProjDataFromStream(hdr.get_exam_info_sptr(),
 				 hdr.data_info_sptr->create_shared_clone(),
 				 data_in,
 				 hdr.data_offset_each_dataset[0],
@@ -1169,6 +1180,10 @@ read_interfile_PDFS(istream& input,
 				 hdr.type_of_numbers,
 				 hdr.file_byte_order,
 				 static_cast<float>(hdr.image_scaling_factors[0][0]));
+   // threads can read in parallel if nobody writes
+   if (!(open_mode & ios::out))
+     proj_data_ptr->set_filename_for_concurrent_reading(full_data_file_name);
+   return proj_data_ptr;
 
 
 }
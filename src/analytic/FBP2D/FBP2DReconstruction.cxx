@@ -315,14 +315,9 @@ actual_reconstruct(shared_ptr<DiscretisedDensity<3,float> > const & density_ptr)
         if (!symmetries_sptr->is_basic(vs_num))
           continue;
 
-        RelatedViewgrams<float> viewgrams;
-#ifdef STIR_OPENMP
-#pragma omp critical(FBP2D_get_viewgrams)
-#endif
-        {
-          viewgrams =
-            proj_data_ptr->get_related_viewgrams(vs_num, symmetries_sptr);   
-        }
+        // no critical section needed, ProjData handles concurrent reads
+        RelatedViewgrams<float> viewgrams =
+          proj_data_ptr->get_related_viewgrams(vs_num, symmetries_sptr);
 
         if (do_arc_correction)
           viewgrams =
@@ -8,10 +8,12 @@
 
   \author Kris Thielemans
   \author Sanida Mustafovic
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2001- 2010, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -158,9 +160,30 @@ do_it(Array<1,elemT>& out_array, const Array<1,elemT>& in_array) const
   const int j_min = filter_coefficients.get_min_index();
   const int j_max = filter_coefficients.get_max_index();
 
+  // range of i for which all in_array[i-j] exist, i.e. where the boundary conditions are irrelevant
+  const int interior_min = max(out_min, in_min + j_max);
+  const int interior_max = min(out_max, in_max + j_min);
 
   for (int i=out_min; i<=out_max; i++) 
   {
+    if (i == interior_min && interior_min <= interior_max)
+      {
+        // Handle the whole interior at once. The loop over j is outside such that
+        // the inner loop can be vectorised. The summation order is as below.
+        elemT * const out_ptr = &out_array[interior_min];
+        const int length = interior_max - interior_min + 1;
+        for (int k=0; k<length; ++k)
+          out_ptr[k] = 0;
+        for (int j=j_min; j<=j_max; ++j)
+          {
+            const elemT coefficient = filter_coefficients[j];
+            const elemT * const in_ptr = &in_array[interior_min - j];
+            for (int k=0; k<length; ++k)
+              out_ptr[k] += coefficient*in_ptr[k];
+          }
+        i = interior_max;
+        continue;
+      }
     out_array[i] = 0;
     int j=j_min;
     // first do right edge
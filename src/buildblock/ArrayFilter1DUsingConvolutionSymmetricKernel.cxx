@@ -8,10 +8,12 @@
 
   \author Kris Thielemans
   \author Sanida Mustafovic
+  \author STIR developers
   
 */
 /*
     Copyright (C) 2000- 2009, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -77,9 +79,35 @@ do_it(Array<1,elemT>& out_array, const Array<1,elemT>& in_array) const
   const int in_max = in_array.get_max_index();
   const int j_max = filter_coefficients.get_max_index();
 
+  // range of i for which all in_array[i-j] and in_array[i+j] exist
+  const int interior_min = in_min + j_max;
+  const int interior_max = in_max - j_max;
+
   for (int i=in_array.get_min_index(); 
        i<=in_array.get_max_index(); i++) 
   {
+    if (i == interior_min && interior_min <= interior_max)
+      {
+        // Handle the whole interior at once, exploiting the symmetry of the kernel.
+        // The loop over j is outside such that the inner loop can be vectorised.
+        // The summation order is as below.
+        elemT * const out_ptr = &out_array[interior_min];
+        const elemT * const in_ptr = &in_array[interior_min];
+        const int length = interior_max - interior_min + 1;
+        const elemT coefficient0 = filter_coefficients[0];
+        for (int k=0; k<length; ++k)
+          out_ptr[k] = coefficient0*in_ptr[k];
+        for (int j=1; j<=j_max; ++j)
+          {
+            const elemT coefficient = filter_coefficients[j];
+            const elemT * const in_left_ptr = in_ptr - j;
+            const elemT * const in_right_ptr = in_ptr + j;
+            for (int k=0; k<length; ++k)
+              out_ptr[k] += coefficient*(in_left_ptr[k] + in_right_ptr[k]);
+          }
+        i = interior_max;
+        continue;
+      }
     out_array[i] = filter_coefficients[0]*in_array[i];
     int j=1;
     // first do range where both i-j and i+j indices are valid for in_array
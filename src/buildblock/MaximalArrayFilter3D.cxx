@@ -1,6 +1,7 @@
 /*
  Copyright (C) 2006 - 2007, Hammersmith Imanet Ltd
  Copyright (C) 2010 - 2013, King's College London
+ Copyright (C) 2026, STIR developers
  This file is part of STIR.
  
  This file is free software; you can redistribute it and/or modify
@@ -22,15 +23,71 @@
 
   \author Charalampos Tsoumpas
   \author Kris Thielemans
+  \author STIR developers
 
 */
 #include "stir/MaximalArrayFilter3D.h"
 #include "stir/Coordinate3D.h"
+#include "stir/ArrayFunction.h"
 #include <algorithm>
 #include <numeric>
+#include <limits>
+#include <vector>
 
 START_NAMESPACE_STIR
 
+namespace detail {
+
+/* Function object that replaces every element of a 1D array by the maximum over
+   the 2*radius+1 elements centred on it (ignoring elements outside the array).
+
+   This uses the van Herk/Gil-Werman algorithm: the (padded) array is divided in
+   blocks of the window size, and the maximum over a window is found from the
+   running maxima to the end of one block and from the start of the next.
+   This needs about 3 comparisons per element, independent of the radius.
+*/
+template <typename elemT>
+class RunningMaximum1D
+{
+public:
+  explicit RunningMaximum1D(const int radius)
+    : radius(radius)
+  {}
+
+  void operator()(Array<1,elemT>& array) const
+  {
+    if (radius <= 0)
+      return;
+    const int window_size = 2*radius + 1;
+    // pad on both sides with the lowest value, up to a multiple of the window size
+    const int num_blocks = (array.get_length() + 2*radius + window_size - 1)/window_size;
+    const int padded_length = num_blocks*window_size;
+    std::vector<elemT> padded(padded_length, std::numeric_limits<elemT>::lowest());
+    std::copy(array.begin(), array.end(), padded.begin() + radius);
+
+    std::vector<elemT> max_from_block_start(padded);
+    std::vector<elemT> max_to_block_end(padded);
+    for (int block_start=0; block_start<padded_length; block_start+=window_size)
+      {
+        const int block_end = block_start + window_size - 1;
+        for (int k=block_start+1; k<=block_end; ++k)
+          max_from_block_start[k] = std::max(max_from_block_start[k-1], padded[k]);
+        for (int k=block_end-1; k>=block_start; --k)
+          max_to_block_end[k] = std::max(max_to_block_end[k+1], padded[k]);
+      }
+
+    // the window for the k-th element is padded[k]...padded[k+window_size-1]
+    int k = 0;
+    for (typename Array<1,elemT>::iterator iter=array.begin(); iter!=array.end(); ++iter, ++k)
+      *iter = std::max(max_to_block_end[k], max_from_block_start[k+window_size-1]);
+  }
+
+private:
+  const int radius;
+};
+
+} // end of namespace detail
+
 template <typename elemT>
 MaximalArrayFilter3D<elemT>::MaximalArrayFilter3D(const Coordinate3D<int>& mask_radius)
 {
@@ -83,6 +140,23 @@ do_it(Array<3,elemT>& out_array, const Array<3,elemT>& in_array) const
 {
   assert(out_array.get_index_range() == in_array.get_index_range());
 
+  if (out_array.is_regular() && out_array.is_contiguous())
+    {
+      // The maximum over the mask is the maximum over its rows (taking the edges into
+      // account in the same way), so we can find it using 1D running maxima along each dimension.
+      std::copy(in_array.begin_all(), in_array.end_all(), out_array.begin_all());
+      const detail::RunningMaximum1D<elemT> max_z(mask_radius_z);
+      const detail::RunningMaximum1D<elemT> max_y(mask_radius_y);
+      const detail::RunningMaximum1D<elemT> max_x(mask_radius_x);
+      if (mask_radius_z > 0)
+        in_place_apply_array_function_on_index(out_array, 1, &max_z);
+      if (mask_radius_y > 0)
+        in_place_apply_array_function_on_index(out_array, 2, &max_y);
+      if (mask_radius_x > 0)
+        in_place_apply_array_function_on_index(out_array, 3, &max_x);
+      return;
+    }
+
   Array<1,elemT> neighbours (0,(2*mask_radius_x+1)*(2*mask_radius_y+1)*(2*mask_radius_z+1)-1);
 
   for (int z=out_array.get_min_index();z<= out_array.get_max_index();++z)
@@ -8,10 +8,12 @@
 
   \author Sanida Mustafovic
   \author Kris Thielemans
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2000- 2009, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -104,23 +106,40 @@ do_it(Array<3,elemT>& out_array, const Array<3,elemT>& in_array) const
 {
   assert(out_array.get_index_range() == in_array.get_index_range());
 
-  Array<1,elemT> neighbours (0,(2*mask_radius_x+1)*(2*mask_radius_y+1)*(2*mask_radius_z+1)-1);
-
-  for (int z=out_array.get_min_index();z<= out_array.get_max_index();++z)
-   for (int y=out_array[z].get_min_index();y <= out_array[z].get_max_index();++y)
-     for (int x=out_array[z][y].get_min_index();x <= out_array[z][y].get_max_index();++x)
-     {
-       const int num_neighbours =
-	 extract_neighbours(neighbours,in_array,Coordinate3D<int>(z,y,x));
-       if (num_neighbours==0)
-         continue;
-       nth_element(neighbours.begin(), neighbours.begin()+num_neighbours/2, neighbours.end());
-       if (num_neighbours%2==1)
-	 out_array[z][y][x] = neighbours[num_neighbours/2]; 
-       else
-	 out_array[z][y][x] = (neighbours[num_neighbours/2]+
-			       neighbours[num_neighbours/2 - 1])/2; 
-     } 
+  const int max_num_neighbours = (2*mask_radius_x+1)*(2*mask_radius_y+1)*(2*mask_radius_z+1);
+  const int min_z = out_array.get_min_index();
+  const int max_z = out_array.get_max_index();
+
+  // planes are independent, so we distribute them over the threads
+#ifdef STIR_OPENMP
+#pragma omp parallel
+#endif
+  {
+    Array<1,elemT> neighbours (0, max_num_neighbours-1);
+#ifdef STIR_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int z=min_z;z<= max_z;++z)
+     for (int y=out_array[z].get_min_index();y <= out_array[z].get_max_index();++y)
+       for (int x=out_array[z][y].get_min_index();x <= out_array[z][y].get_max_index();++x)
+       {
+         const int num_neighbours =
+	   extract_neighbours(neighbours,in_array,Coordinate3D<int>(z,y,x));
+         if (num_neighbours==0)
+           continue;
+         // only use the neighbours that were filled in (at the edges, there are less)
+         const typename Array<1,elemT>::iterator neighbours_end = neighbours.begin()+num_neighbours;
+         const typename Array<1,elemT>::iterator middle = neighbours.begin()+num_neighbours/2;
+         nth_element(neighbours.begin(), middle, neighbours_end);
+         if (num_neighbours%2==1)
+	   out_array[z][y][x] = *middle;
+         else
+           {
+             // all elements before middle are smaller, so the largest of those is sorted[n-1]
+             out_array[z][y][x] = (*middle + *std::max_element(neighbours.begin(), middle))/2;
+           }
+       } 
+  }
 }
 
 
@@ -7,12 +7,14 @@
   \author Kris Thielemans
   \author Claire Labbe
   \author PARAPET project
+  \author STIR developers
 */
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000 - 2011-12-21, Hammersmith Imanet Ltd
     Copyright (C) 2011-2012, Kris Thielemans
     Copyright (C) 2013, University College London
+    Copyright (C) 2026, STIR developers
 
     This file is part of STIR.
 
@@ -46,6 +48,9 @@
 #include <numeric>
 #include <iostream>
 #include <fstream>
+#ifdef STIR_OPENMP
+#include <omp.h>
+#endif
 
 #ifndef STIR_NO_NAMESPACES
 using std::find;
@@ -122,6 +127,49 @@ ProjDataFromStream::ProjDataFromStream(shared_ptr<const ExamInfo> const& exam_in
   }
 }
 
+void
+ProjDataFromStream::set_filename_for_concurrent_reading(const std::string& filename)
+{
+  filename_for_concurrent_reading = filename;
+  concurrent_read_streams.clear();
+  if (filename.empty())
+    return;
+#ifdef STIR_OPENMP
+  concurrent_read_streams.resize(omp_get_max_threads());
+#else
+  concurrent_read_streams.resize(1);
+#endif
+}
+
+std::istream *
+ProjDataFromStream::get_concurrent_read_stream() const
+{
+  if (filename_for_concurrent_reading.empty())
+    return 0;
+#ifdef STIR_OPENMP
+  const int thread_num = omp_get_thread_num();
+#else
+  const int thread_num = 0;
+#endif
+  // fall back to the shared stream for threads that were not expected
+  if (thread_num >= static_cast<int>(concurrent_read_streams.size()))
+    return 0;
+  // every thread only accesses its own stream, so no synchronisation is needed
+  shared_ptr<std::istream>& stream_sptr = concurrent_read_streams[thread_num];
+  if (is_null_ptr(stream_sptr))
+    {
+      stream_sptr.reset(new std::ifstream(filename_for_concurrent_reading.c_str(), ios::in | ios::binary));
+      if (! *stream_sptr)
+        {
+          warning("ProjDataFromStream: cannot open %s for concurrent reading. Using the shared stream.",
+                  filename_for_concurrent_reading.c_str());
+          stream_sptr.reset();
+          return 0;
+        }
+    }
+  return stream_sptr.get();
+}
+
 Viewgram<float> 
 ProjDataFromStream::get_viewgram(const int view_num, const int segment_num,
                                  const bool make_num_tangential_poss_odd) const
@@ -145,14 +193,12 @@ ProjDataFromStream::get_viewgram(const int view_num, const int segment_num,
   float scale = float(1);
   Succeeded succeeded = Succeeded::yes;
   
-#ifdef STIR_OPENMP
-#pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
+  auto read_viewgram = [&](std::istream& stream)
   {
-    sino_stream->seekg(segment_offset, ios::beg); // start of segment
-    sino_stream->seekg(beg_view_offset, ios::cur); // start of view within segment
+    stream.seekg(segment_offset, ios::beg); // start of segment
+    stream.seekg(beg_view_offset, ios::cur); // start of view within segment
   
-    if (! *sino_stream)
+    if (! stream)
       {
         warning("ProjDataFromStream::get_viewgram: error after seekg");
         succeeded = Succeeded::no;
@@ -161,7 +207,7 @@ ProjDataFromStream::get_viewgram(const int view_num, const int segment_num,
       {    
         for (int ax_pos_num = get_min_axial_pos_num(segment_num); ax_pos_num <= get_max_axial_pos_num(segment_num); ax_pos_num++)
           {
-            if (read_data(*sino_stream, viewgram[ax_pos_num], on_disk_data_type, scale, on_disk_byte_order)
+            if (read_data(stream, viewgram[ax_pos_num], on_disk_data_type, scale, on_disk_byte_order)
                 == Succeeded::no)
               {
                 succeeded = Succeeded::no;
@@ -175,12 +221,12 @@ ProjDataFromStream::get_viewgram(const int view_num, const int segment_num,
               }
             // seek to next line unless it was the last we need to read
             if(ax_pos_num != get_max_axial_pos_num(segment_num))
-              sino_stream->seekg(intra_views_offset, ios::cur);
+              stream.seekg(intra_views_offset, ios::cur);
           }
       }    
     else if (get_storage_order() == Segment_View_AxialPos_TangPos)
       {
-        if(read_data(*sino_stream, viewgram, on_disk_data_type, scale, on_disk_byte_order)
+        if(read_data(stream, viewgram, on_disk_data_type, scale, on_disk_byte_order)
            == Succeeded::no)
           {
             succeeded = Succeeded::no;
@@ -191,7 +237,17 @@ ProjDataFromStream::get_viewgram(const int view_num, const int segment_num,
             succeeded = Succeeded::no;
           }
       }
-  } // end of critical section
+  };
+  std::istream * const concurrent_stream_ptr = get_concurrent_read_stream();
+  if (concurrent_stream_ptr != 0)
+    read_viewgram(*concurrent_stream_ptr);
+  else
+    {
+#ifdef STIR_OPENMP
+#pragma omp critical(PROJDATAFROMSTREAMIO)
+#endif
+      read_viewgram(*sino_stream);
+    }
   if (succeeded == Succeeded::no)
     error("ProjDataFromStream: error reading data");
 
@@ -648,45 +704,39 @@ ProjDataFromStream::get_sinogram(const int ax_pos_num, const int segment_num,
   float scale = float(1);
   Succeeded succeeded = Succeeded::yes;
 
-  if (get_storage_order() == Segment_AxialPos_View_TangPos)
-    {    
-#ifdef STIR_OPENMP
-#pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-      {
-        sino_stream->seekg(segment_offset, ios::beg); // start of segment
-        sino_stream->seekg(beg_ax_pos_offset, ios::cur); // start of view within segment  
-        if (! *sino_stream)
+  auto read_sinogram = [&](std::istream& stream)
+  {
+    if (get_storage_order() == Segment_AxialPos_View_TangPos)
+      {    
+        stream.seekg(segment_offset, ios::beg); // start of segment
+        stream.seekg(beg_ax_pos_offset, ios::cur); // start of view within segment  
+        if (! stream)
           {
             warning("ProjDataFromStream::get_sinogram: error after seekg");
             succeeded = Succeeded::no;
           }
         else
           {
-            succeeded = read_data(*sino_stream, sinogram, on_disk_data_type, scale, on_disk_byte_order);
+            succeeded = read_data(stream, sinogram, on_disk_data_type, scale, on_disk_byte_order);
+            if (succeeded == Succeeded::yes && scale != 1)
+              {
+                warning("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
+                succeeded = Succeeded::no;
+              }
           }
-      } // end of critical section
-      if (succeeded == Succeeded::no)
-        error("ProjDataFromStream: error reading data");
-      if(scale != 1)
-        error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
-    }  
+      }  
     else if (get_storage_order() == Segment_View_AxialPos_TangPos)
       {
-#ifdef STIR_OPENMP
-#pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-        {
-          sino_stream->seekg(segment_offset, ios::beg); // start of segment
-          sino_stream->seekg(beg_ax_pos_offset, ios::cur); // start of view within segment
-          if (! *sino_stream)
+          stream.seekg(segment_offset, ios::beg); // start of segment
+          stream.seekg(beg_ax_pos_offset, ios::cur); // start of view within segment
+          if (! stream)
             {
               warning("ProjDataFromStream::get_sinogram: error after seekg");
               succeeded = Succeeded::no;              
             }
           for (int view = get_min_view_num(); view <= get_max_view_num(); view++)
             {
-              if (read_data(*sino_stream, sinogram[view], on_disk_data_type, scale, on_disk_byte_order)
+              if (read_data(stream, sinogram[view], on_disk_data_type, scale, on_disk_byte_order)
                 == Succeeded::no)
                 {
                   succeeded = Succeeded::no;
@@ -700,10 +750,20 @@ ProjDataFromStream::get_sinogram(const int ax_pos_num, const int segment_num,
                 }
               // seek to next line unless it was the last we need to read
               if(view != get_max_view_num())
-                sino_stream->seekg(intra_ax_pos_offset, ios::cur);
+                stream.seekg(intra_ax_pos_offset, ios::cur);
             }    
-        } // end of critical section
       }
+  };
+  std::istream * const concurrent_stream_ptr = get_concurrent_read_stream();
+  if (concurrent_stream_ptr != 0)
+    read_sinogram(*concurrent_stream_ptr);
+  else
+    {
+#ifdef STIR_OPENMP
+#pragma omp critical(PROJDATAFROMSTREAMIO)
+#endif
+      read_sinogram(*sino_stream);
+    }
   if (succeeded == Succeeded::no)
     error("ProjDataFromStream: error reading data");
   sinogram *= scale_factor;
@@ -8,11 +8,13 @@
   \author Damiano Belluzzo
   \author Kris Thielemans
   \author PARAPET project
+  \author STIR developers
 */
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000 - 2009-06-22, Hammersmith Imanet Ltd
     Copyright (C) 2011, Kris Thielemans
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -247,6 +249,14 @@ get_viewgram(const int view_num, const int segment_num,
     
     streamoff ring_offset = get_num_tangential_poss() * on_disk_data_type.size_in_bytes();
     
+    Viewgram<float> data = get_empty_viewgram(view_num, segment_num,false);
+    Succeeded succeeded = Succeeded::yes;
+
+    // the stream is shared between threads, so protect seeking and reading
+#ifdef STIR_OPENMP
+#pragma omp critical(PROJDATAGEADVANCEIO)
+#endif
+    {
     // jumps the initial offset
     
     sino_stream->seekg(offset, ios::beg); // overall offset
@@ -271,8 +281,6 @@ get_viewgram(const int view_num, const int segment_num,
     
     sino_stream->seekg(jump_ini, ios::cur);
     
-    Viewgram<float> data = get_empty_viewgram(view_num, segment_num,false);
-    
     for (int ring =get_min_axial_pos_num(segment_num) ; ring <= get_max_axial_pos_num(segment_num); ring++)
     {
       {
@@ -282,10 +290,17 @@ get_viewgram(const int view_num, const int segment_num,
                       scale,
                       on_disk_byte_order) == Succeeded::no
             || scale != 1)
-          error("ProjDataGEAdvance: error reading data\n");
+          {
+            // cannot call error() in a critical section
+            succeeded = Succeeded::no;
+            break;
+          }
       }
       sino_stream->seekg(jump_ring, ios::cur);
     }
+    } // end of critical section
+    if (succeeded == Succeeded::no)
+      error("ProjDataGEAdvance: error reading data\n");
     
     // scales the Viewgram<float>
     data *= view_scaling_factor[view_num];
@@ -5,11 +5,13 @@
   \brief Implementations for non-inline functions of class stir::ProjDataInMemory
 
   \author Kris Thielemans
+  \author STIR developers
 */
 /*
     Copyright (C) 2002 - 2011-02-23, Hammersmith Imanet Ltd
     Copyright (C) 2011, Kris Thielemans
     Copyright (C) 2019, 2020, UCL
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -30,10 +32,13 @@
 #include "stir/shared_ptr.h"
 #include "stir/Succeeded.h"
 #include "stir/SegmentByView.h"
+#include "stir/Viewgram.h"
+#include "stir/Sinogram.h"
 #include "stir/Bin.h"
 #include "stir/is_null_ptr.h"
 #include <fstream>
 #include <cstring>
+#include <algorithm>
 
 #ifdef STIR_USE_OLD_STRSTREAM
 #include <strstream>
@@ -69,6 +74,7 @@ ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_sptr,
                      ProjData::standard_segment_sequence(*proj_data_info_ptr),
                      Segment_AxialPos_View_TangPos)
 {
+  this->set_segment_start_indices();
   this->create_buffer(initialise_with_0);
   this->create_stream();
 }
@@ -139,6 +145,7 @@ ProjDataInMemory(const ProjData& proj_data)
                        ProjData::standard_segment_sequence(*proj_data.get_proj_data_info_sptr()),
                        Segment_AxialPos_View_TangPos)
 {
+  this->set_segment_start_indices();
   this->create_buffer();
   this->create_stream();
 
@@ -154,6 +161,7 @@ ProjDataInMemory (const ProjDataInMemory& proj_data)
                          ProjData::standard_segment_sequence(*proj_data.get_proj_data_info_sptr()),
                          Segment_AxialPos_View_TangPos)
 {
+  this->set_segment_start_indices();
   this->create_buffer();
   this->create_stream();
 
@@ -169,17 +177,111 @@ get_size_of_buffer_in_bytes() const
   return size_all() * sizeof(float);
 }
 
+void
+ProjDataInMemory::
+set_segment_start_indices()
+{
+  // Note: the constructors always use standard_segment_sequence and Segment_AxialPos_View_TangPos
+  this->segment_start_indices.recycle();
+  this->segment_start_indices.resize(this->get_min_segment_num(), this->get_max_segment_num());
+  const std::vector<int> segment_sequence = ProjData::standard_segment_sequence(*this->get_proj_data_info_sptr());
+  int start_index = 0;
+  for (std::vector<int>::const_iterator iter = segment_sequence.begin();
+       iter != segment_sequence.end();
+       ++iter)
+    {
+      this->segment_start_indices[*iter] = start_index;
+      start_index += this->get_num_axial_poss(*iter) * this->get_num_views() * this->get_num_tangential_poss();
+    }
+}
+
 float 
-ProjDataInMemory::get_bin_value(Bin& bin)
+ProjDataInMemory::get_bin_value(const Bin& bin) const
 {
-  // first find offset in the stream
-  std::vector<std::streamoff> offsets = get_offsets_bin(bin);
-  const std::streamoff total_offset = offsets[0];
-  // now convert to index in the buffer
-  const int index = static_cast<int>(total_offset/sizeof(float));
+  assert(bin.segment_num() >= get_min_segment_num() && bin.segment_num() <= get_max_segment_num());
+  assert(bin.axial_pos_num() >= get_min_axial_pos_num(bin.segment_num()) &&
+         bin.axial_pos_num() <= get_max_axial_pos_num(bin.segment_num()));
+  assert(bin.view_num() >= get_min_view_num() && bin.view_num() <= get_max_view_num());
+  assert(bin.tangential_pos_num() >= get_min_tangential_pos_num() &&
+         bin.tangential_pos_num() <= get_max_tangential_pos_num());
+  const int index =
+    this->get_index_of_row(bin.segment_num(), bin.axial_pos_num(), bin.view_num()) +
+    (bin.tangential_pos_num() - get_min_tangential_pos_num());
   return buffer[index];
 }
 
+Viewgram<float>
+ProjDataInMemory::
+get_viewgram(const int view_num, const int segment_num, const bool make_num_tangential_poss_odd) const
+{
+  if (make_num_tangential_poss_odd)
+    return ProjDataFromStream::get_viewgram(view_num, segment_num, make_num_tangential_poss_odd);
+  if (segment_num < get_min_segment_num() || segment_num > get_max_segment_num() ||
+      view_num < get_min_view_num() || view_num > get_max_view_num())
+    error("ProjDataInMemory::get_viewgram: segment_num or view_num out of range");
+
+  Viewgram<float> viewgram(proj_data_info_sptr, view_num, segment_num);
+  for (int ax_pos_num = get_min_axial_pos_num(segment_num); ax_pos_num <= get_max_axial_pos_num(segment_num); ++ax_pos_num)
+    {
+      // note: use operator[] and not get_const_data_ptr(), as the latter is not thread-safe
+      const float * const row_ptr = &this->buffer[this->get_index_of_row(segment_num, ax_pos_num, view_num)];
+      std::copy(row_ptr, row_ptr + get_num_tangential_poss(), viewgram[ax_pos_num].begin());
+    }
+  return viewgram;
+}
+
+Succeeded
+ProjDataInMemory::
+set_viewgram(const Viewgram<float>& v)
+{
+  // let ProjDataFromStream handle (and warn about) incompatible viewgrams
+  if (*get_proj_data_info_sptr() != *(v.get_proj_data_info_sptr()))
+    return ProjDataFromStream::set_viewgram(v);
+
+  const int segment_num = v.get_segment_num();
+  const int view_num = v.get_view_num();
+  for (int ax_pos_num = get_min_axial_pos_num(segment_num); ax_pos_num <= get_max_axial_pos_num(segment_num); ++ax_pos_num)
+    std::copy(v[ax_pos_num].begin(), v[ax_pos_num].end(),
+              &this->buffer[this->get_index_of_row(segment_num, ax_pos_num, view_num)]);
+  return Succeeded::yes;
+}
+
+Sinogram<float>
+ProjDataInMemory::
+get_sinogram(const int ax_pos_num, const int segment_num, const bool make_num_tangential_poss_odd) const
+{
+  if (make_num_tangential_poss_odd)
+    return ProjDataFromStream::get_sinogram(ax_pos_num, segment_num, make_num_tangential_poss_odd);
+  if (segment_num < get_min_segment_num() || segment_num > get_max_segment_num() ||
+      ax_pos_num < get_min_axial_pos_num(segment_num) || ax_pos_num > get_max_axial_pos_num(segment_num))
+    error("ProjDataInMemory::get_sinogram: segment_num or ax_pos_num out of range");
+
+  Sinogram<float> sinogram(proj_data_info_sptr, ax_pos_num, segment_num);
+  for (int view_num = get_min_view_num(); view_num <= get_max_view_num(); ++view_num)
+    {
+      // note: use operator[] and not get_const_data_ptr(), as the latter is not thread-safe
+      const float * const row_ptr = &this->buffer[this->get_index_of_row(segment_num, ax_pos_num, view_num)];
+      std::copy(row_ptr, row_ptr + get_num_tangential_poss(), sinogram[view_num].begin());
+    }
+  return sinogram;
+}
+
+Succeeded
+ProjDataInMemory::
+set_sinogram(const Sinogram<float>& s)
+{
+  // let ProjDataFromStream handle (and warn about) incompatible sinograms
+  if (*get_proj_data_info_sptr() != *(s.get_proj_data_info_sptr()))
+    return ProjDataFromStream::set_sinogram(s);
+
+  const int segment_num = s.get_segment_num();
+  const int ax_pos_num = s.get_axial_pos_num();
+  for (int view_num = get_min_view_num(); view_num <= get_max_view_num(); ++view_num)
+    std::copy(s[view_num].begin(), s[view_num].end(),
+              &this->buffer[this->get_index_of_row(segment_num, ax_pos_num, view_num)]);
+  return Succeeded::yes;
+}
+
 void
 ProjDataInMemory::
 axpby(const float a, const ProjData& x,
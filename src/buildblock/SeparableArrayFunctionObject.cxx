@@ -8,10 +8,12 @@
 
   \author Kris Thielemans
   \author Sanida Mustafovic
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2001- 2011, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -64,9 +66,24 @@ do_it(Array<num_dim,elemT>& array) const
 	    ++iter)
 	assert(!is_null_ptr(*iter));
 #endif
-       in_place_apply_array_functions_on_each_index(array, 
-						    all_1d_array_filters.begin(), 
-						    all_1d_array_filters.end());
+      if (array.is_regular() && array.is_contiguous())
+        {
+          // filter along every dimension in turn, using multiple threads if possible.
+          // This gives the same result as in_place_apply_array_functions_on_each_index
+          for (int d=1; d<=num_dim; ++d)
+            {
+              const shared_ptr<ArrayFunctionObject<1,elemT> >& filter_sptr =
+                all_1d_array_filters[all_1d_array_filters.get_min_index() + d - 1];
+              if (!filter_sptr->is_trivial())
+                in_place_apply_array_function_on_index(array, d, filter_sptr.get());
+            }
+        }
+      else
+        {
+          in_place_apply_array_functions_on_each_index(array, 
+                                                       all_1d_array_filters.begin(), 
+                                                       all_1d_array_filters.end());
+        }
     }
 }
 
@@ -0,0 +1,19 @@
+# Find the single precision FFTW3 library (http://www.fftw.org)
+#
+# Sets FFTW3_FOUND, FFTW3_INCLUDE_DIRS and FFTW3_LIBRARIES.
+# Set FFTW3_ROOT_DIR if the library is installed in a non-standard location.
+
+  if (NOT FFTW3_ROOT_DIR AND NOT "$ENV{FFTW3_ROOT_DIR}" STREQUAL "")
+    set(FFTW3_ROOT_DIR $ENV{FFTW3_ROOT_DIR})
+  endif()
+
+  find_path(FFTW3_INCLUDE_DIRS NAME fftw3.h HINTS ${FFTW3_ROOT_DIR} PATH_SUFFIXES include
+        DOC "location of FFTW3 include files")
+
+  find_library(FFTW3_LIBRARIES NAME fftw3f HINTS ${FFTW3_ROOT_DIR} PATH_SUFFIXES lib lib64
+        DOC "location of single precision FFTW3 library")
+
+# handle the QUIETLY and REQUIRED arguments and set FFTW3_FOUND to TRUE if
+# all listed variables are TRUE
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(FFTW3 "FFTW3 library not found. If you do have it, set FFTW3_ROOT_DIR" FFTW3_LIBRARIES FFTW3_INCLUDE_DIRS)
@@ -72,6 +72,19 @@ Array inherits its numeric operators from NumericVectorWithOffset.
 In particular this means that operator+= etc. potentially grow
 the object. However, as grow() is a virtual function, Array::grow is
 called, which initialises new elements first to 0.
+
+\par Contiguous storage
+
+Arrays constructed with an index range (or copied from another array, or
+resized) allocate all their elements in one contiguous block of memory,
+in the order of the full_iterator (i.e. the last index runs fastest).
+The sub-arrays (e.g. the rows) then refer to this block. This avoids many
+small allocations, and allows functions such as fill() and sum() (and
+external libraries) to work on the whole array at once.
+
+Note that some manipulations of a sub-array (e.g. growing a row) can make
+the array non-contiguous. Use is_contiguous() to check, and
+get_full_data_ptr() to get access to the block of memory.
 */
 
 template <int num_dimensions, typename elemT>
@@ -133,6 +146,7 @@ public:
   
 #ifndef SWIG
   //! Construct an Array from an object of its base_type
+  /*! The new array will be contiguous. */
   inline Array(const base_type& t);
 #else
   // swig 2.0.4 gets confused by base_type (due to numeric template arguments)
@@ -141,6 +155,21 @@ public:
   // This is less powerful as in C++, but swig-generated interfaces don't need to know about the base_type anyway
   inline Array(const self& t);
 #endif
+
+#ifndef SWIG
+  //! Copy constructor
+  /*! The new array will be contiguous (even if \a t is not). */
+  inline Array(const self& t);
+
+  //! Move constructor (does not copy the data)
+  inline Array(self&& t);
+#endif
+
+  //! assignment operator
+  /*! If the index ranges are equal, the data is copied into the current
+      memory, otherwise the array is reallocated (and contiguous).
+  */
+  inline self& operator=(const self& other);
   
   //! virtual destructor, frees up any allocated memory
   inline virtual ~Array();
@@ -177,6 +206,40 @@ public:
   //! grow the array to a new range of indices, new elements are set to 0  
   virtual inline void 
     grow(const IndexRange<num_dimensions>& range);
+
+  //! set the array to an empty range and free all memory
+  inline void recycle();
+
+  //! \name access to the data via a pointer
+  //@{
+  //! check if all elements are stored contiguously in memory
+  /*! This is the case for any array constructed with an index range (or resized),
+      unless a sub-array has been resized afterwards. Empty rows are ignored.
+
+      The result is remembered when the block of memory is allocated, such that this
+      is normally a cheap check. Only after the range or memory of a sub-array of
+      any array (with the same \c elemT) has changed, the sub-arrays are checked again.
+  */
+  inline bool is_contiguous() const;
+
+  //! member function for access to the data via an elemT*
+  /*! The elements are stored in the order of the full_iterator. Calls error() if
+      the array is not contiguous. Returns 0 for an empty array.
+
+      As for VectorWithOffset::get_data_ptr(), no manipulation of the array is
+      allowed until release_full_data_ptr() is called.
+  */
+  inline elemT* get_full_data_ptr();
+
+  //! member function for access to the data via a const elemT*
+  inline const elemT* get_const_full_data_ptr() const;
+
+  //! signal end of access to elemT*
+  inline void release_full_data_ptr();
+
+  //! signal end of access to const elemT*
+  inline void release_const_full_data_ptr() const;
+  //@}
   
   //! return sum of all elements
   inline elemT sum() const ;
@@ -244,6 +307,56 @@ public:
   template <typename elemT2>
     inline void axpby(const elemT2 a, const Array& x,
                       const elemT2 b, const Array& y);
+
+protected:
+  template <int, typename> friend class Array;
+
+  //! (re)initialise the array with a new range, using existing (contiguous) data
+  /*! If \a data_ptr is 0, a new block of memory is allocated and all elements are
+      set to 0. Otherwise, if \a copy_data is \c true, a new block is allocated
+      and the data is copied, while if it is \c false, the array will use the
+      memory pointed to by \a data_ptr (which has to remain valid while the array uses it).
+  */
+  inline void init(const IndexRange<num_dimensions>& range, elemT * const data_ptr, bool copy_data);
+
+  //! check if the data is contiguous and starts at \a mem_ptr
+  /*! If \a mem_ptr is 0, the start is not checked. On return, \a mem_ptr points
+      to one past the last element (it is not changed for an empty array).
+  */
+  inline bool _is_contiguous(const elemT*& mem_ptr) const;
+
+private:
+  //! the block of memory allocated by init(), or 0
+  elemT* _allocated_full_data_ptr;
+  //! boolean to test if get_full_data_ptr is called
+  mutable bool _full_pointer_access;
+
+  //! \name information on the contiguous block set by init()
+  //@{
+  //! start of the block used by init() (allocated or not)
+  elemT* _contiguous_data_ptr;
+  //! number of elements in the block
+  size_t _contiguous_size;
+  //! value of VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory() after init()
+  /*! If the counter is still the same, no sub-array can have changed, so the
+      block is still valid.
+  */
+  unsigned long _contiguous_check_count;
+  //@}
+
+  //! swap content with another array (without copying the data)
+  inline void swap(self& other);
+  //! signal a change of range/memory if this array is a sub-array of a contiguous block
+  inline void _count_change_of_sub_array() const;
+  //! find the contiguous block of memory, returns \c false if not contiguous
+  /*! This function does not modify the object (in particular, it does not set
+      \c _full_pointer_access), such that it can be used by const members that can
+      be called concurrently, even while a full data pointer is held.
+      For an empty array, \a data_ptr is set to 0.
+  */
+  inline bool _get_contiguous_block(const elemT*& data_ptr, size_t& size) const;
+  //! returns a pointer to the first element, calls error() if not contiguous
+  inline const elemT* _full_data_begin() const;
 };
 
 
@@ -346,6 +459,19 @@ public:
   
   // Array::resize initialises new elements to 0
   inline virtual void resize(const int min_index, const int max_index);
+
+  //! \name access to the data via a pointer
+  /*! These are provided for compatibility with the multi-dimensional case,
+      and call the corresponding VectorWithOffset functions.
+  */
+  //@{
+  //! always \c true as this is the 1D case
+  inline bool is_contiguous() const;
+  inline elemT* get_full_data_ptr();
+  inline const elemT* get_const_full_data_ptr() const;
+  inline void release_full_data_ptr();
+  inline void release_const_full_data_ptr() const;
+  //@}
   
   //! return sum of all elements
   inline elemT sum() const;
@@ -430,6 +556,15 @@ public:
   inline const elemT&
     at(const BasicCoordinate<1,int> &c) const;
   //@}
+
+protected:
+  template <int, typename> friend class Array;
+
+  //! (re)initialise the array with a new range, see Array<num_dimensions,elemT>::init()
+  inline void init(const IndexRange<1>& range, elemT * const data_ptr, bool copy_data);
+
+  //! check if the data starts at \a mem_ptr, see Array<num_dimensions,elemT>::_is_contiguous()
+  inline bool _is_contiguous(const elemT*& mem_ptr) const;
 };
 
 
@@ -38,11 +38,93 @@ START_NAMESPACE_STIR
  inlines for Array<num_dimensions, elemT>
  **********************************************/
 
+template <int num_dimensions, typename elemT>
+void 
+Array<num_dimensions, elemT>::
+init(const IndexRange<num_dimensions>& range, elemT * const data_ptr, bool copy_data)
+{
+  // check if data is being accessed via a pointer (see get_full_data_ptr())
+  assert(!this->_full_pointer_access);
+  this->_count_change_of_sub_array();
+  // first get rid of the rows (which might refer to the current block)
+  base_type::recycle();
+  delete[] this->_allocated_full_data_ptr;
+  this->_allocated_full_data_ptr = 0;
+
+  const size_t total_size = range.size_all();
+  elemT * this_data_ptr = data_ptr;
+  if (data_ptr == 0 || copy_data)
+    {
+      if (total_size > 0)
+        {
+          this->_allocated_full_data_ptr = new elemT[total_size];
+          if (data_ptr == 0)
+            {
+              for (elemT * iter = this->_allocated_full_data_ptr; iter != this->_allocated_full_data_ptr + total_size; ++iter)
+                assign(*iter, 0);
+            }
+          else
+            std::copy(data_ptr, data_ptr + total_size, this->_allocated_full_data_ptr);
+        }
+      this_data_ptr = this->_allocated_full_data_ptr;
+    }
+
+  this->_contiguous_data_ptr = total_size > 0 ? this_data_ptr : 0;
+  this->_contiguous_size = total_size;
+
+  base_type::resize(range.get_min_index(), range.get_max_index());
+  typename IndexRange<num_dimensions>::const_iterator range_iter = range.begin();
+  for (iterator iter = this->begin(); iter != this->end(); ++iter, ++range_iter)
+    {
+      iter->init(*range_iter, this_data_ptr, false);
+      if (this_data_ptr != 0)
+        this_data_ptr += range_iter->size_all();
+    }
+  this->_contiguous_check_count = VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory();
+}
+
+template <int num_dimensions, typename elemT>
+void 
+Array<num_dimensions, elemT>::
+_count_change_of_sub_array() const
+{
+  // a non-empty array that did not allocate its own block uses memory of another array
+  if (this->_allocated_full_data_ptr == 0 && this->size() > 0)
+    VectorWithOffset<elemT>::increment_num_changes_of_non_owned_memory();
+}
+
+template <int num_dimensions, typename elemT>
+void 
+Array<num_dimensions, elemT>::
+swap(self& other)
+{
+  assert(!this->_full_pointer_access);
+  assert(!other._full_pointer_access);
+  this->_count_change_of_sub_array();
+  other._count_change_of_sub_array();
+  base_type::swap(other);
+  std::swap(this->_allocated_full_data_ptr, other._allocated_full_data_ptr);
+  std::swap(this->_contiguous_data_ptr, other._contiguous_data_ptr);
+  std::swap(this->_contiguous_size, other._contiguous_size);
+  std::swap(this->_contiguous_check_count, other._contiguous_check_count);
+}
+
 template <int num_dimensions, typename elemT>
 void 
 Array<num_dimensions, elemT>::
 resize(const IndexRange<num_dimensions>& range)
 {
+  if (this->size() == 0)
+    {
+      this->init(range, 0, false);
+      return;
+    }
+  if (range == this->get_index_range())
+    return;
+
+  // The rows are changed below without going through init(), and new rows own their memory
+  // such that this is not counted automatically. Make sure the remembered block is not used anymore.
+  VectorWithOffset<elemT>::increment_num_changes_of_non_owned_memory();
   base_type::resize(range.get_min_index(), range.get_max_index());
   typename base_type::iterator iter = this->begin();
   typename IndexRange<num_dimensions>::const_iterator range_iter = range.begin();
@@ -50,6 +132,9 @@ resize(const IndexRange<num_dimensions>& range)
        iter != this->end(); 
        ++iter, ++range_iter)
     (*iter).resize(*range_iter);
+  // the above will generally have reallocated some rows, so copy everything into a new block
+  self tmp(*this);
+  this->swap(tmp);
 }
 
 template <int num_dimensions, typename elemT>
@@ -60,16 +145,34 @@ grow(const IndexRange<num_dimensions>& range)
   resize(range);
 }
 
+template <int num_dimensions, typename elemT>
+void 
+Array<num_dimensions, elemT>::
+recycle()
+{
+  this->init(IndexRange<num_dimensions>(), 0, false);
+}
+
 template <int num_dimensions, typename elemT>
 Array<num_dimensions, elemT>::Array()
-: base_type()
+: base_type(),
+  _allocated_full_data_ptr(0),
+  _full_pointer_access(false),
+  _contiguous_data_ptr(0),
+  _contiguous_size(0),
+  _contiguous_check_count(VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
 {}
 
 template <int num_dimensions, typename elemT>
 Array<num_dimensions, elemT>::Array(const IndexRange<num_dimensions>& range)
-: base_type()
+: base_type(),
+  _allocated_full_data_ptr(0),
+  _full_pointer_access(false),
+  _contiguous_data_ptr(0),
+  _contiguous_size(0),
+  _contiguous_check_count(VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
 {
-  grow(range);
+  this->init(range, 0, false);
 }
 
 template <int num_dimensions, typename elemT>
@@ -79,13 +182,195 @@ Array<num_dimensions, elemT>::Array(const self& t)
 #else
 Array<num_dimensions, elemT>::Array(const base_type& t)
 #endif
-:  base_type(t)
-{}
+:  base_type(),
+   _allocated_full_data_ptr(0),
+   _full_pointer_access(false),
+   _contiguous_data_ptr(0),
+   _contiguous_size(0),
+   _contiguous_check_count(VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
+{
+  // allocate a block for all elements of t
+  size_t total_size = 0;
+  for (int i=t.get_min_index(); i<=t.get_max_index(); ++i)
+    total_size += t[i].size_all();
+  if (total_size > 0)
+    this->_allocated_full_data_ptr = new elemT[total_size];
+  this->_contiguous_data_ptr = this->_allocated_full_data_ptr;
+  this->_contiguous_size = total_size;
+  // set up the rows with the range of t (without constructing IndexRange objects),
+  // and copy the data (row-by-row, as t might not be contiguous)
+  elemT * this_data_ptr = this->_allocated_full_data_ptr;
+  base_type::resize(t.get_min_index(), t.get_max_index());
+  for (int i=t.get_min_index(); i<=t.get_max_index(); ++i)
+    {
+      (*this)[i].init(t[i].get_index_range(), this_data_ptr, false);
+      (*this)[i] = t[i];
+      if (this_data_ptr != 0)
+        this_data_ptr += t[i].size_all();
+    }
+  this->_contiguous_check_count = VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory();
+}
+
+#ifndef SWIG
+template <int num_dimensions, typename elemT>
+Array<num_dimensions, elemT>::Array(const self& t)
+:  base_type(),
+   _allocated_full_data_ptr(0),
+   _full_pointer_access(false),
+   _contiguous_data_ptr(0),
+   _contiguous_size(0),
+   _contiguous_check_count(VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
+{
+  const elemT * data_ptr;
+  size_t size;
+  if (t._get_contiguous_block(data_ptr, size) && size > 0)
+    {
+      // copy the whole block at once
+      // note: the const_cast is safe as init() will only read the data when copy_data is true
+      this->init(t.get_index_range(), const_cast<elemT *>(data_ptr), true);
+    }
+  else
+    {
+      this->init(t.get_index_range(), 0, false);
+      std::copy(t.begin_all(), t.end_all(), this->begin_all());
+    }
+}
+
+template <int num_dimensions, typename elemT>
+Array<num_dimensions, elemT>::Array(self&& t)
+:  base_type(),
+   _allocated_full_data_ptr(0),
+   _full_pointer_access(false),
+   _contiguous_data_ptr(0),
+   _contiguous_size(0),
+   _contiguous_check_count(VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
+{
+  this->swap(t);
+}
+#endif
+
+template <int num_dimensions, typename elemT>
+Array<num_dimensions, elemT>&
+Array<num_dimensions, elemT>::operator=(const self& other)
+{
+  if (this == &other)
+    return *this;
+  if (this->get_index_range() == other.get_index_range())
+    {
+      // copy into the current memory
+      base_type::operator=(other);
+    }
+  else
+    {
+      self tmp(other);
+      this->swap(tmp);
+    }
+  return *this;
+}
 
 template <int num_dimensions, typename elemT>
 Array<num_dimensions, elemT>::~Array()
-{}
+{
+  // check if data is being accessed via a pointer (see get_full_data_ptr())
+  assert(!this->_full_pointer_access);
+  // note: the rows will be destructed after this, but they do not own the block
+  delete[] this->_allocated_full_data_ptr;
+}
+
+template <int num_dimensions, typename elemT>
+bool
+Array<num_dimensions, elemT>::
+_is_contiguous(const elemT*& mem_ptr) const
+{
+  for (const_iterator iter = this->begin(); iter != this->end(); ++iter)
+    if (!iter->_is_contiguous(mem_ptr))
+      return false;
+  return true;
+}
+
+template <int num_dimensions, typename elemT>
+bool
+Array<num_dimensions, elemT>::
+_get_contiguous_block(const elemT*& data_ptr, size_t& size) const
+{
+  if (this->_contiguous_check_count == VectorWithOffset<elemT>::get_num_changes_of_non_owned_memory())
+    {
+      // no sub-array has changed since init(), so the block is still valid
+      data_ptr = this->_contiguous_data_ptr;
+      size = this->_contiguous_size;
+      return true;
+    }
+  // need to check all sub-arrays
+  const elemT* end_ptr = 0;
+  if (!this->_is_contiguous(end_ptr))
+    return false;
+  size = this->size_all();
+  data_ptr = end_ptr == 0 ? 0 : end_ptr - size;
+  return true;
+}
 
+template <int num_dimensions, typename elemT>
+bool
+Array<num_dimensions, elemT>::
+is_contiguous() const
+{
+  const elemT* data_ptr;
+  size_t size;
+  return this->_get_contiguous_block(data_ptr, size);
+}
+
+template <int num_dimensions, typename elemT>
+const elemT*
+Array<num_dimensions, elemT>::
+_full_data_begin() const
+{
+  const elemT* data_ptr = 0;
+  size_t size;
+  if (!this->_get_contiguous_block(data_ptr, size))
+    error("Array::get_full_data_ptr() called for a non-contiguous array");
+  return data_ptr;
+}
+
+template <int num_dimensions, typename elemT>
+elemT*
+Array<num_dimensions, elemT>::
+get_full_data_ptr()
+{
+  assert(!this->_full_pointer_access);
+  const elemT* const data_ptr = this->_full_data_begin();
+  this->_full_pointer_access = true;
+  // the const_cast is safe as this object is not const
+  return const_cast<elemT*>(data_ptr);
+}
+
+template <int num_dimensions, typename elemT>
+const elemT*
+Array<num_dimensions, elemT>::
+get_const_full_data_ptr() const
+{
+  assert(!this->_full_pointer_access);
+  const elemT* const data_ptr = this->_full_data_begin();
+  this->_full_pointer_access = true;
+  return data_ptr;
+}
+
+template <int num_dimensions, typename elemT>
+void
+Array<num_dimensions, elemT>::
+release_full_data_ptr()
+{
+  assert(this->_full_pointer_access);
+  this->_full_pointer_access = false;
+}
+
+template <int num_dimensions, typename elemT>
+void
+Array<num_dimensions, elemT>::
+release_const_full_data_ptr() const
+{
+  assert(this->_full_pointer_access);
+  this->_full_pointer_access = false;
+}
 
 template <int num_dimensions, typename elemT>
 typename Array<num_dimensions, elemT>::full_iterator 
@@ -186,6 +471,16 @@ Array<num_dimensions, elemT>::sum() const
   this->check_state();
   elemT acc;
   assign(acc,0);
+  const elemT* data_ptr;
+  size_t size;
+  if (this->_get_contiguous_block(data_ptr, size))
+    {
+      // loop over the whole block at once
+      const elemT* const end_ptr = data_ptr + size;
+      for (const elemT* iter = data_ptr; iter != end_ptr; ++iter)
+        acc += *iter;
+      return acc;
+    }
   for(int i=this->get_min_index(); i<=this->get_max_index(); i++)
     acc += this->num[i].sum();
   return acc; 
@@ -198,6 +493,16 @@ Array<num_dimensions, elemT>::sum_positive() const
   this->check_state();
   elemT acc;
   assign(acc,0);
+  const elemT* data_ptr;
+  size_t size;
+  if (this->_get_contiguous_block(data_ptr, size))
+    {
+      const elemT* const end_ptr = data_ptr + size;
+      for (const elemT* iter = data_ptr; iter != end_ptr; ++iter)
+        if (*iter > 0)
+          acc += *iter;
+      return acc;
+    }
   for(int i=this->get_min_index(); i<=this->get_max_index(); i++)
     acc += this->num[i].sum_positive();
   return acc; 
@@ -208,6 +513,10 @@ elemT
 Array<num_dimensions, elemT>::find_max() const
 {
   this->check_state();
+  const elemT* data_ptr;
+  size_t size;
+  if (this->_get_contiguous_block(data_ptr, size) && size > 0)
+    return *std::max_element(data_ptr, data_ptr + size);
   if (this->size() > 0)
   {
     elemT maxval= this->num[this->get_min_index()].find_max();
@@ -229,6 +538,10 @@ elemT
 Array<num_dimensions, elemT>::find_min() const
 {
   this->check_state();
+  const elemT* data_ptr;
+  size_t size;
+  if (this->_get_contiguous_block(data_ptr, size) && size > 0)
+    return *std::min_element(data_ptr, data_ptr + size);
   if (this->size() > 0)
   {
     elemT minval= this->num[this->get_min_index()].find_min();
@@ -254,6 +567,14 @@ void
 Array<num_dimensions, elemT>::fill(const elemT &n) 
 {
   this->check_state();
+  const elemT* data_ptr;
+  size_t size;
+  if (this->_get_contiguous_block(data_ptr, size))
+    {
+      // the const_cast is safe as this object is not const
+      std::fill(const_cast<elemT*>(data_ptr), const_cast<elemT*>(data_ptr) + size, n);
+      return;
+    }
   for(int i=this->get_min_index(); i<=this->get_max_index();  i++)
     this->num[i].fill(n);
   this->check_state();
@@ -405,6 +726,67 @@ Array<1, elemT>::grow(const IndexRange<1>& range)
 }
 
 
+template <class elemT>
+void
+Array<1, elemT>::init(const IndexRange<1>& range, elemT * const data_ptr, bool copy_data) 
+{
+  if (data_ptr == 0)
+    {
+      this->recycle();
+      this->grow(range);
+    }
+  else
+    base_type::init(range.get_min_index(), range.get_max_index(), data_ptr, copy_data);
+}
+
+template <class elemT>
+bool
+Array<1, elemT>::_is_contiguous(const elemT*& mem_ptr) const
+{
+  if (this->size() == 0)
+    return true;
+  const elemT* const begin_ptr = &(*this->begin());
+  if (mem_ptr != 0 && begin_ptr != mem_ptr)
+    return false;
+  mem_ptr = begin_ptr + this->size();
+  return true;
+}
+
+template <class elemT>
+bool
+Array<1, elemT>::is_contiguous() const
+{
+  return true;
+}
+
+template <class elemT>
+elemT*
+Array<1, elemT>::get_full_data_ptr()
+{
+  return this->get_data_ptr();
+}
+
+template <class elemT>
+const elemT*
+Array<1, elemT>::get_const_full_data_ptr() const
+{
+  return this->get_const_data_ptr();
+}
+
+template <class elemT>
+void
+Array<1, elemT>::release_full_data_ptr()
+{
+  this->release_data_ptr();
+}
+
+template <class elemT>
+void
+Array<1, elemT>::release_const_full_data_ptr() const
+{
+  this->release_const_data_ptr();
+}
+
 template <class elemT>
 Array<1, elemT>::Array()
 : base_type()
@@ -4,9 +4,11 @@
   \brief Declaration of class stir::ArrayFilterUsingRealDFTWithPadding
 
   \author Kris Thielemans
+  \author STIR developers
 */
 /*
     Copyright (C) 2004-2009, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -93,7 +95,8 @@ public:
       twice as long as the input and output arrays.
 
       As this function uses fourier_for_real_data(), see there for restrictions 
-      on the possible kernel length, but at time of writing, it has to be a power of 2.
+      on the possible kernel length. At time of writing, the length in the last dimension
+      has to be even. Lengths with only small prime factors are fastest.
   */
   Succeeded 
     set_kernel(const Array<num_dimensions, elemT>& real_filter_kernel);
@@ -108,7 +111,7 @@ public:
       twice as long as the input and output arrays.
 
       See fourier() for restrictions on the possible
-      kernel length, but at time of writing, it has to be a power of 2.
+      kernel length. Lengths with only small prime factors are fastest.
   */
   Succeeded
     set_kernel_in_frequency_space(const Array<num_dimensions, std::complex<elemT> >& kernel_in_frequency_space);
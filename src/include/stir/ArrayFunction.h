@@ -1,6 +1,7 @@
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000- 2007, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -23,6 +24,7 @@
 
   \author Kris Thielemans (loosely based on some earlier work by Darren Hague)
   \author PARAPET project
+  \author STIR developers
 
 
   <ul>
@@ -34,6 +36,7 @@
      <li>stir::in_place_abs (does not work on complex numbers)
      <li>stir::in_place_apply_function
      <li>stir::in_place_apply_array_function_on_1st_index
+     <li>stir::in_place_apply_array_function_on_index
      <li>stir::in_place_apply_array_functions_on_each_index
    </ul>
    All these functions return a reference to the (modified) array
@@ -177,6 +180,37 @@ template <int num_dim, typename elemT, typename FunctionObjectPtr>
 inline void
 in_place_apply_array_function_on_1st_index(Array<num_dim, elemT>& array, FunctionObjectPtr f);
 
+//! Apply a function object on all possible 1d arrays extracted by keeping all indices fixed, except one
+/*! \ingroup Array 
+
+  This does the same as in_place_apply_array_function_on_1st_index(), but for the
+  index \a dim (with \a dim between 1 and \c num_dim). For instance, in 3d with \a dim=2
+  \code
+  for all i1,i3
+  {
+    for all i
+    {
+      a[i] = array[i1][i][i3];
+    }
+    (*f)(a);
+    for all i
+    {
+      array[i1][i][i3] = a[i];
+    }
+  }
+  \endcode
+
+  When STIR is compiled with OpenMP, the 1d arrays are distributed over the threads.
+  \c (*f)(a) therefore has to be safe to call concurrently from different threads
+  (on different \c a). This is the case for the usual (\c const) ArrayFunctionObject
+  classes.
+
+  \warning The array has to be regular and contiguous (see Array::is_contiguous()).
+*/
+template <int num_dim, typename elemT, typename FunctionObjectPtr> 
+inline void
+in_place_apply_array_function_on_index(Array<num_dim, elemT>& array, const int dim, FunctionObjectPtr f);
+
 
 //! apply any function(object) to each element of the multi-dimensional array, storing results in a different array
 /*! \ingroup Array 
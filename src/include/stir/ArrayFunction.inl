@@ -1,6 +1,7 @@
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000- 2007, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -23,6 +24,7 @@
 
   \author Kris Thielemans (some functions based on some earlier work by Darren Hague)
   \author PARAPET project
+  \author STIR developers
 
   
   \warning Compilers without partial specialisation of templates are
@@ -34,6 +36,7 @@
 #include "stir/modulo.h"
 
 #include <cmath>
+#include <cstddef>
 #include <complex>
 # ifdef BOOST_NO_STDC_NAMESPACE
     namespace std { using ::log; using ::exp; }
@@ -189,6 +192,63 @@ in_place_apply_array_function_on_1st_index(Array<num_dim, elemT>& array, Functio
     
 }
 
+template <int num_dim, typename elemT, typename FunctionObjectPtr> 
+inline void
+in_place_apply_array_function_on_index(Array<num_dim, elemT>& array, const int dim, FunctionObjectPtr f)
+{
+  assert(dim >= 1 && dim <= num_dim);
+  assert(array.is_regular());
+  assert(array.is_contiguous());
+  if (array.size_all() == 0)
+    return;
+  BasicCoordinate<num_dim, int> min_indices, max_indices;
+  array.get_regular_range(min_indices, max_indices);
+
+  // the elements of a 1d array are at (outer*length + i)*stride + inner
+  const int length = max_indices[dim] - min_indices[dim] + 1;
+  int stride = 1;
+  for (int d=dim+1; d<=num_dim; ++d)
+    stride *= max_indices[d] - min_indices[d] + 1;
+  int num_outer = 1;
+  for (int d=1; d<dim; ++d)
+    num_outer *= max_indices[d] - min_indices[d] + 1;
+  const int num_1d_arrays = num_outer*stride;
+
+  elemT * const data_ptr = array.get_full_data_ptr();
+#ifdef STIR_OPENMP
+#pragma omp parallel
+#endif
+  {
+    // every thread uses its own 1d array
+    Array<1, elemT> array1d (min_indices[dim], max_indices[dim]);
+#ifdef STIR_OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int n=0; n<num_1d_arrays; ++n)
+      {
+        elemT * const start_ptr =
+          data_ptr + static_cast<std::ptrdiff_t>(n/stride)*length*stride + n%stride;
+        // copy elements into 1d array
+        {
+          const elemT * ptr = start_ptr;
+          for (int i=min_indices[dim]; i<=max_indices[dim]; ++i, ptr += stride)
+            array1d[i] = *ptr;
+        }
+        // apply function
+        (*f)(array1d);
+        assert(array1d.get_min_index() == min_indices[dim]);
+        assert(array1d.get_max_index() == max_indices[dim]);
+        // put results back
+        {
+          elemT * ptr = start_ptr;
+          for (int i=min_indices[dim]; i<=max_indices[dim]; ++i, ptr += stride)
+            *ptr = array1d[i];
+        }
+      }
+  }
+  array.release_full_data_ptr();
+}
+
 template <int num_dim, typename elemT, typename FunctionObjectPtr> 
 inline void
 apply_array_function_on_1st_index(Array<num_dim, elemT>& out_array, 
@@ -10,6 +10,7 @@
 */
 /*
     Copyright (C) 2003- 2011, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -44,9 +45,10 @@ START_NAMESPACE_STIR
     the function to find out what the size of the record is. In that case, all IO
     handling is completely generic and is implemented in this class.
 
-    Current implementation needs a \c max_size_of_record to allocate enough memory 
-    (on the stack) before reading. This is efficient in many cases, but impractical 
-    in others.
+    Data are read from the stream in large blocks (of size get_buffer_size()) into
+    an internal buffer, and records are initialised directly from this buffer.
+    No memory is allocated per record. Positions returned by save_get_position()
+    take the buffering into account, i.e. they refer to the start of the next record.
 
     \par Requirements
     \c RecordT needs to have the following member functions
@@ -61,7 +63,7 @@ START_NAMESPACE_STIR
                          const OptionsT options);
     \endcode
 
-    \todo Allow choosing between allocation with \c new or on the stack.
+    \warning get_next_record() is not thread-safe (it modifies the internal buffer).
 */
 template <class RecordT, class OptionsT>
 class InputStreamWithRecords
@@ -125,8 +127,22 @@ public:
   inline
     void set_saved_get_positions(const std::vector<std::streampos>& );
 
+  //! get access to the underlying stream
+  /*! The stream position is set to the start of the next record, and the
+      internal buffer is discarded.
+  */
+  inline
+  std::istream& get_stream();
+
+  //! set the size of the blocks that are read from the stream
+  /*! The size will be at least \c max_size_of_record. Discards the internal buffer
+      (the current position is not affected).
+  */
+  inline
+  void set_buffer_size(const std::size_t buffer_size);
+  //! get the size of the blocks that are read from the stream
   inline
-  std::istream& get_stream(){return *this->stream_ptr;}
+  std::size_t get_buffer_size() const { return this->buffer_size; }
 
 private:
   shared_ptr<std::istream> stream_ptr;
@@ -139,6 +155,25 @@ private:
   const std::size_t max_size_of_record;
 
   const OptionsT options;
+
+  std::size_t buffer_size;
+  //! buffer with data read from the stream
+  mutable std::vector<char> buffer;
+  //! position in the stream corresponding to the start of the buffer
+  mutable std::streampos buffer_start_stream_position;
+  //! number of valid bytes in the buffer
+  mutable std::size_t num_bytes_in_buffer;
+  //! position of the next record in the buffer
+  mutable std::size_t current_position_in_buffer;
+  //! set to \c true when a read from the stream hit the end of the data
+  mutable bool eof_reached;
+
+  //! move unused bytes to the start of the buffer and read more data from the stream
+  inline void fill_buffer() const;
+  //! discard the buffer and set the stream position to \a pos
+  inline void set_position_and_discard_buffer(const std::streampos& pos);
+  //! return the position (in the stream) of the next record
+  inline std::streampos get_current_position() const;
 };
 
 END_NAMESPACE_STIR
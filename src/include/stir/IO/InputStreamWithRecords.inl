@@ -8,6 +8,7 @@
 /*
     Copyright (C) 2003-2011, Hammersmith Imanet Ltd
     Copyright (C) 2012-2013, Kris Thielemans
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -28,8 +29,11 @@
 #include "stir/Succeeded.h"
 #include "stir/is_null_ptr.h"
 #include "stir/shared_ptr.h"
-#include "boost/shared_array.hpp"
+#include "stir/warning.h"
+#include "stir/error.h"
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 
 START_NAMESPACE_STIR
 template <class RecordT, class OptionsT>
@@ -41,14 +45,20 @@ InputStreamWithRecords(const shared_ptr<std::istream>& stream_ptr,
   : stream_ptr(stream_ptr),
     size_of_record_signature(size_of_record_signature),
     max_size_of_record(max_size_of_record),
-    options(options)
+    options(options),
+    buffer_size(std::max(max_size_of_record, std::size_t(8388608))),
+    num_bytes_in_buffer(0),
+    current_position_in_buffer(0),
+    eof_reached(false)
 {
   assert(size_of_record_signature<=max_size_of_record);
+  this->buffer.resize(this->buffer_size);
   if (is_null_ptr(stream_ptr))
     return;
   starting_stream_position = stream_ptr->tellg();
   if (!stream_ptr->good())
     error("InputStreamWithRecords: error in tellg()\n");
+  buffer_start_stream_position = starting_stream_position;
 }
 
 template <class RecordT, class OptionsT>
@@ -62,9 +72,14 @@ InputStreamWithRecords(const std::string& filename,
     starting_stream_position(start_of_data),
     size_of_record_signature(size_of_record_signature),
     max_size_of_record(max_size_of_record),
-    options(options)
+    options(options),
+    buffer_size(std::max(max_size_of_record, std::size_t(8388608))),
+    num_bytes_in_buffer(0),
+    current_position_in_buffer(0),
+    eof_reached(false)
 {
   assert(size_of_record_signature<=max_size_of_record);
+  this->buffer.resize(this->buffer_size);
   std::fstream* s_ptr = new std::fstream;
   open_read_binary(*s_ptr, filename.c_str());
   stream_ptr.reset(s_ptr);
@@ -73,6 +88,31 @@ InputStreamWithRecords(const std::string& filename,
 	  filename.c_str());
 }
 
+template <class RecordT, class OptionsT>
+void
+InputStreamWithRecords<RecordT, OptionsT>::
+fill_buffer() const
+{
+  if (this->eof_reached)
+    return;
+  // move the remaining bytes to the start of the buffer
+  const std::size_t num_remaining_bytes = this->num_bytes_in_buffer - this->current_position_in_buffer;
+  if (num_remaining_bytes > 0 && this->current_position_in_buffer > 0)
+    std::memmove(&this->buffer[0], &this->buffer[this->current_position_in_buffer], num_remaining_bytes);
+  this->buffer_start_stream_position += static_cast<std::streamoff>(this->current_position_in_buffer);
+  this->current_position_in_buffer = 0;
+
+  stream_ptr->read(&this->buffer[num_remaining_bytes],
+                   static_cast<std::streamsize>(this->buffer_size - num_remaining_bytes));
+  this->num_bytes_in_buffer = num_remaining_bytes + static_cast<std::size_t>(stream_ptr->gcount());
+  if (!stream_ptr->good())
+    {
+      if (stream_ptr->bad())
+        warning("Error after reading from list mode stream in get_next_record");
+      this->eof_reached = true;
+    }
+}
+
 template <class RecordT, class OptionsT>
 Succeeded
 InputStreamWithRecords<RecordT, OptionsT>::
@@ -81,30 +121,57 @@ get_next_record(RecordT& record) const
   if (is_null_ptr(stream_ptr))
     return Succeeded::no;
 
-  // rely on file caching by the C++ library or the OS
   assert(this->size_of_record_signature <= this->max_size_of_record);
-  boost::shared_array<char> data_sptr(new char[this->max_size_of_record]);
-  char * data_ptr = data_sptr.get();
-  stream_ptr->read(data_ptr, this->size_of_record_signature);
-  if (stream_ptr->gcount()<static_cast<std::streamsize>(this->size_of_record_signature))
-    return Succeeded::no; 
-  const std::size_t size_of_record = record.size_of_record_at_ptr(data_ptr, this->size_of_record_signature,options);
+  if (this->num_bytes_in_buffer - this->current_position_in_buffer < this->size_of_record_signature)
+    {
+      this->fill_buffer();
+      if (this->num_bytes_in_buffer - this->current_position_in_buffer < this->size_of_record_signature)
+        return Succeeded::no;
+    }
+  const std::size_t size_of_record =
+    record.size_of_record_at_ptr(&this->buffer[this->current_position_in_buffer], this->size_of_record_signature,options);
   assert(size_of_record <= this->max_size_of_record);
-  if (size_of_record > this->size_of_record_signature)
-    stream_ptr->read(data_ptr + this->size_of_record_signature,
-                     size_of_record - this->size_of_record_signature);
-  if (stream_ptr->eof())
-    return Succeeded::no; 
-  else if (stream_ptr->bad())
-    { 
-      warning("Error after reading from list mode stream in get_next_record");
-      return Succeeded::no; 
+  if (this->num_bytes_in_buffer - this->current_position_in_buffer < size_of_record)
+    {
+      this->fill_buffer();
+      if (this->num_bytes_in_buffer - this->current_position_in_buffer < size_of_record)
+        return Succeeded::no;
     }
+  const char * const data_ptr = &this->buffer[this->current_position_in_buffer];
+  this->current_position_in_buffer += size_of_record;
   return 
     record.init_from_data_ptr(data_ptr, size_of_record,options);
 }
 
+template <class RecordT, class OptionsT>
+std::streampos
+InputStreamWithRecords<RecordT, OptionsT>::
+get_current_position() const
+{
+  return this->buffer_start_stream_position + static_cast<std::streamoff>(this->current_position_in_buffer);
+}
 
+template <class RecordT, class OptionsT>
+void
+InputStreamWithRecords<RecordT, OptionsT>::
+set_position_and_discard_buffer(const std::streampos& pos)
+{
+  this->num_bytes_in_buffer = 0;
+  this->current_position_in_buffer = 0;
+  this->eof_reached = false;
+  // Strangely enough, once you read past EOF, even seekg(0) doesn't reset the eof flag
+  stream_ptr->clear();
+  if (pos == std::streampos(-1))
+    {
+      stream_ptr->seekg(0, std::ios::end); // go to eof
+      this->buffer_start_stream_position = stream_ptr->tellg();
+    }
+  else
+    {
+      stream_ptr->seekg(pos);
+      this->buffer_start_stream_position = pos;
+    }
+}
 
 template <class RecordT, class OptionsT>
 Succeeded
@@ -114,10 +181,7 @@ reset()
   if (is_null_ptr(stream_ptr))
     return Succeeded::no;
 
-  // Strangely enough, once you read past EOF, even seekg(0) doesn't reset the eof flag
-  if (stream_ptr->eof()) 
-    stream_ptr->clear();
-  stream_ptr->seekg(starting_stream_position, std::ios::beg);
+  this->set_position_and_discard_buffer(starting_stream_position);
   if (stream_ptr->bad())
     return Succeeded::no;
   else
@@ -131,19 +195,14 @@ InputStreamWithRecords<RecordT, OptionsT>::
 save_get_position() 
 {
   assert(!is_null_ptr(stream_ptr));
-  // TODO should somehow check if tellg() worked and return an error if it didn't
   std::streampos pos;
-  if (!stream_ptr->eof())
+  if (!this->eof_reached || this->current_position_in_buffer < this->num_bytes_in_buffer)
     {
-      pos = stream_ptr->tellg();
-      if (!stream_ptr->good())
-	error("InputStreamWithRecords<RecordT, OptionsT>::save_get_position\n"
-	      "Error after getting position in file");
+      pos = this->get_current_position();
     }
   else
     {
       // use -1 to signify eof 
-      // (this is probably the behaviour of tellg anyway, but this way we're sure).
       pos = std::streampos(-1); 
     }
   saved_get_positions.push_back(pos);
@@ -159,11 +218,7 @@ set_get_position(const typename InputStreamWithRecords<RecordT, OptionsT>::Saved
     return Succeeded::no;
 
   assert(pos < saved_get_positions.size());
-  stream_ptr->clear();
-  if (saved_get_positions[pos] == std::streampos(-1))
-    stream_ptr->seekg(0, std::ios::end); // go to eof
-  else
-    stream_ptr->seekg(saved_get_positions[pos]);
+  this->set_position_and_discard_buffer(saved_get_positions[pos]);
     
   if (!stream_ptr->good())
     return Succeeded::no;
@@ -171,6 +226,27 @@ set_get_position(const typename InputStreamWithRecords<RecordT, OptionsT>::Saved
     return Succeeded::yes;
 }
 
+template <class RecordT, class OptionsT>
+std::istream&
+InputStreamWithRecords<RecordT, OptionsT>::
+get_stream()
+{
+  this->set_position_and_discard_buffer(this->get_current_position());
+  return *this->stream_ptr;
+}
+
+template <class RecordT, class OptionsT>
+void
+InputStreamWithRecords<RecordT, OptionsT>::
+set_buffer_size(const std::size_t buffer_size_v)
+{
+  this->buffer_size = std::max(buffer_size_v, this->max_size_of_record);
+  if (!is_null_ptr(stream_ptr))
+    this->set_position_and_discard_buffer(this->get_current_position());
+  // use swap such that memory is freed if the buffer was made smaller
+  std::vector<char>(this->buffer_size).swap(this->buffer);
+}
+
 template <class RecordT, class OptionsT>
 std::vector<std::streampos> 
 InputStreamWithRecords<RecordT, OptionsT>::
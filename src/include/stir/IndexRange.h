@@ -110,6 +110,9 @@ public:
   { return range[i]; }
   */
 
+  //! return the total number of elements in this range
+  inline size_t size_all() const;
+
   //! comparison operator
   inline bool operator==(const IndexRange<num_dimensions>&) const;
   inline bool operator!=(const IndexRange<num_dimensions>&) const;
@@ -161,6 +164,8 @@ public:
   inline int get_min_index() const;
   inline int get_max_index() const;
   inline int get_length() const;
+  //! return the total number of elements in this range (i.e. get_length(), but 0 for an empty range)
+  inline size_t size_all() const;
 
   inline bool operator==(const IndexRange<1>& range2) const;
 
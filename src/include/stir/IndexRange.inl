@@ -79,6 +79,17 @@ IndexRange(const BasicCoordinate<num_dimensions, int>& sizes)
   this->fill(lower_dims);
 }
 
+template <int num_dimensions>
+size_t
+IndexRange<num_dimensions>::
+  size_all() const
+{
+  size_t acc = 0;
+  for (const_iterator iter = this->begin(); iter != this->end(); ++iter)
+    acc += iter->size_all();
+  return acc;
+}
+
 template <int num_dimensions>
 bool
 IndexRange<num_dimensions>::
@@ -192,6 +203,10 @@ int
 IndexRange<1>::get_length() const
 { return max-min+1; }
 
+size_t
+IndexRange<1>::size_all() const
+{ return max<min ? size_t(0) : static_cast<size_t>(max-min+1); }
+
 bool
 IndexRange<1>::operator==(const IndexRange<1>& range2) const
 {
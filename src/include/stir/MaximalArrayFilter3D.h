@@ -2,6 +2,7 @@
 /*
  Copyright (C) 2006 - 2007, Hammersmith Imanet Ltd
  Copyright (C) 2010 - 2013, King's College London
+ Copyright (C) 2026, STIR developers
  This file is part of STIR.
  
  This file is free software; you can redistribute it and/or modify
@@ -22,6 +23,7 @@
   \brief Applies the dilation filter (i.e. voxel=max(neighbours))
   \author Charalampos Tsoumpas
   \author Kris Thielemans
+  \author STIR developers
 
 */
 
@@ -42,8 +44,13 @@ template <typename coordT> class Coordinate3D;
   The minimum value for a 1D array of 2n+1 elements is defined as the minimum element
   of the sorted array. 
 
-  For 3D images, the current filter works by extracting all neigbours (given by 
-  the mask) to a 1D array, and getting the maximal of that array.
+  As the maximum over the (rectangular) mask is the maximum of the maxima over its rows,
+  the filter is applied separably for regular arrays with contiguous storage,
+  using a 1D running maximum along every dimension in turn (distributing the rows
+  over threads when STIR is compiled with OpenMP). The cost per voxel is then
+  independent of the mask size. For other arrays, the current filter works by
+  extracting all neigbours (given by the mask) to a 1D array, and getting the
+  maximal of that array.
 
   This implementation of the maximal filter handles edges by taking the minimum of 
   all available pixels. For instance, when a 3x3 mask is used, and the 
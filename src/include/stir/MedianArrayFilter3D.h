@@ -47,6 +47,7 @@ template <typename coordT> class Coordinate3D;
 
   For 3D images, the current filter works by extracting all neigbours (given by 
   the mask) to a 1D array, and getting the median of that array.
+  When STIR is compiled with OpenMP, the planes are distributed over the threads.
 
   This implementation of the median filter handles edges by taking a median of 
   all available pixels. For instance, when a 3x3 mask is used, and the 
@@ -123,7 +123,11 @@ public:
   inline shared_ptr<const ProjDataInfo>
     get_proj_data_info_sptr() const;
   //! Get viewgram
-  virtual Viewgram<float> 
+  /*! Implementations of get_viewgram(), set_viewgram(), get_sinogram() and set_sinogram()
+      have to be safe to call concurrently from different threads (for different data).
+      Callers therefore do not need to serialise these calls.
+  */
+  virtual Viewgram<float>
     get_viewgram(const int view, const int segment_num,const bool make_num_tangential_poss_odd = false) const=0;
   //! Set viewgram
   virtual Succeeded 
@@ -11,12 +11,13 @@
   \author Kris Thielemans
   \author Claire Labbe
   \author PARAPET project
-
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000- 2013, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -41,6 +42,7 @@
 #include "stir/Bin.h"
 #include <iostream>
 #include <vector>
+#include <string>
 
 START_NAMESPACE_STIR
 
@@ -54,6 +56,12 @@ START_NAMESPACE_STIR
   stream isn't closed yet. This is important in an interactive context, as the object
   owning the stream might not be deleted yet before we try to read the file again.
 
+  By default, all reading is done from the same stream, and is therefore serialised when
+  using OpenMP. If the stream corresponds to a file, set_filename_for_concurrent_reading() can
+  be used to let every thread read from its own stream, such that get_viewgram() and
+  get_sinogram() (and therefore get_related_viewgrams() etc) can be called concurrently without
+  waiting for each other.
+
   \warning Data have to be contiguous.
   \warning The parameter \c make_num_tangential_poss_odd (used in various 
   \c get_ functions) is temporary and will be removed soon.
@@ -147,6 +155,18 @@ public:
   
   //! Set the value of the bin
   void set_bin_value(const Bin &bin);
+
+  //! Read from separate streams (one per thread) on \a filename
+  /*! After calling this function, get_viewgram() and get_sinogram() will open \a filename
+      (once for every thread) and read from there. This avoids serialising the reading
+      when using OpenMP. \a filename has to be the file that is also accessed by
+      the stream passed in the constructor. All writing is still done via that stream.
+      Pass an empty string to switch this off.
+
+      \warning Use only when the data are not modified while reading in parallel,
+      as the streams for reading have their own buffers.
+  */
+  void set_filename_for_concurrent_reading(const std::string& filename);
     
 protected:
   //! the stream with the data
@@ -182,6 +202,13 @@ private:
   std::vector<std::streamoff> get_offsets(const int view_num, const int segment_num) const;
   //! Calculate offsets for sinogram data
   std::vector<std::streamoff> get_offsets_sino(const int ax_pos_num, const int segment_num) const;
+
+  //! file name used for concurrent reading (empty if not used)
+  std::string filename_for_concurrent_reading;
+  //! streams used for concurrent reading, one per thread (opened when first used)
+  mutable std::vector<shared_ptr<std::istream> > concurrent_read_streams;
+  //! return the stream that the current thread can use for reading, or 0 if the shared stream has to be used
+  std::istream * get_concurrent_read_stream() const;
     
 private:
 #if __cplusplus > 199711L
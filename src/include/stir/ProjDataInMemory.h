@@ -1,6 +1,7 @@
 /*
     Copyright (C) 2002 - 2011-02-23, Hammersmith Imanet Ltd
     Copyright (C) 2019-2020, UCL
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -21,6 +22,7 @@
   \brief Declaration of class stir::ProjDataInMemory
 
   \author Kris Thielemans
+  \author STIR developers
 */
 
 #ifndef __stir_ProjDataInMemory_H__
@@ -58,6 +60,9 @@ class Succeeded;
 
   Mainly useful for temporary storage of projection data.
 
+  get_viewgram(), get_sinogram(), set_viewgram(), set_sinogram() and get_bin_value()
+  copy directly from/to the buffer. They can therefore be called from multiple threads
+  at the same time (as long as no 2 threads write to the same data).
 */
 class ProjDataInMemory : public ProjDataFromStream
 {
@@ -95,7 +100,19 @@ public:
   virtual ~ProjDataInMemory();
  
   //! Returns a  value of a bin
-  float get_bin_value(Bin& bin);
+  /*! This directly indexes the buffer, so is much faster than
+      ProjDataFromStream::get_bin_value(). It is also safe to call from multiple threads.
+  */
+  float get_bin_value(const Bin& bin) const;
+
+  //! Get viewgram (directly from the buffer)
+  Viewgram<float> get_viewgram(const int view_num, const int segment_num,const bool make_num_tangential_poss_odd=false) const;
+  //! Set viewgram (directly in the buffer)
+  Succeeded set_viewgram(const Viewgram<float>& v);
+  //! Get sinogram (directly from the buffer)
+  Sinogram<float> get_sinogram(const int ax_pos_num, const int segment_num,const bool make_num_tangential_poss_odd=false) const;
+  //! Set sinogram (directly in the buffer)
+  Succeeded set_sinogram(const Sinogram<float>& s);
     
   /// Implementation of a*x+b*y, where a and b are scalar, and x and y are ProjData.
   /// This implementation requires that x and y are ProjDataInMemory
@@ -140,9 +157,23 @@ public:
 
 private:
   Array<1,float> buffer;
+
+  //! index in the buffer of the first element of every segment
+  VectorWithOffset<int> segment_start_indices;
   
   size_t get_size_of_buffer_in_bytes() const;
 
+  //! index in the buffer of the first bin of a row (i.e. fixed axial position and view)
+  inline int get_index_of_row(const int segment_num, const int axial_pos_num, const int view_num) const
+  {
+    return this->segment_start_indices[segment_num] +
+      ((axial_pos_num - get_min_axial_pos_num(segment_num)) * get_num_views() +
+       (view_num - get_min_view_num())) * get_num_tangential_poss();
+  }
+
+  //! sets segment_start_indices. Has to be called by the constructors.
+  void set_segment_start_indices();
+
   //! allocates buffer for storing the data. Has to be called by constructors before create_stream()
   void create_buffer(const bool initialise_with_0 = false);
 
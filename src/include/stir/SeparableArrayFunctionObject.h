@@ -7,10 +7,12 @@
 
   \author Kris Thielemans
   \author Sanida Mustafovic
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2000- 2009, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -46,6 +48,11 @@ START_NAMESPACE_STIR
   'Separable' means that its operation consists of \c n 1D operations, one on each
   index of the \c n -dimensional array. 
   \see in_place_apply_array_functions_on_each_index()
+
+  For regular arrays with contiguous storage, the 1D operations are applied along
+  each dimension in turn with in_place_apply_array_function_on_index(), such that
+  the lines are distributed over the threads when STIR is compiled with OpenMP.
+  The 1D function objects therefore need to be safe to call concurrently.
   
  */
 template <int num_dimensions, typename elemT>
@@ -32,6 +32,7 @@
 */
 
 #include "stir/common.h"
+#include <atomic>
 #include "boost/iterator/iterator_adaptor.hpp"
 #include "boost/iterator/reverse_iterator.hpp"
 
@@ -382,6 +383,31 @@ protected:
   //! Called internally to see if all variables are consistent
   inline void check_state() const;
 
+  //! (re)initialise the vector with a new range, using existing data
+  /*! If \a copy_data is \c false, the vector will use the memory pointed to by
+      \a data_ptr (which has to remain valid while it is used by this object),
+      otherwise new memory is allocated and the data is copied.
+      Any memory previously allocated by this object is deallocated.
+  */
+  inline void init(const int min_index, const int max_index, 
+                   T * const data_ptr, bool copy_data);
+
+  //! swap content with another vector (without copying the data)
+  inline void swap(VectorWithOffset& other);
+
+  //! number of times that a vector not owning its memory has changed its range or memory
+  /*! This is used by Array to check cheaply if its contiguous block of memory might have
+      been modified via one of its sub-arrays (see Array::is_contiguous()).
+      The counter is shared by all vectors with the same type \c T.
+  */
+  static inline unsigned long get_num_changes_of_non_owned_memory();
+
+  //! increment the above counter
+  static inline void increment_num_changes_of_non_owned_memory();
+
+  //! increment the above counter if this object does not own its memory
+  inline void count_change_of_non_owned_memory() const;
+
 private:
   //! length of vector
   unsigned int length;	
@@ -396,6 +422,9 @@ private:
 
   //! call destructors and deallocate
   inline void _destruct_and_deallocate();
+
+  //! the counter used by get_num_changes_of_non_owned_memory()
+  static inline std::atomic<unsigned long>& _non_owned_memory_changes_counter();
   
   //! boolean to test if get_data_ptr is called
   // This variable is declared mutable such that get_const_data_ptr() can change it.
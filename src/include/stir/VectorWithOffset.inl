@@ -72,6 +72,40 @@ VectorWithOffset<T>::check_state() const
   assert(static_cast<unsigned>(end_allocated_memory-begin_allocated_memory) >= length);
 }
 
+template <class T>
+std::atomic<unsigned long>&
+VectorWithOffset<T>::
+_non_owned_memory_changes_counter()
+{
+  static std::atomic<unsigned long> counter(0UL);
+  return counter;
+}
+
+template <class T>
+unsigned long
+VectorWithOffset<T>::
+get_num_changes_of_non_owned_memory()
+{
+  return _non_owned_memory_changes_counter().load(std::memory_order_relaxed);
+}
+
+template <class T>
+void
+VectorWithOffset<T>::
+increment_num_changes_of_non_owned_memory()
+{
+  _non_owned_memory_changes_counter().fetch_add(1UL, std::memory_order_relaxed);
+}
+
+template <class T>
+void
+VectorWithOffset<T>::
+count_change_of_non_owned_memory() const
+{
+  if (!this->_owns_memory_for_data && this->capacity() != 0)
+    increment_num_changes_of_non_owned_memory();
+}
+
 template <class T>
 void 
 VectorWithOffset<T>::
@@ -95,10 +129,62 @@ void
 VectorWithOffset<T>::recycle() 
 {
   this->check_state();
+  this->count_change_of_non_owned_memory();
   this->_destruct_and_deallocate();
   this->init();
 }
 
+template <class T>
+void 
+VectorWithOffset<T>::
+init(const int min_index, const int max_index, 
+     T * const data_ptr, bool copy_data)
+{
+  this->check_state();
+  this->count_change_of_non_owned_memory();
+  this->_destruct_and_deallocate();
+  if (min_index > max_index)
+    {
+      this->init();
+      this->_owns_memory_for_data = true;
+      return;
+    }
+  this->length = static_cast<unsigned>(max_index - min_index) + 1;
+  this->start = min_index;
+  if (copy_data)
+    {
+      this->begin_allocated_memory = new T[this->length];
+      std::copy(data_ptr, data_ptr + this->length, this->begin_allocated_memory);
+      this->_owns_memory_for_data = true;
+    }
+  else
+    {
+      this->begin_allocated_memory = data_ptr;
+      this->_owns_memory_for_data = false;
+    }
+  this->end_allocated_memory = this->begin_allocated_memory + this->length;
+  this->num = this->begin_allocated_memory - min_index;
+  this->check_state();
+}
+
+template <class T>
+void 
+VectorWithOffset<T>::
+swap(VectorWithOffset& other)
+{
+  // check if data is being accessed via a pointer (see get_data_ptr())
+  assert(this->pointer_access == false);
+  assert(other.pointer_access == false);
+  this->count_change_of_non_owned_memory();
+  other.count_change_of_non_owned_memory();
+  std::swap(this->num, other.num);
+  std::swap(this->length, other.length);
+  std::swap(this->start, other.start);
+  std::swap(this->begin_allocated_memory, other.begin_allocated_memory);
+  std::swap(this->end_allocated_memory, other.end_allocated_memory);
+  std::swap(this->_owns_memory_for_data, other._owns_memory_for_data);
+}
+
 template <class T>
 int VectorWithOffset<T>::get_min_index() const 
 { 
@@ -384,6 +470,7 @@ reserve(const int new_capacity_min_index, const int new_capacity_max_index)
 
   // check if data is being accessed via a pointer (see get_data_ptr())
   assert(pointer_access == false);
+  this->count_change_of_non_owned_memory();
   // TODO use allocator here instead of new
   T *newmem = new T[new_capacity];
   const unsigned extra_at_the_left =
@@ -420,6 +507,8 @@ resize(const int min_index, const int max_index)
   this->check_state();
   if (min_index > max_index)
     {
+      if (length > 0)
+        this->count_change_of_non_owned_memory();
       length = 0; start = 0; num = begin_allocated_memory;
       return;
     }
@@ -428,6 +517,7 @@ resize(const int min_index, const int max_index)
     {
       if (min_index == this->get_min_index() && max_index == this->get_max_index())
 	return;
+      this->count_change_of_non_owned_memory();
       // determine overlapping range to avoid copying too much data when calling reserve()
       const int overlap_min_index = std::max(this->get_min_index(), min_index);
       const int overlap_max_index = std::min(this->get_max_index(), max_index);
@@ -471,6 +561,8 @@ VectorWithOffset<T>::resize(const unsigned new_size)
 {
   if (new_size==0)
     {
+      if (length > 0)
+        this->count_change_of_non_owned_memory();
       length = 0; start = 0; num = begin_allocated_memory;
     }
   else
@@ -502,6 +594,8 @@ VectorWithOffset<T>::operator= (const VectorWithOffset &il)
   this->check_state();
   if (this == &il) return *this;		// in case of x=x
   {		
+    if (this->size() != il.size())
+      this->count_change_of_non_owned_memory();
     if (this->capacity() < il.size())
     {
       // first truncate current and then reserve space
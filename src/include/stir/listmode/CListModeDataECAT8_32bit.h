@@ -78,6 +78,10 @@ private:
   typedef CListRecordECAT8_32bit CListRecordT;
   std::string listmode_filename;
   shared_ptr<InputStreamWithRecords<CListRecordT, bool> > current_lm_data_ptr;
+  //! record that is copied by get_empty_record_sptr()
+  /*! Copies share the uncompressed ProjDataInfo (and its lookup tables), which
+      avoids a lot of memory when using batches of records. */
+  shared_ptr<CListRecordT> empty_record_sptr;
 
   InterfileListmodeHeaderSiemens interfile_parser;
 
@@ -30,6 +30,7 @@
 #define __stir_listmode_ListModeData_H__
 
 #include <string>
+#include <vector>
 #include <ctime>
 #include "stir/ProjDataInfo.h"
 #include "stir/ExamData.h"
@@ -186,6 +187,22 @@ public:
     Succeeded get_next_record(ListRecord& event) const
     {      return get_next(event);}
 
+  //! Gets a batch of records from the listmode sequence
+  /*! If \a records is empty, it is first resized to \a default_batch_size
+      and filled with empty records. Otherwise, all its elements have to point
+      to records of the correct type (e.g. from get_empty_record_sptr()).
+
+      \return the number of records read. Only the first elements of \a records
+      are valid. The return value is smaller than <code>records.size()</code> only
+      at the end of the data.
+
+      The default implementation calls get_next_record().
+      \see ListModeDataReadAhead for reading batches in a background thread.
+  */
+  virtual
+    std::size_t get_next_records(std::vector<shared_ptr<ListRecord> >& records,
+                                 const std::size_t default_batch_size = 10000) const;
+
   //! Call this function if you want to re-start reading at the beginning.
   virtual
     Succeeded reset() = 0;
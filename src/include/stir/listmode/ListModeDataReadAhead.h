@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup listmode
+  \brief Declaration of class stir::ListModeDataReadAhead
+
+  \author STIR developers
+*/
+
+#ifndef __stir_listmode_ListModeDataReadAhead_H__
+#define __stir_listmode_ListModeDataReadAhead_H__
+
+#include "stir/listmode/ListModeData.h"
+#include "stir/shared_ptr.h"
+#include "stir/Succeeded.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \brief A class that reads (and decodes) list mode records in a background thread
+  \ingroup listmode
+
+  This class works with any ListModeData object. A background thread reads
+  batches of records (of size \c batch_size) via ListModeData::get_next_records()
+  and puts them in a queue of at most \c max_num_batches batches. The consumer
+  gets the batches via get_next_records(). Reading from disk and decoding the
+  records therefore overlaps with the processing of the records by the consumer.
+
+  \code
+  ListModeDataReadAhead read_ahead(lm_data_sptr);
+  std::vector<shared_ptr<ListRecord> > records;
+  std::size_t num_records;
+  while ((num_records = read_ahead.get_next_records(records)) > 0)
+    for (std::size_t i=0; i<num_records; ++i)
+      {
+        const ListRecord& record = *records[i];
+        // do something
+      }
+  \endcode
+
+  The records are not copied: get_next_records() swaps \a records with a batch
+  in the queue. The previous content of \a records is reused for reading.
+
+  Positions are handled at the level of batches, i.e. save_get_position()
+  returns the position after the last batch returned by get_next_records().
+  As ListModeData::save_get_position() keeps every saved position, the background
+  thread does not save any positions. Instead, this object remembers where reading
+  started and counts the records returned to the consumer. save_get_position()
+  therefore stops the reading thread, and (if records were read ahead) goes back
+  to the start and skips the records that were already returned. Only one position
+  is saved by the constructor, and one per call to save_get_position().
+
+  \warning While an object of this class exists, the ListModeData object should
+  not be used directly (as it is accessed by the background thread).
+*/
+class ListModeDataReadAhead
+{
+public:
+  typedef std::vector<shared_ptr<ListRecord> > RecordBatch;
+
+  //! Constructor, starts the background thread
+  explicit ListModeDataReadAhead(const shared_ptr<ListModeData>& lm_data_sptr,
+                                 const std::size_t batch_size = 10000,
+                                 const std::size_t max_num_batches = 4);
+
+  //! Destructor, stops the background thread
+  ~ListModeDataReadAhead();
+
+  //! Get the next batch of records
+  /*! \return the number of valid records in \a records (0 at the end of the data).
+      \a records will be resized to the batch size.
+  */
+  std::size_t get_next_records(RecordBatch& records);
+
+  //! Start reading at the beginning of the list mode data
+  Succeeded reset();
+
+  //! Save the position after the last batch returned by get_next_records()
+  /*! The returned value can be used with set_get_position() of this object
+      (or of the underlying ListModeData).
+  */
+  ListModeData::SavedPosition save_get_position();
+
+  //! Set the position for reading to a previously saved point
+  Succeeded set_get_position(const ListModeData::SavedPosition&);
+
+  std::size_t get_batch_size() const { return batch_size; }
+
+private:
+  struct Batch
+  {
+    RecordBatch records;
+    std::size_t num_records;
+  };
+
+  shared_ptr<ListModeData> lm_data_sptr;
+  const std::size_t batch_size;
+  const std::size_t max_num_batches;
+
+  std::thread reading_thread;
+  std::mutex mutex;
+  //! used to notify the consumer that a batch was added
+  std::condition_variable batch_added;
+  //! used to notify the reading thread that a batch was consumed, or that it has to stop
+  std::condition_variable batch_consumed;
+
+  //! batches ready for the consumer
+  std::deque<Batch> filled_batches;
+  //! record vectors that can be reused by the reading thread
+  std::vector<RecordBatch> free_batches;
+  //! \c true while the reading thread is running
+  bool reading;
+  //! set to request the reading thread to stop
+  bool stop_requested;
+  //! exception thrown in the reading thread
+  std::exception_ptr exception_ptr;
+
+  //! \name information on the position of the consumer
+  //@{
+  //! if \c true, reading started at the beginning of the data (after reset())
+  bool start_is_beginning;
+  //! position where reading started (if not \c start_is_beginning)
+  ListModeData::SavedPosition start_position;
+  //! number of records returned by get_next_records() since reading started
+  std::size_t num_records_consumed;
+  //! number of records read by the reading thread since reading started
+  std::size_t num_records_read;
+  //@}
+
+  //! function run by the reading thread
+  void read_batches();
+  void start_reading();
+  void stop_reading();
+};
+
+END_NAMESPACE_STIR
+
+#endif
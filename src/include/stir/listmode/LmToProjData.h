@@ -111,9 +111,13 @@ class ListEnergy;
     List event coordinates := 0
 
     ; if you're short of RAM (i.e. a single projdata does not fit into memory),
-    ; you can use this to process the list mode data in multiple passes.
+    ; you can use this to limit the number of segments that are kept in memory.
+    ; (see below for what happens with the other segments)
     num_segments_in_memory := -1
 
+    ; bin the data in a single pass in integer counts (see below)
+    use integer histogramming := 1 ; default
+
   End := 
   \endverbatim
   
@@ -148,6 +152,25 @@ class ListEnergy;
   </li>
   </ul>
 
+  \par Integer histogramming
+
+  By default (<tt>use integer histogramming := 1</tt>), the data is binned in a
+  single pass over the list mode file into 32-bit integer counts. The events are
+  read in batches, and the bins of the events in a batch are computed in parallel
+  (when STIR is compiled with OpenMP). Segments that are not in memory (see
+  \c num_segments_in_memory) are not handled by going through the list mode file
+  again, but by writing the (compact) bin index of their events to a temporary
+  file which is binned when the frame is finished.
+
+  This mode can only be used when every event contributes 1 (or -1 for subtracted
+  delayeds), i.e. it is not used for pre-normalisation, post-normalisation (other
+  than \c None), \c num_events_to_store, <tt>List event coordinates</tt>, or when
+  can_use_integer_histogramming() returns false.
+  As get_bin_from_event() is then called from multiple threads, it is also only used
+  for list mode data whose events derive from CListEventCylindricalScannerWithDiscreteDetectors
+  (the only event types currently known to be thread-safe).
+  In all these cases, the (multi-pass) floating point binning is used.
+
   \par Notes for developers
 
   The class provides several
@@ -195,6 +218,11 @@ protected:
   /*! If bin.get_bin_value()<=0, the event will be ignored. Otherwise,
     the value will be used as a bin-normalisation factor 
     (on top of anything done by normalisation_ptr). 
+
+    \warning With integer histogramming, this function is called from multiple
+    OpenMP threads at the same time. Overloads therefore must not modify
+    member variables, or have to disable integer histogramming via
+    can_use_integer_histogramming().
     \todo Would need timing info or so for e.g. time dependent
     normalisation or angle info for a rotating scanner.*/
   virtual void get_bin_from_event(Bin& bin, const ListEvent&, const std::pair<int,int> &energy_window_pair = std::pair<int,int>(1,1))  const;
@@ -211,6 +239,17 @@ protected:
   */
   void do_post_normalisation(Bin& bin) const;
 
+  //! Returns if integer histogramming can be used with the current parameters
+  /*! This checks if every event will contribute 1 (or -1) to its bin, and if
+      ListEvent::get_bin() is known to be thread-safe for the list mode data, i.e.
+      if its events derive from CListEventCylindricalScannerWithDiscreteDetectors.
+      Derived classes that modify the bin-value in get_bin_from_event(), or which
+      rely on the events being processed serially (get_bin_from_event() is
+      called from multiple threads when using integer histogramming),
+      have to overload this function and return \c false.
+  */
+  virtual bool can_use_integer_histogramming() const;
+
   //! \name parsing functions
   //@{
   virtual void set_defaults();
@@ -230,6 +269,9 @@ protected:
   bool store_prompts;
   bool store_delayeds;
   int num_segments_in_memory;
+  //! use single-pass binning into integer counts if possible
+  /*! corresponds to key "use integer histogramming" */
+  bool use_integer_histogramming;
   long int num_events_to_store;
   int max_segment_num_to_process;
 
@@ -271,6 +313,9 @@ protected:
   //! A variable that will be set to 1,0 or -1, according to store_prompts and store_delayeds
   int delayed_increment;
 
+ private:
+  //! The implementation of process_data() for integer histogramming
+  void process_data_with_integer_counts();
 };
 
 END_NAMESPACE_STIR
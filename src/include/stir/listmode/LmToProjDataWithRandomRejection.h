@@ -95,6 +95,9 @@ protected:
 
   virtual void get_bin_from_event(Bin& bin, const ListEvent&) const;
 
+  //! events are not counted as 1, so returns \c false
+  virtual bool can_use_integer_histogramming() const { return false; }
+
 
   // \name parsing variables
   //@{
@@ -0,0 +1,98 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_numerics_FourierPlan_h__
+#define __stir_numerics_FourierPlan_h__
+/*!
+  \file
+  \ingroup DFT
+  \brief Declaration of class stir::FourierPlan
+
+  \author STIR developers
+*/
+#include "stir/shared_ptr.h"
+#include <complex>
+#include <string>
+
+START_NAMESPACE_STIR
+
+/*! \ingroup DFT
+  \brief A precomputed one-dimensional discrete fourier transform of a given length
+
+  This class is the backend of fourier(), fourier_1d() and the DFT functions
+  for real data. It is normally not necessary to use it directly.
+
+  Plans are obtained via get_plan(). They are created on first use and kept
+  for reuse, such that twiddle factors etc. are only computed once per
+  length and sign. A plan is constant after construction, so it can be used
+  from multiple threads simultaneously.
+
+  The implementation is chosen when STIR is built. When FFTW3 (single precision)
+  is found by CMake, it will be used. Otherwise, a mixed-radix FFT
+  (with specialised radix 2, 3 and 4 butterflies) is used. Both support
+  any length, although the FFT is fastest for lengths with small prime factors.
+
+  The convention for the transform is as documented in fourier_1d().
+*/
+class FourierPlan
+{
+public:
+  typedef std::complex<float> complex_type;
+
+  //! get a plan for transforms of length \a length
+  /*! \a sign has to be 1 or -1. */
+  static shared_ptr<const FourierPlan>
+    get_plan(const int length, const int sign);
+
+  //! name of the implementation, e.g. for diagnostics
+  static std::string get_backend_name();
+
+  virtual ~FourierPlan() {}
+
+  int get_length() const { return length; }
+  int get_sign() const { return sign; }
+
+  //! compute a single transform in place
+  /*! The elements are at <tt>data[i*stride]</tt>, with \c i from 0 to <tt>get_length()-1</tt>. */
+  void transform(complex_type* data, const int stride = 1) const;
+
+  //! compute several transforms in place
+  /*! Transform \c t uses the elements at <tt>data[t*distance + i*stride]</tt>.
+      When STIR is compiled with OpenMP, large batches are distributed over the threads.
+  */
+  void transform_many(complex_type* data, const int num_transforms,
+                      const int stride, const int distance) const;
+
+protected:
+  FourierPlan(const int length, const int sign);
+
+  //! do a single transform
+  /*! \a work_buffer points to storage for get_length() elements that the
+      implementation can use (the contents are undefined on entry).
+  */
+  virtual void
+    transform_using_buffer(complex_type* data, const int stride, complex_type* work_buffer) const = 0;
+
+private:
+  const int length;
+  const int sign;
+};
+
+END_NAMESPACE_STIR
+
+#endif
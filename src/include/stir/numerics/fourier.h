@@ -7,10 +7,12 @@
   \brief Functions for computing FFTs
 
   \author Kris Thielemans
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2003- 2011, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -85,7 +87,11 @@ inline void inverse_fourier(T& c, const int sign=1)
   \param[in] sign This can be used to implement a different convention for the DFT
 
   \warning Currently, the array has to be indexed from 0.
-  \warning Currently, the length of the array has to be a power of 2.
+
+  Any length is supported, but the transform is fastest when the length
+  has only small prime factors (2, 3, 4, 5, ...). The transforms are done with
+  FourierPlan objects, which are created on first use for every length, and are
+  then reused. When STIR was built with FFTW3, that library is used.
    
   The convention used is as follows.
   For a vector of length \a n, the result is
@@ -94,14 +100,12 @@ inline void inverse_fourier(T& c, const int sign=1)
   \f]
   This means that the zero-frequency will be returned in <tt>c[0]</tt>
    
-  This function can be used with more general type of \a c (if instantiated in fourier.cxx).
-  The type \a T has to be such that \a T::value_type, \a T::reference and 
-  <tt> T::reference T::operator[](const int)</tt> exist. Moreover, numerical
-  operations
-  <tt>operator*=(T::reference, std::complex\<float\>)</tt>,
-  <tt>operator+=(T::reference, T::value_type)</tt> and
-  <tt>operator*=(T::reference, int)</tt>,
-   have to be defined as well.
+  Currently, \a T can be <code>VectorWithOffset\<std::complex\<float\> \></code> or
+  <code>Array\<n,std::complex\<float\> \></code> (for \a n up to 3). Arrays have to have
+  a regular index range. For multi-dimensional arrays, the transforms are computed as a
+  batch of 1D transforms, which is parallelised when STIR is compiled with OpenMP.
+  If the array is not stored contiguously (see Array::is_contiguous()), a temporary
+  copy is made.
 */
 template <typename T>
 void fourier_1d(T& c, const int sign);
@@ -36,6 +36,10 @@
 #include "stir/RegisteredObject.h"
 #include "stir/TimedObject.h"
 #include "stir/shared_ptr.h"
+#include <vector>
+#ifdef STIR_OPENMP
+#include <omp.h>
+#endif
 
 START_NAMESPACE_STIR
 
@@ -50,6 +54,31 @@ template <typename DataT> class DataProcessor;
 /*!
   \ingroup projection
   \brief Abstract base class for all back projectors
+
+  \par Accumulation with OpenMP
+
+  When using OpenMP, threads back project into their own (private) image, and these
+  images are summed by get_output(). This summation is done in parallel, with every
+  thread handling a slab of planes.
+
+  As this needs one copy of the image per thread, the number of images can be limited
+  with set_max_num_accumulation_images() (or the corresponding parsing keyword).
+  The threads then share these images: a thread locks a free image for the duration of
+  the back projection of one set of related viewgrams (preferring the image with index
+  <tt>thread_num % num_images</tt>), and waits if no image is free. The memory used is then
+  independent of the number of threads, at the cost of some waiting when there are
+  many more threads than images.
+
+  \par Parsing
+  \verbatim
+  Back Projector Parameters :=
+    ; optional post-processing of the back projected image
+    post data processor := None
+    ; maximum number of images used to accumulate the result of the OpenMP threads
+    ; (0 means one image per thread)
+    maximum number of images for accumulation := 0
+  End Back Projector Parameters :=
+  \endverbatim
 */
 class BackProjectorByBin : 
   public TimedObject,
@@ -144,6 +173,14 @@ void back_project(const RelatedViewgrams<float>&,
   /// Set data processor to use after back projection
   void set_post_data_processor(shared_ptr<DataProcessor<DiscretisedDensity<3,float> > > post_data_processor_sptr);
 
+  //! Set the maximum number of images used to accumulate the back projections of the OpenMP threads
+  /*! 0 (the default) means that every thread gets its own image.
+      You need to call set_up() after calling this function.
+  */
+  void set_max_num_accumulation_images(const int max_num_images);
+  //! Get the maximum number of images used to accumulate the back projections of the OpenMP threads
+  int get_max_num_accumulation_images() const;
+
 protected:
 
   /*! \brief This actually does the back projection.
@@ -183,6 +220,8 @@ protected:
   //! Clone of the density sptr set with set_up()
   shared_ptr<DiscretisedDensity<3,float> > _density_sptr;
   shared_ptr<DataProcessor<DiscretisedDensity<3,float> > > _post_data_processor_sptr;
+  //! maximum number of images used for accumulation with OpenMP (0 means one per thread)
+  int _max_num_accumulation_images;
 
   virtual void set_defaults();
   virtual void initialise_keymap();
@@ -198,9 +237,24 @@ protected:
 	    const int start_view, const int end_view);
 
 #ifdef STIR_OPENMP
-  //! A vector of back projected images that will be used with openMP. There will be as many images as openMP threads
+  //! A vector of back projected images that will be used with openMP.
+  /*! There will be as many images as openMP threads, unless limited by \c _max_num_accumulation_images. */
   std::vector< shared_ptr<DiscretisedDensity<3,float> > > _local_output_image_sptrs;
+  //! locks for \c _local_output_image_sptrs
+  std::vector<omp_lock_t> _local_output_image_locks;
+  //! index of the image currently used by every thread
+  std::vector<int> _local_output_image_index_for_thread;
+
+  //! lock an image for the current thread (and allocate it if necessary), and return its index
+  int lock_local_output_image();
+  //! unlock the image with this index
+  void unlock_local_output_image(const int image_index);
+  //! destroy all locks
+  void destroy_local_output_image_locks();
 #endif
+  //! sum all images in \a image_sptrs into \a density (in parallel over planes)
+  static void sum_images(DiscretisedDensity<3,float>& density,
+                         const std::vector< shared_ptr<DiscretisedDensity<3,float> > >& image_sptrs);
 };
 
 END_NAMESPACE_STIR
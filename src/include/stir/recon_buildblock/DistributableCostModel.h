@@ -0,0 +1,96 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup distributable
+
+  \brief Declaration of class stir::DistributableCostModel
+
+  \author STIR developers
+*/
+
+#ifndef __stir_recon_buildblock_DistributableCostModel_H__
+#define __stir_recon_buildblock_DistributableCostModel_H__
+
+#include "stir/ViewSegmentNumbers.h"
+#include <vector>
+#include <map>
+
+START_NAMESPACE_STIR
+
+class ProjDataInfo;
+class DataSymmetriesForViewSegmentNumbers;
+
+/*!
+  \ingroup distributable
+  \brief Estimates the computation time of related viewgrams to order the work in distributable_computation()
+
+  The cost of the related viewgrams of a basic ViewSegmentNumbers is estimated as
+  \f[ N_\mathrm{related} N_\mathrm{axial} N_\mathrm{tangential} \sqrt{1+\tan^2\theta} \f]
+  i.e. the number of bins times the relative length of an LOR (through a slab of the image).
+  Once a time has been measured (e.g. in a previous subiteration), it is used instead.
+  Estimates for view/segments that were not measured yet are scaled with the ratio of measured
+  time and geometric estimate of the others, such that both can be compared.
+
+  distributable_computation() processes the view/segments in order of decreasing cost.
+  Combined with dynamic scheduling, this avoids that a thread starts on an expensive
+  (oblique) view/segment when the others are almost finished.
+
+  This class is not thread-safe. set_measured_cost() should be called after the parallel loop.
+*/
+class DistributableCostModel
+{
+public:
+  DistributableCostModel();
+
+  //! forget all measured costs
+  void reset();
+
+  //! geometric estimate of the cost (independent of measurements)
+  static double
+    get_geometric_cost(const ProjDataInfo& proj_data_info,
+                       const DataSymmetriesForViewSegmentNumbers& symmetries,
+                       const ViewSegmentNumbers& vs_num);
+
+  //! estimated cost (in seconds if there are measurements, otherwise relative)
+  double get_estimated_cost(const ProjDataInfo& proj_data_info,
+                            const DataSymmetriesForViewSegmentNumbers& symmetries,
+                            const ViewSegmentNumbers& vs_num) const;
+
+  //! store the time (in seconds) that the computation for \a vs_num took
+  /*! \a geometric_cost has to be the value returned by get_geometric_cost(). */
+  void set_measured_cost(const ViewSegmentNumbers& vs_num, const double measured_cost, const double geometric_cost);
+
+  //! returns \a vs_nums sorted on decreasing estimated cost
+  std::vector<ViewSegmentNumbers>
+    sort_by_decreasing_cost(const std::vector<ViewSegmentNumbers>& vs_nums,
+                            const ProjDataInfo& proj_data_info,
+                            const DataSymmetriesForViewSegmentNumbers& symmetries) const;
+
+private:
+  //! pairs of measured and geometric cost
+  typedef std::map<ViewSegmentNumbers, std::pair<double, double> > costs_type;
+  costs_type measured_costs;
+  double sum_measured_costs;
+  double sum_geometric_costs_of_measured;
+};
+
+END_NAMESPACE_STIR
+
+#endif
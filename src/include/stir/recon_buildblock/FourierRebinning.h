@@ -9,12 +9,14 @@
   \author Kris Thielemans
   \author Oliver Nix
   \author PARAPET project
+  \author STIR developers
 */
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2003 - 2005, Hammersmith Imanet Ltd
     Copyright (C) 2004 - 2005 DKFZ Heidelberg, Germany
     Copyright (C) 2011-07-01 - 2012, Kris Thielemans
+    Copyright (C) 2026, STIR developers
 
     This file is part of STIR.
 
@@ -65,6 +67,7 @@ class PETCount_rebinned
 #ifdef PARALLEL
     friend PMessage& operator<<(PMessage&, PETCount_rebinned&);
     friend PMessage& operator>>(PMessage&, PETCount_rebinned&);
+#endif
 
     PETCount_rebinned & operator+= (const PETCount_rebinned &rebin)
         {
@@ -73,7 +76,6 @@ class PETCount_rebinned
             ssrb += rebin.ssrb;
             return *this;
         }
-#endif
 // Default constructor by initialising all the elements conter to null
     explicit PETCount_rebinned(int total_v=0, int miss_v =0, int ssrb_v = 0)
         :total(total_v), miss(miss_v), ssrb(ssrb_v)
@@ -85,7 +87,7 @@ class PETCount_rebinned
 /*!
   \class FourierRebinning
   \ingroup recon_buildblock
-  \brief Class for Serial FORE Reconstruction.
+  \brief Class for FORE Reconstruction.
 
 
   The digital implementation of the rebinning is done as follows:
@@ -99,6 +101,11 @@ class PETCount_rebinned
   c) Normalise Pr(w,k) for the variable number of contributions to each w, k, r ;<BR>
   d) Calculate the 2D inverse FFT of each Pr(w,k) to get the rebinned sinogram Pr(s,f);
 
+  When compiled with OpenMP, the 2D FFTs in b) are computed in parallel for a batch of sinograms,
+  after which the assignment to Pr(w,k) is distributed over the threads according to k. As every Pr(w,k)
+  is then updated in the same order as in a serial implementation, the result does not depend
+  on the number of threads. The inverse FFTs in d) are computed in parallel as well.
+
   As FORE is based on a high frequency approximation, it is necessary to handle separately low and high frequencies. 
   This is done by subdividing the (w,k) plane into three sub regions defined by two parameters 
   in Fourier space, w (the continuous frequency corresponding to the radial coordinates s) and k 
@@ -175,13 +182,16 @@ class FourierRebinning : public   RegisteredParsingObject<
   and returns the updated stack of 2D rebinned sinograms still in Fourier space,
   the updated weigthing factors as well as  the new rebinned elements counter.
 
- 
+  \a z is the axial position of the sinogram in units of half the ring spacing.
+  Only the angular frequencies \a min_k till \a max_k are handled, such that
+  different ranges can be handled by different threads.
 */
     void rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &Weights_for_FT_rebinned_data,
-       PETCount_rebinned &num_rebinned, const Array<2,std::complex<float> > &FT_current_sinogram, const float z, 
+       PETCount_rebinned &num_rebinned, const Array<2,std::complex<float> > &FT_current_sinogram, const int z, 
        const float average_ring_difference_in_segment, const int num_views_pow2, const int num_tang_poss_pow2,
        const float half_distance_between_rings, const float sampling_distance_in_s, const float radial_sampling_freq_w,
-       const float R_field_of_view_mm, const float ratio_ring_spacing_to_ring_radius);
+       const float R_field_of_view_mm, const float ratio_ring_spacing_to_ring_radius,
+       const int min_k, const int max_k);
 
 /*!
   \brief This method takes as input the real 3D data set
@@ -37,6 +37,9 @@
 #include "stir/ProjDataInMemory.h"
 #include "stir/recon_buildblock/ProjectorByBinPairUsingProjMatrixByBin.h"
 #include "stir/ExamInfo.h"
+#include "stir/is_null_ptr.h"
+#include <boost/cstdint.hpp>
+#include <vector>
 START_NAMESPACE_STIR
 
 
@@ -51,6 +54,33 @@ START_NAMESPACE_STIR
   If the list mode data is binned (with LmToProjData) without merging
   any bins, then the log likelihood computed from list mode data and
   projection data will be identical.
+
+  \par Parallel computation of the gradient
+
+  When compiled with OpenMP, events are read from the list mode data in batches
+  (of size <tt>num_events_per_batch</tt>). The events in a batch are then forward
+  and back projected by all threads, each thread accumulating into its own
+  gradient image. These images are summed at the end of the subiteration.
+  The result is therefore identical to the serial computation up to
+  the order of the floating point additions.
+
+  \par Caching of the events
+
+  By default, the list mode data is read (and decoded) at every subiteration, only
+  keeping the events that belong to the current subset. When setting
+  <tt>cache list mode events</tt> to 1, the events of the current time frame are
+  read only once (during set_up()) and stored in memory in a compact form, sorted
+  by subset. This costs 12 bytes per event, but avoids all I/O afterwards.
+
+  When setting <tt>read list mode data in background thread</tt> to 1, the list mode
+  data is read and decoded by a separate thread (see ListModeDataReadAhead), such
+  that reading overlaps with the processing of the events.
+
+  \par Additive term
+
+  The additive projection data is always stored in memory (as ProjDataInMemory).
+  Its value for an event is looked up when the event is read (or cached), such that
+  the projection of the events does not need to access the additive data at all.
 */
 
 template <typename TargetT>
@@ -127,6 +157,74 @@ protected:
 
   void
     add_view_seg_to_sensitivity(const ViewSegmentNumbers& view_seg_nums) const;
+
+  //! number of events that are read before they are projected (in parallel)
+  unsigned long num_events_per_batch;
+
+  //! compact storage of the bin of an event and its additive term
+  struct CachedEvent
+  {
+    boost::int16_t segment_num;
+    boost::int16_t view_num;
+    boost::int16_t axial_pos_num;
+    boost::int16_t tangential_pos_num;
+    float additive_value;
+
+    CachedEvent() {}
+    explicit CachedEvent(const Bin& bin, const float additive_value_v = 0.F)
+      : segment_num(static_cast<boost::int16_t>(bin.segment_num())),
+        view_num(static_cast<boost::int16_t>(bin.view_num())),
+        axial_pos_num(static_cast<boost::int16_t>(bin.axial_pos_num())),
+        tangential_pos_num(static_cast<boost::int16_t>(bin.tangential_pos_num())),
+        additive_value(additive_value_v)
+    {}
+    //! returns the bin (with value 1)
+    Bin get_bin() const
+    { return Bin(segment_num, view_num, axial_pos_num, tangential_pos_num, 1.F); }
+  };
+
+  //! if \c true, the events are stored in memory, see class documentation
+  bool cache_lm_events;
+  //! if \c true, list mode data is read with ListModeDataReadAhead
+  bool read_ahead;
+  //! the events of every subset (only used if cache_lm_events is \c true)
+  std::vector<std::vector<CachedEvent> > event_cache;
+  //! the time frame corresponding to the events in event_cache
+  unsigned int event_cache_frame_num;
+
+  //! read all events of the current time frame into event_cache
+  void cache_events();
+
+  //! find the bin and subset of an event
+  /*! \return \c false if the event is outside the range of the projection data
+      (in which case it should be ignored). */
+  bool get_bin_and_subset_for_event(Bin& measured_bin, int& subset_num, const ListEvent& event) const;
+
+  //! construct the compact event, including the additive term
+  inline CachedEvent make_cached_event(const Bin& measured_bin) const
+  {
+    return CachedEvent(measured_bin,
+                       is_null_ptr(this->additive_proj_data_sptr) ?
+                       0.F : this->additive_proj_data_sptr->get_bin_value(measured_bin));
+  }
+
+  //! prepare (thread-local) storage for accumulating events into \a gradient
+  void start_accumulating_events_in_new_gradient(const TargetT& gradient);
+  //! forward and back project a batch of events, accumulating into the gradient
+  /*! When using OpenMP, the result is accumulated into thread-local images, such that
+      finish_accumulating_events_in_gradient() needs to be called afterwards.
+  */
+  void add_events_to_gradient(TargetT& gradient,
+                              const TargetT& current_estimate,
+                              const typename std::vector<CachedEvent>::const_iterator events_begin,
+                              const typename std::vector<CachedEvent>::const_iterator events_end);
+  //! add the contributions of all threads to \a gradient
+  void finish_accumulating_events_in_gradient(TargetT& gradient);
+
+#ifdef STIR_OPENMP
+  //! A vector of gradient images that will be used with openMP. There will be as many images as openMP threads
+  std::vector<shared_ptr<TargetT> > local_gradient_sptrs;
+#endif
 };
 
 END_NAMESPACE_STIR
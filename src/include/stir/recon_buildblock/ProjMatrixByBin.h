@@ -15,6 +15,7 @@
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000-2009, Hammersmith Imanet Ltd
     Copyright (C) 2013, 2015 University College London
+    Copyright (C) 2026, STIR developers
 
     This file is part of STIR.
 
@@ -41,6 +42,8 @@
 #include <boost/cstdint.hpp>
 //#include <map>
 #include <boost/unordered_map.hpp>
+#include <atomic>
+#include <vector>
 #ifdef STIR_OPENMP
 #include <omp.h>
 #endif
@@ -80,10 +83,34 @@ class Bin;
   \verbatim
   disable caching := false
   store only basic bins in cache := true
+  cache memory limit in MB := 0
   \endverbatim
   The 2nd option allows to cache the whole matrix. This results in the fastest
   behaviour IF your system does not start swapping. The default choice caches 
   only the 'basic' bins, and computes symmetry related bins from the 'basic' ones.
+
+  The 3rd option sets a limit on the (approximate) memory used by the cache (0 means no limit).
+  When the limit is exceeded, elements that have not been used recently are removed
+  from the cache (using the CLOCK algorithm, see below). They will be recomputed when needed.
+  This allows caching on scanners where the full matrix does not fit in memory.
+
+  \par Implementation of the cache
+
+  The cache is split into one hash-map per view and segment. When using OpenMP, every
+  such map has its own lock, such that threads only wait for each other when
+  accessing the same view/segment at the same time.
+
+  Every element in the cache has a flag that is set when it is used. When
+  the memory limit is exceeded, the maps are visited in turn (in a circular fashion).
+  Elements with a flag that is set get a 'second chance' (i.e. their flag is reset),
+  while the others are removed, until the memory used is below 90% of the limit.
+
+  A cache hit only reads the map (the flag is a relaxed atomic that is only written
+  when it is not yet set), such that threads do not write to shared memory
+  when elements are found.
+
+  The number of cache hits and misses can be found via get_cache_statistics().
+  They are counted per thread and summed when the statistics are requested.
 */
 class ProjMatrixByBin :  
   public RegisteredObject<ProjMatrixByBin>,
@@ -153,6 +180,33 @@ public:
   //! Remove all elements from the cache
   void clear_cache() STIR_MUTABLE_CONST;
 
+  //! Set the limit on the memory used by the cache (0 means no limit)
+  void set_cache_memory_limit_in_MB(const int limit);
+  //! Get the limit on the memory used by the cache (0 means no limit)
+  int get_cache_memory_limit_in_MB() const;
+
+  //! A class to collect the statistics of the cache
+  class CacheStatistics
+  {
+  public:
+    CacheStatistics()
+      : num_hits(0), num_misses(0), num_evictions(0), memory_used_in_bytes(0)
+    {}
+    //! number of times an element was found in the cache
+    unsigned long num_hits;
+    //! number of times an element was not found in the cache
+    unsigned long num_misses;
+    //! number of elements removed from the cache due to the memory limit
+    unsigned long num_evictions;
+    //! current (approximate) amount of memory used by the cache
+    std::size_t memory_used_in_bytes;
+  };
+
+  //! Get the statistics of the cache (since the start or last call to reset_cache_statistics())
+  CacheStatistics get_cache_statistics() const;
+  //! Reset number of hits, misses and evictions to 0
+  void reset_cache_statistics() STIR_MUTABLE_CONST;
+
   
 protected:
   shared_ptr<DataSymmetriesForBins> symmetries_sptr;
@@ -191,6 +245,8 @@ protected:
 
   bool cache_disabled;  
   bool cache_stores_only_basic_bins;
+  //! limit on the memory used by the cache (0 means no limit)
+  int cache_memory_limit_in_MB;
 
   /*! \brief The method that tries to get data from the cache.
   
@@ -210,16 +266,54 @@ private:
   
   typedef boost::uint32_t CacheKey;
 
+  //! element of the cache, with a flag for the CLOCK algorithm
+  /*! The flag is atomic such that a cache hit only needs to read the map,
+      while the eviction can reset the flag.
+  */
+  struct CachedProjMatrixElemsForOneBin
+  {
+    explicit CachedProjMatrixElemsForOneBin(const ProjMatrixElemsForOneBin& elems_v)
+      : elems(elems_v), recently_used(true)
+    {}
+    CachedProjMatrixElemsForOneBin(const CachedProjMatrixElemsForOneBin& other)
+      : elems(other.elems), recently_used(other.recently_used.load(std::memory_order_relaxed))
+    {}
+    ProjMatrixElemsForOneBin elems;
+    mutable std::atomic<bool> recently_used;
+  };
+
 	//  typedef std::map<CacheKey, ProjMatrixElemsForOneBin>   MapProjMatrixElemsForOneBin;
-  typedef boost::unordered_map<CacheKey, ProjMatrixElemsForOneBin>   MapProjMatrixElemsForOneBin;
+  typedef boost::unordered_map<CacheKey, CachedProjMatrixElemsForOneBin>   MapProjMatrixElemsForOneBin;
   typedef MapProjMatrixElemsForOneBin::iterator MapProjMatrixElemsForOneBinIterator;
   typedef MapProjMatrixElemsForOneBin::const_iterator const_MapProjMatrixElemsForOneBinIterator;
+
+  //! number of cache hits and misses, counted per thread
+  /*! Padded to avoid false sharing between threads. */
+  struct CacheCounters
+  {
+    CacheCounters() : num_hits(0), num_misses(0) {}
+    CacheCounters(const CacheCounters& other)
+      : num_hits(other.num_hits.load()), num_misses(other.num_misses.load())
+    {}
+    std::atomic<unsigned long> num_hits;
+    std::atomic<unsigned long> num_misses;
+    char padding[64];
+  };
  
   //! collection of  ProjMatrixElemsForOneBin (internal cache )   
 #ifndef STIR_NO_MUTABLE
   mutable
 #endif
     VectorWithOffset<VectorWithOffset<MapProjMatrixElemsForOneBin> > cache_collection;
+  //! hit and miss counters, one for every thread
+  /*! These are summed by get_cache_statistics(). They are atomic only
+      such that nested or excess threads (which share counters) are
+      counted correctly.
+  */
+#ifndef STIR_NO_MUTABLE
+  mutable
+#endif
+    std::vector<CacheCounters> cache_counters;
 #ifdef STIR_OPENMP
 #ifndef STIR_NO_MUTABLE
   mutable
@@ -227,10 +321,35 @@ private:
   VectorWithOffset<VectorWithOffset<omp_lock_t> > cache_locks;
 #endif
 
+  //! (approximate) number of bytes currently used by the cache
+#ifndef STIR_NO_MUTABLE
+  mutable
+#endif
+    std::atomic<std::size_t> cache_memory_used_in_bytes;
+  //! number of elements removed because of the memory limit
+#ifndef STIR_NO_MUTABLE
+  mutable
+#endif
+    std::atomic<unsigned long> cache_num_evictions;
+  //! view and segment number where the next eviction sweep starts
+#ifndef STIR_NO_MUTABLE
+  mutable
+#endif
+    int clock_hand_view_num, clock_hand_segment_num;
+
   //! create the key for caching
   // KT 15/05/2002 not static anymore as it uses cache_stores_only_basic_bins
   CacheKey cache_key(const Bin& bin) const;
 
+  //! (approximate) number of bytes used by a cache element
+  static std::size_t cache_element_size_in_bytes(const ProjMatrixElemsForOneBin&);
+
+  //! remove elements from the cache until its memory usage is below 90% of the limit
+  void evict_from_cache() STIR_MUTABLE_CONST;
+
+  //! get the hit and miss counters for the current thread
+  CacheCounters& get_cache_counters_for_this_thread() const;
+
    
 };
 
@@ -2,6 +2,7 @@
 //
 /*
     Copyright (C) 2004- 2008, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -34,8 +35,12 @@
 #include "stir/CartesianCoordinate3D.h"
 #include "stir/IndexRange.h"
 #include "stir/shared_ptr.h"
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
 #include <iostream>
 
+namespace boost { namespace interprocess { class mapped_region; } }
+
  
 
 START_NAMESPACE_STIR
@@ -46,10 +51,24 @@ class Bin;
   \ingroup projection
   \brief Reads/writes a projection matrix from/to file
 
-  The only supported file format consists of an Interfile-type header
+  The file format consists of an Interfile-type header
   and a binary file which stores the 'basic' elements in a sparse form, 
   i.e. only the elements that cannot by constructed via symmetries.
 
+  Two versions of the binary file are supported:
+  - Version 1.0 stores every row as its bin coordinates, the number of elements and
+    the elements, without any index. The whole file is read (and stored in the cache)
+    by set_up().
+  - Version 2.0 starts with a small header, followed by the elements of all rows
+    (each element taking 12 bytes: 3 16-bit coordinates, 2 bytes padding and a float),
+    and ends with an index giving for every bin the offset of its elements in the file.
+    The file is memory-mapped by set_up() (which only reads the index), and rows are
+    extracted from the mapped file when they are needed. This version therefore
+    starts up much faster, and can be used with the <tt>cache memory limit in MB</tt>
+    keyword.
+
+  All binary data is in native byte order.
+
   \todo this class currently only works with VoxelsOnCartesianGrid. 
   To fix this, we would need a DiscretisedDensityInfo class, and be able
   to have constructed the appropriate symmetries object by parsing the
@@ -58,7 +77,8 @@ class Bin;
   \par Example .par file
   \verbatim
     ProjMatrixByBinFromFile Parameters:=
-      Version := 1.0
+      ; 1.0 or 2.0
+      Version := 2.0
       symmetries type := PET_CartesianGrid
         PET_CartesianGrid symmetries parameters:=
 	  do_symmetry_90degrees_min_phi:= <bool>
@@ -92,12 +112,15 @@ public :
   /*! Currently this will write an interfile-type header, a file with the binary data,
       a template image and template sinogram. You will need all 4 to be able to read the
       matrix back in.
+
+      \param version has to be "1.0" or "2.0" (see the class documentation)
   */
 static Succeeded
   write_to_file(const std::string& output_filename_prefix, 
 		const ProjMatrixByBin& proj_matrix,
 		const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
-		const DiscretisedDensity<3,float>& template_density);
+		const DiscretisedDensity<3,float>& template_density,
+		const std::string& version = "2.0");
  
   //! Default constructor (calls set_defaults())
   ProjMatrixByBinFromFile();
@@ -132,6 +155,20 @@ private:
 
   shared_ptr<const ProjDataInfo> proj_data_info_ptr;
 
+  //! memory-mapped data file (only used for version 2.0)
+  shared_ptr<boost::interprocess::mapped_region> mapped_region_sptr;
+  //! location of the elements of one bin in the mapped file
+  struct IndexEntry
+  {
+    boost::uint64_t offset;
+    boost::uint32_t num_elements;
+  };
+  typedef boost::unordered_map<boost::uint64_t, IndexEntry> Index;
+  //! index of the data file (only used for version 2.0)
+  Index index;
+  //! construct key for the index from the bin coordinates
+  static boost::uint64_t make_index_key(const Bin&);
+
 
   virtual void 
     calculate_proj_matrix_elems_for_one_bin(
@@ -142,6 +179,8 @@ private:
   virtual bool post_processing();
 
   Succeeded read_data();
+  //! map the (version 2.0) data file into memory and read its index
+  Succeeded map_data();
     
 };
 
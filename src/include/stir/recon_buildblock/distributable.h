@@ -2,6 +2,7 @@
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000 - 2011, Hammersmith Imanet Ltd
     Copyright (C) 2013, University College London
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -31,8 +32,10 @@
   \author Matthew Jacobson
   \author Tobias Beisel
   \author PARAPET project
+  \author STIR developers
 */
 #include "stir/shared_ptr.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -83,6 +86,16 @@ void setup_distributable_computation(
 */
 void end_distributable_computation();
 
+//! get the time (in seconds) every thread was busy and idle in the last call to distributable_computation()
+/*! \ingroup distributable
+    Idle time is the time that a thread spent waiting for the others at the end of the loop
+    (or, with OpenMP, in the scheduler). This is useful to see how well the load is balanced.
+
+    Not filled in if STIR_MPI is defined.
+*/
+void get_distributable_computation_thread_times(std::vector<double>& busy_times,
+                                                std::vector<double>& idle_times);
+
 //! typedef for callback functions for distributable_computation()
 /*! \ingroup distributable
     Pointers will be NULL when they are not to be used by the callback function.
@@ -119,6 +132,15 @@ typedef  void RPC_process_related_viewgrams_type (
 
   Symmetries are determined by using the 3rd argument to set_projectors_and_symmetries().
 
+  \par Scheduling
+
+  The (basic) view/segments are processed in order of decreasing estimated cost, see
+  DistributableCostModel. The time taken by every view/segment is measured and used for
+  the estimate in the next call (until setup_distributable_computation() is called again).
+  With OpenMP, dynamic scheduling is used, such that a thread that finishes takes the next
+  (cheaper) view/segment. Time spent per thread can be found with
+  get_distributable_computation_thread_times() (and is written with info() at verbosity 2).
+
   \par Usage
 
   You first need to call setup_distributable_computation(), then you can do multiple calls
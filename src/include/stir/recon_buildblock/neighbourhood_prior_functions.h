@@ -0,0 +1,97 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_recon_buildblock_neighbourhood_prior_functions_H__
+#define __stir_recon_buildblock_neighbourhood_prior_functions_H__
+
+/*!
+  \file
+  \ingroup priors
+  \brief Functions to compute the value and gradient of priors that are
+  a weighted sum over a neighbourhood of a potential function
+
+  \author STIR developers
+*/
+
+#include "stir/DiscretisedDensity.h"
+#include "stir/Array.h"
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup priors
+  \brief compute the value of a prior of the form
+  \f$ \sum_{r,dr} w_{dr} \phi(\lambda_r, \lambda_{r+dr}) \kappa_r \kappa_{r+dr} \f$
+
+  The \a potential object has to have a member function
+  \code
+  elemT value(const float weight, const elemT lambda_r, const elemT lambda_r_plus_dr) const;
+  \endcode
+  which returns \f$ w_{dr} \phi(\lambda_r, \lambda_{r+dr}) \f$.
+
+  \a kappa_ptr can be 0, in which case \f$\kappa\f$ is set to 1. The neighbourhood
+  is given by the \a weights, with indices centred around 0.
+
+  This function loops over the neighbourhood outside the loop over x, such that
+  the inner loop runs over contiguous memory without any checks on the
+  boundary of the image. When using OpenMP, the image planes are divided over the threads.
+  The sum for every plane is accumulated separately, and the results are added
+  afterwards (in the order of the planes), such that the result does not depend
+  on the number of threads.
+
+  Only images with a regular range are supported (calls error() otherwise).
+*/
+template <typename elemT, typename PotentialT>
+inline double
+compute_neighbourhood_prior_value(const DiscretisedDensity<3,elemT>& image,
+                                  const Array<3,float>& weights,
+                                  const DiscretisedDensity<3,elemT> * const kappa_ptr,
+                                  const PotentialT& potential);
+
+/*!
+  \ingroup priors
+  \brief compute the gradient of a prior of the form
+  \f$ \sum_{r,dr} w_{dr} \phi(\lambda_r, \lambda_{r+dr}) \kappa_r \kappa_{r+dr} \f$
+  (or actually, a sum over the neighbourhood of a derivative-like function)
+
+  The \a potential object has to have a member function
+  \code
+  elemT derivative(const float weight, const elemT lambda_r, const elemT lambda_r_plus_dr) const;
+  \endcode
+  The gradient is then computed as
+  \f$ g_r = \mathrm{scale} \sum_{dr} \mathrm{derivative}(w_{dr}, \lambda_r, \lambda_{r+dr}) \kappa_r \kappa_{r+dr} \f$.
+
+  For every voxel, the contributions are added in the same order as when looping over
+  the neighbourhood (z, y and then x offsets) for every voxel.
+
+  \see compute_neighbourhood_prior_value() for more information.
+*/
+template <typename elemT, typename PotentialT>
+inline void
+compute_neighbourhood_prior_gradient(DiscretisedDensity<3,elemT>& gradient,
+                                     const DiscretisedDensity<3,elemT>& image,
+                                     const Array<3,float>& weights,
+                                     const DiscretisedDensity<3,elemT> * const kappa_ptr,
+                                     const PotentialT& potential,
+                                     const elemT scale);
+
+END_NAMESPACE_STIR
+
+#include "stir/recon_buildblock/neighbourhood_prior_functions.inl"
+
+#endif
@@ -0,0 +1,200 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup priors
+  \brief Implementation of functions in neighbourhood_prior_functions.h
+
+  \author STIR developers
+*/
+
+#include "stir/BasicCoordinate.h"
+#include "stir/error.h"
+#include <algorithm>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+  //! find the regular range of the image, and check the kappa image
+  template <typename elemT>
+  inline void
+  get_neighbourhood_prior_range(BasicCoordinate<3,int>& min_indices,
+                                BasicCoordinate<3,int>& max_indices,
+                                const DiscretisedDensity<3,elemT>& image,
+                                const DiscretisedDensity<3,elemT> * const kappa_ptr)
+  {
+    if (!image.get_regular_range(min_indices, max_indices))
+      error("Neighbourhood priors currently only support images with a regular range");
+    if (kappa_ptr != 0 && kappa_ptr->get_index_range() != image.get_index_range())
+      error("Neighbourhood priors: kappa image has not the same index range as the image");
+  }
+}
+
+template <typename elemT, typename PotentialT>
+double
+compute_neighbourhood_prior_value(const DiscretisedDensity<3,elemT>& image,
+                                  const Array<3,float>& weights,
+                                  const DiscretisedDensity<3,elemT> * const kappa_ptr,
+                                  const PotentialT& potential)
+{
+  BasicCoordinate<3,int> min_indices, max_indices;
+  detail::get_neighbourhood_prior_range(min_indices, max_indices, image, kappa_ptr);
+  const int min_z = min_indices[1];
+  const int max_z = max_indices[1];
+  const int min_y = min_indices[2];
+  const int max_y = max_indices[2];
+  const int min_x = min_indices[3];
+  const int num_x = max_indices[3] - min_x + 1;
+
+  std::vector<double> plane_values(max_z - min_z + 1, 0.);
+
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_dz = std::max(weights.get_min_index(), min_z-z);
+      const int max_dz = std::min(weights.get_max_index(), max_z-z);
+      double plane_value = 0.;
+
+      for (int y=min_y; y<=max_y; y++)
+        {
+          const int min_dy = std::max(weights[0].get_min_index(), min_y-y);
+          const int max_dy = std::min(weights[0].get_max_index(), max_y-y);
+
+          const elemT * const image_row = &image[z][y][min_x];
+          const elemT * const kappa_row = kappa_ptr == 0 ? 0 : &(*kappa_ptr)[z][y][min_x];
+
+          for (int dz=min_dz; dz<=max_dz; ++dz)
+            for (int dy=min_dy; dy<=max_dy; ++dy)
+              {
+                const elemT * const neighbour_row = &image[z+dz][y+dy][min_x];
+                const Array<1,float>& weights_row = weights[dz][dy];
+                for (int dx=weights_row.get_min_index(); dx<=weights_row.get_max_index(); ++dx)
+                  {
+                    const float weight = weights_row[dx];
+                    // range of (relative) x such that x+dx is in the image
+                    const int first_x = std::max(0, -dx);
+                    const int end_x = std::min(num_x, num_x - dx);
+                    if (kappa_row == 0)
+                      {
+                        for (int x=first_x; x<end_x; ++x)
+                          plane_value +=
+                            static_cast<double>(potential.value(weight, image_row[x], neighbour_row[x+dx]));
+                      }
+                    else
+                      {
+                        const elemT * const kappa_neighbour_row = &(*kappa_ptr)[z+dz][y+dy][min_x];
+                        for (int x=first_x; x<end_x; ++x)
+                          {
+                            elemT current = potential.value(weight, image_row[x], neighbour_row[x+dx]);
+                            current *= kappa_row[x] * kappa_neighbour_row[x+dx];
+                            plane_value += static_cast<double>(current);
+                          }
+                      }
+                  }
+              }
+        }
+      plane_values[z-min_z] = plane_value;
+    }
+
+  double result = 0.;
+  for (std::vector<double>::const_iterator iter = plane_values.begin(); iter != plane_values.end(); ++iter)
+    result += *iter;
+  return result;
+}
+
+template <typename elemT, typename PotentialT>
+void
+compute_neighbourhood_prior_gradient(DiscretisedDensity<3,elemT>& gradient,
+                                     const DiscretisedDensity<3,elemT>& image,
+                                     const Array<3,float>& weights,
+                                     const DiscretisedDensity<3,elemT> * const kappa_ptr,
+                                     const PotentialT& potential,
+                                     const elemT scale)
+{
+  BasicCoordinate<3,int> min_indices, max_indices;
+  detail::get_neighbourhood_prior_range(min_indices, max_indices, image, kappa_ptr);
+  if (gradient.get_index_range() != image.get_index_range())
+    error("Neighbourhood priors: gradient image has not the same index range as the image");
+  const int min_z = min_indices[1];
+  const int max_z = max_indices[1];
+  const int min_y = min_indices[2];
+  const int max_y = max_indices[2];
+  const int min_x = min_indices[3];
+  const int num_x = max_indices[3] - min_x + 1;
+
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_dz = std::max(weights.get_min_index(), min_z-z);
+      const int max_dz = std::min(weights.get_max_index(), max_z-z);
+      // sum over the neighbourhood for every voxel in the row
+      std::vector<elemT> gradient_row(num_x);
+
+      for (int y=min_y; y<=max_y; y++)
+        {
+          const int min_dy = std::max(weights[0].get_min_index(), min_y-y);
+          const int max_dy = std::min(weights[0].get_max_index(), max_y-y);
+
+          const elemT * const image_row = &image[z][y][min_x];
+          const elemT * const kappa_row = kappa_ptr == 0 ? 0 : &(*kappa_ptr)[z][y][min_x];
+          std::fill(gradient_row.begin(), gradient_row.end(), elemT(0));
+          elemT * const gradient_row_ptr = &gradient_row[0];
+
+          for (int dz=min_dz; dz<=max_dz; ++dz)
+            for (int dy=min_dy; dy<=max_dy; ++dy)
+              {
+                const elemT * const neighbour_row = &image[z+dz][y+dy][min_x];
+                const Array<1,float>& weights_row = weights[dz][dy];
+                for (int dx=weights_row.get_min_index(); dx<=weights_row.get_max_index(); ++dx)
+                  {
+                    const float weight = weights_row[dx];
+                    const int first_x = std::max(0, -dx);
+                    const int end_x = std::min(num_x, num_x - dx);
+                    if (kappa_row == 0)
+                      {
+                        for (int x=first_x; x<end_x; ++x)
+                          gradient_row_ptr[x] += potential.derivative(weight, image_row[x], neighbour_row[x+dx]);
+                      }
+                    else
+                      {
+                        const elemT * const kappa_neighbour_row = &(*kappa_ptr)[z+dz][y+dy][min_x];
+                        for (int x=first_x; x<end_x; ++x)
+                          {
+                            elemT current = potential.derivative(weight, image_row[x], neighbour_row[x+dx]);
+                            current *= kappa_row[x] * kappa_neighbour_row[x+dx];
+                            gradient_row_ptr[x] += current;
+                          }
+                      }
+                  }
+              }
+
+          Array<1,elemT>& gradient_image_row = gradient[z][y];
+          for (int x=0; x<num_x; ++x)
+            gradient_image_row[min_x + x] = gradient_row_ptr[x] * scale;
+        }
+    }
+}
+
+END_NAMESPACE_STIR
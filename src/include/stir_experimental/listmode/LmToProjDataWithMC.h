@@ -51,6 +51,9 @@ protected:
 
   virtual void start_new_time_frame(const unsigned int new_frame_num);
 
+  //! motion correction relies on the events being processed in order, so returns \c false
+  virtual bool can_use_integer_histogramming() const { return false; }
+
    
   virtual void set_defaults();
   virtual void initialise_keymap();
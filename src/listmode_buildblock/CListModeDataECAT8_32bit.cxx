@@ -50,6 +50,7 @@ CListModeDataECAT8_32bit(const std::string& listmode_filename)
     error(boost::format("Unknown value for originating_system keyword: '%s") % originating_system );
 
   this->set_proj_data_info_sptr(interfile_parser.data_info_ptr->create_shared_clone());
+  this->empty_record_sptr.reset(new CListRecordT(this->get_proj_data_info_sptr()));
 
   if (this->open_lm_file() == Succeeded::no)
     error("CListModeDataECAT8_32bit: error opening the first listmode file for filename %s\n",
@@ -68,7 +69,7 @@ shared_ptr <CListRecord>
 CListModeDataECAT8_32bit::
 get_empty_record_sptr() const
 {
-  shared_ptr<CListRecord> sptr(new CListRecordT(this->get_proj_data_info_sptr()));
+  shared_ptr<CListRecord> sptr(new CListRecordT(*this->empty_record_sptr));
   return sptr;
 }
 
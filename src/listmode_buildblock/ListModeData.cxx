@@ -77,4 +77,22 @@ get_scan_start_time_in_secs_since_1970() const
 }
 #endif
 
+std::size_t
+ListModeData::
+get_next_records(std::vector<shared_ptr<ListRecord> >& records,
+                 const std::size_t default_batch_size) const
+{
+  if (records.empty())
+    {
+      records.resize(default_batch_size);
+      for (std::size_t i=0; i<records.size(); ++i)
+        records[i] = this->get_empty_record_sptr();
+    }
+  std::size_t num_records_read = 0;
+  while (num_records_read < records.size() &&
+         this->get_next_record(*records[num_records_read]) == Succeeded::yes)
+    ++num_records_read;
+  return num_records_read;
+}
+
 END_NAMESPACE_STIR
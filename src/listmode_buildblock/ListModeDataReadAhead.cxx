@@ -0,0 +1,241 @@
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup listmode
+  \brief Implementation of class stir::ListModeDataReadAhead
+
+  \author STIR developers
+*/
+
+#include "stir/listmode/ListModeDataReadAhead.h"
+#include "stir/is_null_ptr.h"
+#include "stir/error.h"
+#include <algorithm>
+
+START_NAMESPACE_STIR
+
+ListModeDataReadAhead::
+ListModeDataReadAhead(const shared_ptr<ListModeData>& lm_data_sptr_v,
+                      const std::size_t batch_size_v,
+                      const std::size_t max_num_batches_v)
+  : lm_data_sptr(lm_data_sptr_v),
+    batch_size(batch_size_v),
+    max_num_batches(max_num_batches_v),
+    reading(false),
+    stop_requested(false),
+    start_is_beginning(false),
+    num_records_consumed(0),
+    num_records_read(0)
+{
+  if (is_null_ptr(lm_data_sptr))
+    error("ListModeDataReadAhead: list mode data not set");
+  if (batch_size == 0 || max_num_batches == 0)
+    error("ListModeDataReadAhead: batch size and number of batches should be at least 1");
+  this->start_position = this->lm_data_sptr->save_get_position();
+  this->start_reading();
+}
+
+ListModeDataReadAhead::
+~ListModeDataReadAhead()
+{
+  this->stop_reading();
+}
+
+void
+ListModeDataReadAhead::
+start_reading()
+{
+  this->num_records_consumed = 0;
+  this->num_records_read = 0;
+  this->reading = true;
+  this->reading_thread = std::thread(&ListModeDataReadAhead::read_batches, this);
+}
+
+void
+ListModeDataReadAhead::
+stop_reading()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop_requested = true;
+  }
+  this->batch_consumed.notify_all();
+  if (this->reading_thread.joinable())
+    this->reading_thread.join();
+
+  // keep the records for reuse
+  for (std::deque<Batch>::iterator iter = this->filled_batches.begin();
+       iter != this->filled_batches.end();
+       ++iter)
+    {
+      this->free_batches.push_back(RecordBatch());
+      this->free_batches.back().swap(iter->records);
+    }
+  this->filled_batches.clear();
+  this->stop_requested = false;
+  this->reading = false;
+  this->exception_ptr = std::exception_ptr();
+}
+
+void
+ListModeDataReadAhead::
+read_batches()
+{
+  while (true)
+    {
+      Batch batch;
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (!this->stop_requested && this->filled_batches.size() >= this->max_num_batches)
+          this->batch_consumed.wait(lock);
+        if (this->stop_requested)
+          {
+            this->reading = false;
+            return;
+          }
+        if (!this->free_batches.empty())
+          {
+            batch.records.swap(this->free_batches.back());
+            this->free_batches.pop_back();
+          }
+      }
+
+      try
+        {
+          batch.records.resize(this->batch_size);
+          for (RecordBatch::iterator iter = batch.records.begin(); iter != batch.records.end(); ++iter)
+            if (is_null_ptr(*iter))
+              *iter = this->lm_data_sptr->get_empty_record_sptr();
+          batch.num_records = this->lm_data_sptr->get_next_records(batch.records);
+        }
+      catch (...)
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->exception_ptr = std::current_exception();
+          this->reading = false;
+          this->batch_added.notify_all();
+          return;
+        }
+
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const bool end_of_data = batch.num_records < this->batch_size;
+        this->filled_batches.push_back(Batch());
+        this->filled_batches.back().records.swap(batch.records);
+        this->filled_batches.back().num_records = batch.num_records;
+        this->num_records_read += batch.num_records;
+        if (end_of_data)
+          this->reading = false;
+        this->batch_added.notify_all();
+        if (end_of_data)
+          return;
+      }
+    }
+}
+
+std::size_t
+ListModeDataReadAhead::
+get_next_records(RecordBatch& records)
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (this->filled_batches.empty() && this->reading)
+    this->batch_added.wait(lock);
+  if (this->exception_ptr)
+    {
+      // rethrow exception from the reading thread
+      const std::exception_ptr e = this->exception_ptr;
+      this->exception_ptr = std::exception_ptr();
+      std::rethrow_exception(e);
+    }
+  if (this->filled_batches.empty())
+    return 0;
+
+  Batch& batch = this->filled_batches.front();
+  records.swap(batch.records);
+  const std::size_t num_records = batch.num_records;
+  // give the previous records of the caller to the reading thread
+  this->free_batches.push_back(RecordBatch());
+  this->free_batches.back().swap(batch.records);
+  this->filled_batches.pop_front();
+  this->num_records_consumed += num_records;
+  lock.unlock();
+  this->batch_consumed.notify_all();
+  return num_records;
+}
+
+ListModeData::SavedPosition
+ListModeDataReadAhead::
+save_get_position()
+{
+  this->stop_reading();
+  // the reading thread has stopped, so we can access the list mode data
+  if (this->num_records_read != this->num_records_consumed)
+    {
+      // go back to where the consumer is
+      const Succeeded success =
+        this->start_is_beginning
+        ? this->lm_data_sptr->reset()
+        : this->lm_data_sptr->set_get_position(this->start_position);
+      if (success != Succeeded::yes)
+        error("ListModeDataReadAhead::save_get_position: could not go back to the start position");
+      RecordBatch records;
+      std::size_t num_records_to_skip = this->num_records_consumed;
+      while (num_records_to_skip > 0)
+        {
+          records.resize(std::min(num_records_to_skip, this->batch_size));
+          for (RecordBatch::iterator iter = records.begin(); iter != records.end(); ++iter)
+            if (is_null_ptr(*iter))
+              *iter = this->lm_data_sptr->get_empty_record_sptr();
+          const std::size_t num_records = this->lm_data_sptr->get_next_records(records, records.size());
+          if (num_records == 0)
+            error("ListModeDataReadAhead::save_get_position: fewer records than before");
+          num_records_to_skip -= num_records;
+        }
+    }
+  const ListModeData::SavedPosition pos = this->lm_data_sptr->save_get_position();
+  // continue reading from here
+  this->start_is_beginning = false;
+  this->start_position = pos;
+  this->start_reading();
+  return pos;
+}
+
+Succeeded
+ListModeDataReadAhead::
+set_get_position(const ListModeData::SavedPosition& pos)
+{
+  this->stop_reading();
+  const Succeeded success = this->lm_data_sptr->set_get_position(pos);
+  this->start_is_beginning = false;
+  this->start_position = pos;
+  this->start_reading();
+  return success;
+}
+
+Succeeded
+ListModeDataReadAhead::
+reset()
+{
+  this->stop_reading();
+  const Succeeded success = this->lm_data_sptr->reset();
+  this->start_is_beginning = true;
+  this->start_reading();
+  return success;
+}
+
+END_NAMESPACE_STIR
@@ -63,6 +63,7 @@ FRAME_BASED_DT_CORR:
 #include "stir/listmode/LmToProjData.h"
 #include "stir/listmode/ListRecord.h"
 #include "stir/listmode/ListModeData.h"
+#include "stir/listmode/CListEventCylindricalScannerWithDiscreteDetectors.h"
 #include "stir/ExamInfo.h"
 #include "stir/ProjDataInfoCylindricalNoArcCorr.h"
 
@@ -82,6 +83,7 @@ FRAME_BASED_DT_CORR:
 #include "stir/CPUTimer.h"
 #include "stir/recon_buildblock/TrivialBinNormalisation.h"
 #include "stir/is_null_ptr.h"
+#include "stir/info.h"
 
 #include <fstream>
 #include <iostream>
@@ -140,6 +142,28 @@ construct_proj_data(shared_ptr<iostream>& output,
 		    const ExamInfo& exam_info,
                     const shared_ptr<const ProjDataInfo>& proj_data_info_ptr);
 
+static
+shared_ptr<ProjData>
+construct_proj_data_for_frame(shared_ptr<iostream>& output,
+                              const string& output_filename_prefix,
+                              const unsigned int frame_num,
+                              const ExamInfo& lm_exam_info,
+                              const TimeFrameDefinitions& frame_defs,
+                              const ExamInfo& template_exam_info,
+                              const shared_ptr<const ProjDataInfo>& proj_data_info_ptr);
+
+static bool
+is_event_accepted(const Bin& bin, const ListRecord& record,
+                  const ProjDataInfo& proj_data_info,
+                  const ExamInfo& template_exam_info);
+
+static void
+save_counts(const std::vector<boost::int32_t>& counts,
+            const VectorWithOffset<std::size_t>& segment_offsets,
+            const int start_segment_index,
+            const int end_segment_index,
+            ProjData& proj_data);
+
 /**************************************************************
  The 3 parsing functions
 ***************************************************************/
@@ -152,6 +176,7 @@ set_defaults()
   store_delayeds = true;
   interactive=false;
   num_segments_in_memory = -1;
+  use_integer_histogramming = true;
   normalisation_ptr.reset(new TrivialBinNormalisation);
   post_normalisation_ptr.reset(new TrivialBinNormalisation);
   do_pre_normalisation =0;
@@ -174,6 +199,7 @@ initialise_keymap()
   parser.add_key("maximum absolute segment number to process", &max_segment_num_to_process); 
   parser.add_key("do pre normalisation ", &do_pre_normalisation);
   parser.add_key("num_segments_in_memory", &num_segments_in_memory);
+  parser.add_key("use integer histogramming", &use_integer_histogramming);
 
   //if (lm_data_ptr->has_delayeds()) TODO we haven't read the ListModeData yet, so cannot access has_delayeds() yet
   // one could add the next 2 keywords as part of a callback function for the 'input file' keyword.
@@ -496,6 +522,24 @@ get_compression_count(const Bin& bin) const
 
 }
 
+bool
+LmToProjData::
+can_use_integer_histogramming() const
+{
+  if (interactive || !do_time_frame || do_pre_normalisation || !post_normalisation_ptr->is_trivial())
+    return false;
+  // get_bin_from_event() will be called from multiple threads. This is only known to be safe
+  // for events that find their bin via the detection positions, as the lookup tables
+  // of ProjDataInfoCylindricalNoArcCorr are initialised in a thread-safe way.
+  if (dynamic_cast<const CListEventCylindricalScannerWithDiscreteDetectors *>
+      (&lm_data_ptr->get_empty_record_sptr()->event()) == 0)
+    {
+      info("LmToProjData: not using integer histogramming as this type of list mode data is not known to be thread-safe");
+      return false;
+    }
+  return true;
+}
+
 /**************************************************************
  Empty functions for new time events and new time frames.
 ***************************************************************/
@@ -520,6 +564,12 @@ void
 LmToProjData::
 process_data()
 { 
+  if (use_integer_histogramming && can_use_integer_histogramming())
+    {
+      process_data_with_integer_counts();
+      return;
+    }
+
   CPUTimer timer;
   timer.start();
 
@@ -552,34 +602,13 @@ process_data()
     {
       start_new_time_frame(current_frame_num);
 
-      // construct ExamInfo appropriate for a single projdata with this time frame
-      ExamInfo this_frame_exam_info(lm_data_ptr->get_exam_info());
-      {
-        TimeFrameDefinitions this_time_frame_defs(frame_defs, current_frame_num);
-        this_frame_exam_info.set_time_frame_definitions(this_time_frame_defs);
-      }
-
       // *********** open output file
       shared_ptr<iostream> output;
-      shared_ptr<ProjData> proj_data_sptr;
-
-      {
-        char rest[50];
-        sprintf(rest, "_f%dg1d0b0", current_frame_num);
-        const string output_filename = output_filename_prefix + rest;
-        this_frame_exam_info.set_num_energy_windows(template_proj_data_ptr->get_exam_info_sptr()->get_num_energy_windows());
-        std::vector<int> energy_window_pair(2);
-        energy_window_pair.at(0) = template_proj_data_ptr->get_exam_info_sptr()->get_energy_window_pair().first;
-        energy_window_pair.at(1) = template_proj_data_ptr->get_exam_info_sptr()->get_energy_window_pair().second;
-        this_frame_exam_info.set_energy_window_pair(energy_window_pair);
-        for (int i = 0; i < template_proj_data_ptr->get_exam_info_sptr()->get_num_energy_windows(); ++i )
-        {
-            this_frame_exam_info.set_high_energy_thres(template_proj_data_ptr->get_exam_info_sptr()->get_low_energy_thres(i),i);
-            this_frame_exam_info.set_low_energy_thres(template_proj_data_ptr->get_exam_info_sptr()->get_high_energy_thres(i),i);
-         }
-        proj_data_sptr =
-          construct_proj_data(output, output_filename, this_frame_exam_info, template_proj_data_info_ptr);
-      }
+      shared_ptr<ProjData> proj_data_sptr =
+        construct_proj_data_for_frame(output, output_filename_prefix, current_frame_num,
+                                      lm_data_ptr->get_exam_info(), frame_defs,
+                                      *template_proj_data_ptr->get_exam_info_sptr(),
+                                      template_proj_data_info_ptr);
 
       long num_prompts_in_frame = 0;
       long num_delayeds_in_frame = 0;
@@ -667,19 +696,9 @@ process_data()
                      get_bin_from_event(bin, record.event(), template_proj_data_ptr->get_exam_info_sptr()->get_energy_window_pair());
 		     		       
 		     // check if it's inside the range we want to store
-		     if (bin.get_bin_value()>0
-			 && bin.tangential_pos_num()>= proj_data_sptr->get_min_tangential_pos_num()
-			 && bin.tangential_pos_num()<= proj_data_sptr->get_max_tangential_pos_num()
-			 && bin.axial_pos_num()>=proj_data_sptr->get_min_axial_pos_num(bin.segment_num())
-             && bin.axial_pos_num()<=proj_data_sptr->get_max_axial_pos_num(bin.segment_num())
-             && record.energy().get_energyA_in_keV() >= template_proj_data_ptr->get_exam_info_sptr()->get_low_energy_thres(bin.first_energy_window_num()-1)
-             && record.energy().get_energyA_in_keV() <= template_proj_data_ptr->get_exam_info_sptr()->get_high_energy_thres(bin.first_energy_window_num()-1)
-             && record.energy().get_energyB_in_keV() >= template_proj_data_ptr->get_exam_info_sptr()->get_low_energy_thres(bin.second_energy_window_num()-1)
-             && record.energy().get_energyB_in_keV() <= template_proj_data_ptr->get_exam_info_sptr()->get_high_energy_thres(bin.second_energy_window_num()-1))
+		     if (is_event_accepted(bin, record, *proj_data_sptr->get_proj_data_info_sptr(),
+					   *template_proj_data_ptr->get_exam_info_sptr()))
 		       {
-
-             std::cout<< "energy A new: " << record.energy().get_energyA_in_keV()<< '\n';
-             std::cout<< "energy B new: " << record.energy().get_energyB_in_keV() << '\n';
 			 assert(bin.view_num()>=proj_data_sptr->get_min_view_num());
 			 assert(bin.view_num()<=proj_data_sptr->get_max_view_num());
             
@@ -756,6 +775,259 @@ process_data()
 
 
 
+/**************************************************************
+ Single-pass binning into integer counts.
+
+ The events are read in batches. For every batch, we first find (serially)
+ the records that belong to the current frame, and then compute the bins
+ of these events in parallel. Events in the first group of segments are
+ added directly to the counts (which are in memory), while for events in
+ the other groups the index of their bin is written to a temporary file
+ (one per group). These files are binned when the frame is finished.
+***************************************************************/
+void
+LmToProjData::
+process_data_with_integer_counts()
+{
+  CPUTimer timer;
+  timer.start();
+
+  // assume list mode data starts at time 0 (see process_data())
+  current_time = 0;
+  shared_ptr<ProjData> template_proj_data_ptr =
+    ProjData::read_from_file(template_proj_data_name);
+  const ExamInfo& template_exam_info = *template_proj_data_ptr->get_exam_info_sptr();
+  const std::pair<int,int> energy_window_pair = template_exam_info.get_energy_window_pair();
+  const ProjDataInfo& proj_data_info = *template_proj_data_info_ptr;
+
+  if (!lm_data_ptr->get_empty_record_sptr()->event().is_valid_template(proj_data_info))
+    error("The scanner template is not valid for LmToProjData. This might be because of unsupported arc correction.");
+
+  // find the offset of every segment in the counts of its group of segments
+  const int min_segment_num = proj_data_info.get_min_segment_num();
+  const int max_segment_num = proj_data_info.get_max_segment_num();
+  const int num_groups =
+    (proj_data_info.get_num_segments() + num_segments_in_memory - 1) / num_segments_in_memory;
+  VectorWithOffset<std::size_t> segment_offsets(min_segment_num, max_segment_num);
+  std::vector<std::size_t> group_sizes(num_groups, 0);
+  for (int seg=min_segment_num; seg<=max_segment_num; ++seg)
+    {
+      const int group = (seg - min_segment_num) / num_segments_in_memory;
+      segment_offsets[seg] = group_sizes[group];
+      group_sizes[group] +=
+        static_cast<std::size_t>(proj_data_info.get_num_views()) *
+        proj_data_info.get_num_axial_poss(seg) *
+        proj_data_info.get_num_tangential_poss();
+    }
+  for (int group=1; group<num_groups; ++group)
+    if (group_sizes[group] >= static_cast<std::size_t>(std::numeric_limits<boost::int32_t>::max()))
+      error("LmToProjData: too many bins in a group of segments for integer histogramming. "
+            "Use a smaller value for num_segments_in_memory");
+
+  // counts for one group of segments (the first group during the pass over the data)
+  std::vector<boost::int32_t> counts(*std::max_element(group_sizes.begin(), group_sizes.end()));
+
+  std::vector<shared_ptr<ListRecord> > records;
+  std::size_t num_records = 0;
+  std::size_t record_index = 0;
+  // encoded bin index (+1, negative for a decrement) and group for events in segments not in memory
+  std::vector<boost::int32_t> spill_codes;
+  std::vector<int> spill_groups;
+
+  double time_of_last_stored_event = 0;
+  long num_stored_events = 0;
+
+  for (current_frame_num = 1;
+       current_frame_num<=frame_defs.get_num_frames();
+       ++current_frame_num)
+    {
+      start_new_time_frame(current_frame_num);
+
+      shared_ptr<iostream> output;
+      shared_ptr<ProjData> proj_data_sptr =
+        construct_proj_data_for_frame(output, output_filename_prefix, current_frame_num,
+                                      lm_data_ptr->get_exam_info(), frame_defs,
+                                      template_exam_info,
+                                      template_proj_data_info_ptr);
+
+      std::fill(counts.begin(), counts.end(), 0);
+      std::vector<shared_ptr<std::FILE> > spill_files(num_groups);
+      for (int group=1; group<num_groups; ++group)
+        {
+          spill_files[group].reset(std::tmpfile(), std::fclose);
+          if (is_null_ptr(spill_files[group]))
+            error("LmToProjData: error opening temporary file for segments that are not in memory");
+        }
+
+      long num_prompts_in_frame = 0;
+      long num_delayeds_in_frame = 0;
+
+      const double start_time = frame_defs.get_start_time(current_frame_num);
+      const double end_time = frame_defs.get_end_time(current_frame_num);
+
+      cerr << "\nProcessing time frame " << current_frame_num << '\n';
+
+      bool end_of_frame = false;
+      while (!end_of_frame)
+        {
+          if (record_index == num_records)
+            {
+              num_records = lm_data_ptr->get_next_records(records);
+              record_index = 0;
+              if (num_records == 0)
+                break; // no more events in file for some reason
+            }
+          // skip events before the start of the frame
+          while (record_index < num_records && current_time < start_time)
+            {
+              const ListRecord& record = *records[record_index++];
+              if (record.is_time())
+                current_time = record.time().get_time_in_secs();
+            }
+          if (current_time < start_time)
+            continue;
+
+          // find the records in this batch that are in the frame
+          const std::size_t begin_index = record_index;
+          std::size_t end_index = begin_index;
+          for (; end_index < num_records; ++end_index)
+            {
+              const ListRecord& record = *records[end_index];
+              if (record.is_time() && end_time > 0.01) // Direct comparison within doubles is unsafe.
+                {
+                  current_time = record.time().get_time_in_secs();
+                  if (current_time >= end_time)
+                    {
+                      end_of_frame = true;
+                      break;
+                    }
+                  process_new_time_event(record.time());
+                }
+            }
+          // the time record that ends the frame has been processed
+          record_index = end_of_frame ? end_index + 1 : end_index;
+
+          spill_codes.resize(num_records);
+          spill_groups.resize(num_records);
+          long num_prompts = 0;
+          long num_delayeds = 0;
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(static) reduction(+:num_prompts,num_delayeds)
+#endif
+          for (long i=static_cast<long>(begin_index); i<static_cast<long>(end_index); ++i)
+            {
+              spill_groups[i] = 0;
+              const ListRecord& record = *records[i];
+              if (!record.is_event())
+                continue;
+              // see if we increment or decrement the value in the sinogram
+              const int event_increment =
+                record.event().is_prompt()
+                ? ( store_prompts ? 1 : 0 ) // it's a prompt
+                :  delayed_increment;//it is a delayed-coincidence event
+              if (event_increment==0)
+                continue;
+
+              Bin bin;
+              // set value in case the event decoder doesn't touch it
+              bin.set_bin_value(1);
+              get_bin_from_event(bin, record.event(), energy_window_pair);
+              // check the range explicitly, as it is used to index the counts
+              // (and is_event_accepted() needs a valid segment)
+              const int seg = bin.segment_num();
+              if (seg < min_segment_num || seg > max_segment_num ||
+                  bin.view_num() < proj_data_info.get_min_view_num() ||
+                  bin.view_num() > proj_data_info.get_max_view_num())
+                continue;
+              if (!is_event_accepted(bin, record, proj_data_info, template_exam_info))
+                continue;
+
+              const std::size_t offset =
+                segment_offsets[seg] +
+                (static_cast<std::size_t>(bin.view_num() - proj_data_info.get_min_view_num()) *
+                 proj_data_info.get_num_axial_poss(seg) +
+                 (bin.axial_pos_num() - proj_data_info.get_min_axial_pos_num(seg))) *
+                proj_data_info.get_num_tangential_poss() +
+                (bin.tangential_pos_num() - proj_data_info.get_min_tangential_pos_num());
+              const int group = (seg - min_segment_num) / num_segments_in_memory;
+              if (group == 0)
+                {
+#ifdef STIR_OPENMP
+#pragma omp atomic
+#endif
+                  counts[offset] += event_increment;
+                }
+              else
+                {
+                  const boost::int32_t code = static_cast<boost::int32_t>(offset) + 1;
+                  spill_codes[i] = event_increment > 0 ? code : -code;
+                  spill_groups[i] = group;
+                }
+              if (record.event().is_prompt())
+                ++num_prompts;
+              else
+                ++num_delayeds;
+            }
+
+          for (std::size_t i=begin_index; i<end_index; ++i)
+            if (spill_groups[i] > 0)
+              if (std::fwrite(&spill_codes[i], sizeof(boost::int32_t), 1, spill_files[spill_groups[i]].get()) != 1)
+                error("LmToProjData: error writing to temporary file");
+
+          num_prompts_in_frame += num_prompts;
+          num_delayeds_in_frame += num_delayeds;
+          num_stored_events += num_prompts + delayed_increment*num_delayeds;
+          cout << "\r" << num_stored_events << " events stored" << flush;
+        } // end of while loop over all events
+
+      time_of_last_stored_event =
+        max(time_of_last_stored_event,current_time);
+
+      // write the segments in memory, and bin the other ones from the temporary files
+      save_counts(counts, segment_offsets,
+                  min_segment_num,
+                  min(max_segment_num, min_segment_num + num_segments_in_memory - 1),
+                  *proj_data_sptr);
+      for (int group=1; group<num_groups; ++group)
+        {
+          std::fill(counts.begin(), counts.end(), 0);
+          std::FILE * const file = spill_files[group].get();
+          std::rewind(file);
+          std::vector<boost::int32_t> codes(65536);
+          std::size_t num_codes;
+          while ((num_codes = std::fread(&codes[0], sizeof(boost::int32_t), codes.size(), file)) > 0)
+            {
+              for (std::size_t i=0; i<num_codes; ++i)
+                {
+                  if (codes[i] > 0)
+                    ++counts[codes[i] - 1];
+                  else
+                    --counts[-codes[i] - 1];
+                }
+            }
+          if (std::ferror(file))
+            error("LmToProjData: error reading from temporary file");
+          spill_files[group].reset();
+          const int start_segment_index = min_segment_num + group*num_segments_in_memory;
+          save_counts(counts, segment_offsets,
+                      start_segment_index,
+                      min(max_segment_num, start_segment_index + num_segments_in_memory - 1),
+                      *proj_data_sptr);
+        }
+      cerr <<  "\nNumber of prompts stored in this time period : " << num_prompts_in_frame
+           <<  "\nNumber of delayeds stored in this time period: " << num_delayeds_in_frame
+           << '\n';
+    } // end of loop over frames
+
+  timer.stop();
+
+  cerr << "Last stored event was recorded before time-tick at " << time_of_last_stored_event << " secs\n";
+  cerr << "Total number of counts (either prompts/trues/delayeds) stored: " << num_stored_events << endl;
+
+  cerr << "\nThis took " << timer.value() << "s CPU time." << endl;
+}
+
+
 /************************* Local helper routines *************************/
 
 
@@ -846,5 +1118,80 @@ construct_proj_data(shared_ptr<iostream>& output,
 #endif
 }
 
+static bool
+is_event_accepted(const Bin& bin, const ListRecord& record,
+                  const ProjDataInfo& proj_data_info,
+                  const ExamInfo& template_exam_info)
+{
+  return
+    bin.get_bin_value()>0
+    && bin.tangential_pos_num()>= proj_data_info.get_min_tangential_pos_num()
+    && bin.tangential_pos_num()<= proj_data_info.get_max_tangential_pos_num()
+    && bin.axial_pos_num()>=proj_data_info.get_min_axial_pos_num(bin.segment_num())
+    && bin.axial_pos_num()<=proj_data_info.get_max_axial_pos_num(bin.segment_num())
+    // only check energies when the template specifies energy windows
+    && (!template_exam_info.has_energy_information() ||
+        (record.energy().get_energyA_in_keV() >= template_exam_info.get_low_energy_thres(bin.first_energy_window_num()-1)
+         && record.energy().get_energyA_in_keV() <= template_exam_info.get_high_energy_thres(bin.first_energy_window_num()-1)
+         && record.energy().get_energyB_in_keV() >= template_exam_info.get_low_energy_thres(bin.second_energy_window_num()-1)
+         && record.energy().get_energyB_in_keV() <= template_exam_info.get_high_energy_thres(bin.second_energy_window_num()-1)));
+}
+
+void
+save_counts(const std::vector<boost::int32_t>& counts,
+            const VectorWithOffset<std::size_t>& segment_offsets,
+            const int start_segment_index,
+            const int end_segment_index,
+            ProjData& proj_data)
+{
+  for (int seg=start_segment_index; seg<=end_segment_index; seg++)
+    {
+      // SegmentByView stores the data in the same order as the counts
+      segment_type segment = proj_data.get_empty_segment_by_view(seg);
+      std::vector<boost::int32_t>::const_iterator counts_iter =
+        counts.begin() + segment_offsets[seg];
+      for (segment_type::full_iterator iter = segment.begin_all();
+           iter != segment.end_all();
+           ++iter, ++counts_iter)
+        *iter = static_cast<elem_type>(*counts_iter);
+      proj_data.set_segment(segment);
+    }
+}
+
+static
+shared_ptr<ProjData>
+construct_proj_data_for_frame(shared_ptr<iostream>& output,
+                              const string& output_filename_prefix,
+                              const unsigned int frame_num,
+                              const ExamInfo& lm_exam_info,
+                              const TimeFrameDefinitions& frame_defs,
+                              const ExamInfo& template_exam_info,
+                              const shared_ptr<const ProjDataInfo>& proj_data_info_ptr)
+{
+  // construct ExamInfo appropriate for a single projdata with this time frame
+  ExamInfo this_frame_exam_info(lm_exam_info);
+  {
+    TimeFrameDefinitions this_time_frame_defs(frame_defs, frame_num);
+    this_frame_exam_info.set_time_frame_definitions(this_time_frame_defs);
+  }
+
+  char rest[50];
+  sprintf(rest, "_f%dg1d0b0", frame_num);
+  const string output_filename = output_filename_prefix + rest;
+  this_frame_exam_info.set_num_energy_windows(template_exam_info.get_num_energy_windows());
+  std::vector<int> energy_window_pair(2);
+  energy_window_pair.at(0) = template_exam_info.get_energy_window_pair().first;
+  energy_window_pair.at(1) = template_exam_info.get_energy_window_pair().second;
+  this_frame_exam_info.set_energy_window_pair(energy_window_pair);
+  for (int i = 0; i < template_exam_info.get_num_energy_windows(); ++i )
+    {
+      this_frame_exam_info.set_high_energy_thres(template_exam_info.get_low_energy_thres(i),i);
+      this_frame_exam_info.set_low_energy_thres(template_exam_info.get_high_energy_thres(i),i);
+    }
+  return
+    construct_proj_data(output, output_filename, this_frame_exam_info, proj_data_info_ptr);
+}
+
+
 
 END_NAMESPACE_STIR
@@ -0,0 +1,375 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup DFT
+  \brief Implementation of class stir::FourierPlan and its backends
+
+  \author STIR developers
+*/
+#include "stir/numerics/FourierPlan.h"
+#include "stir/common.h"
+#include "stir/error.h"
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cmath>
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#endif
+
+START_NAMESPACE_STIR
+
+namespace detail {
+
+/* Mixed-radix decimation-in-time FFT.
+
+   The length n is factored as p1*p2*...*pk (4s first, then 2s, then odd factors).
+   The recursion splits the input into p1 interleaved sequences of length n/p1,
+   transforms those (into consecutive blocks of the output), and then combines
+   them with a radix-p1 butterfly. The twiddle factors exp(sign*2*pi*i*k/n)
+   are computed once, in double precision.
+*/
+class FourierPlanMixedRadix : public FourierPlan
+{
+public:
+  FourierPlanMixedRadix(const int length, const int sign);
+
+protected:
+  virtual void
+    transform_using_buffer(complex_type* data, const int stride, complex_type* work_buffer) const;
+
+private:
+  //! radix and remaining length for every stage, i.e. p1,n/p1,p2,n/(p1*p2),...
+  std::vector<int> factors;
+  std::vector<complex_type> twiddles;
+
+  void work(complex_type* out, const complex_type* in, const int fstride, const int in_stride,
+            const int* cur_factors) const;
+  void butterfly2(complex_type* out, const int fstride, const int m) const;
+  void butterfly3(complex_type* out, const int fstride, const int m) const;
+  void butterfly4(complex_type* out, const int fstride, const int m) const;
+  void butterfly_generic(complex_type* out, const int fstride, const int m, const int p) const;
+
+  //! returns sign*i*x
+  complex_type times_sign_i(const complex_type& x) const
+  {
+    return this->get_sign() > 0 ? complex_type(-x.imag(), x.real()) : complex_type(x.imag(), -x.real());
+  }
+};
+
+FourierPlanMixedRadix::
+FourierPlanMixedRadix(const int length, const int sign)
+  : FourierPlan(length, sign)
+{
+  twiddles.resize(length);
+  for (int k=0; k<length; ++k)
+    {
+      const double phase = sign*2*_PI*k/length;
+      twiddles[k] = complex_type(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+
+  int n = length;
+  int p = 4;
+  while (n > 1)
+    {
+      while (n % p != 0)
+        {
+          switch (p)
+            {
+            case 4: p = 2; break;
+            case 2: p = 3; break;
+            default: p += 2; break;
+            }
+          if (p*p > n)
+            p = n; // n is prime
+        }
+      n /= p;
+      factors.push_back(p);
+      factors.push_back(n);
+    }
+}
+
+void
+FourierPlanMixedRadix::
+transform_using_buffer(complex_type* data, const int stride, complex_type* work_buffer) const
+{
+  const int n = this->get_length();
+  if (n == 1)
+    return;
+  work(work_buffer, data, 1, stride, &factors[0]);
+  for (int i=0; i<n; ++i)
+    data[static_cast<std::ptrdiff_t>(i)*stride] = work_buffer[i];
+}
+
+void
+FourierPlanMixedRadix::
+work(complex_type* out, const complex_type* in, const int fstride, const int in_stride,
+     const int* cur_factors) const
+{
+  const int p = cur_factors[0];
+  const int m = cur_factors[1];
+  const std::ptrdiff_t in_step = static_cast<std::ptrdiff_t>(fstride)*in_stride;
+  if (m == 1)
+    {
+      for (int q=0; q<p; ++q)
+        out[q] = in[q*in_step];
+    }
+  else
+    {
+      // transform every p-th element into consecutive blocks of length m
+      for (int q=0; q<p; ++q)
+        work(out + q*m, in + q*in_step, fstride*p, in_stride, cur_factors+2);
+    }
+
+  switch (p)
+    {
+    case 2: butterfly2(out, fstride, m); break;
+    case 3: butterfly3(out, fstride, m); break;
+    case 4: butterfly4(out, fstride, m); break;
+    default: butterfly_generic(out, fstride, m, p); break;
+    }
+}
+
+void
+FourierPlanMixedRadix::
+butterfly2(complex_type* out, const int fstride, const int m) const
+{
+  complex_type* out1 = out + m;
+  for (int k=0; k<m; ++k)
+    {
+      const complex_type t = out1[k]*twiddles[k*fstride];
+      out1[k] = out[k] - t;
+      out[k] += t;
+    }
+}
+
+void
+FourierPlanMixedRadix::
+butterfly3(complex_type* out, const int fstride, const int m) const
+{
+  // imaginary part of exp(2*pi*i/3) (without sign)
+  const float sin_2pi_3 = static_cast<float>(std::sqrt(3.)/2);
+  for (int k=0; k<m; ++k)
+    {
+      const complex_type a1 = out[k+m]*twiddles[k*fstride];
+      const complex_type a2 = out[k+2*m]*twiddles[2*k*fstride];
+      const complex_type sum = a1 + a2;
+      const complex_type diff = times_sign_i(a1 - a2)*sin_2pi_3;
+      const complex_type t = out[k] - sum*.5F;
+      out[k] += sum;
+      out[k+m] = t + diff;
+      out[k+2*m] = t - diff;
+    }
+}
+
+void
+FourierPlanMixedRadix::
+butterfly4(complex_type* out, const int fstride, const int m) const
+{
+  for (int k=0; k<m; ++k)
+    {
+      const complex_type a1 = out[k+m]*twiddles[k*fstride];
+      const complex_type a2 = out[k+2*m]*twiddles[2*k*fstride];
+      const complex_type a3 = out[k+3*m]*twiddles[3*k*fstride];
+      const complex_type sum02 = out[k] + a2;
+      const complex_type diff02 = out[k] - a2;
+      const complex_type sum13 = a1 + a3;
+      const complex_type diff13 = times_sign_i(a1 - a3);
+      out[k] = sum02 + sum13;
+      out[k+m] = diff02 + diff13;
+      out[k+2*m] = sum02 - sum13;
+      out[k+3*m] = diff02 - diff13;
+    }
+}
+
+void
+FourierPlanMixedRadix::
+butterfly_generic(complex_type* out, const int fstride, const int m, const int p) const
+{
+  const int n = this->get_length();
+  std::vector<complex_type> scratch(p);
+  for (int u=0; u<m; ++u)
+    {
+      for (int q=0; q<p; ++q)
+        scratch[q] = out[u + q*m];
+      for (int q1=0; q1<p; ++q1)
+        {
+          const int k = u + q1*m;
+          // twiddle for element q is exp(sign*2*pi*i*q*k*fstride/n)
+          int twiddle_index = 0;
+          complex_type sum = scratch[0];
+          for (int q=1; q<p; ++q)
+            {
+              twiddle_index += fstride*k;
+              if (twiddle_index >= n)
+                twiddle_index %= n;
+              sum += scratch[q]*twiddles[twiddle_index];
+            }
+          out[k] = sum;
+        }
+    }
+}
+
+#ifdef HAVE_FFTW3
+/* FFTW3 backend.
+
+   Plans are created for in-place transforms of contiguous data with FFTW_UNALIGNED,
+   such that they can be executed on any array with fftwf_execute_dft (which is thread-safe).
+   Strided data is copied to the work buffer first.
+   Note that the FFTW sign convention is the same as ours.
+*/
+class FourierPlanFFTW3 : public FourierPlan
+{
+public:
+  FourierPlanFFTW3(const int length, const int sign);
+  virtual ~FourierPlanFFTW3();
+
+protected:
+  virtual void
+    transform_using_buffer(complex_type* data, const int stride, complex_type* work_buffer) const;
+
+private:
+  fftwf_plan plan;
+};
+
+FourierPlanFFTW3::
+FourierPlanFFTW3(const int length, const int sign)
+  : FourierPlan(length, sign)
+{
+  // with FFTW_ESTIMATE, the array is not overwritten during planning, but it still needs to exist
+  fftwf_complex* tmp = fftwf_alloc_complex(length);
+  // note: planning is not thread-safe, but get_plan() calls this inside a lock
+  plan = fftwf_plan_dft_1d(length, tmp, tmp, sign, FFTW_ESTIMATE | FFTW_UNALIGNED);
+  fftwf_free(tmp);
+  if (plan == 0)
+    error("FourierPlan: FFTW3 failed to create a plan for length %d", length);
+}
+
+FourierPlanFFTW3::
+~FourierPlanFFTW3()
+{
+  fftwf_destroy_plan(plan);
+}
+
+void
+FourierPlanFFTW3::
+transform_using_buffer(complex_type* data, const int stride, complex_type* work_buffer) const
+{
+  if (stride == 1)
+    {
+      fftwf_complex* fftw_data = reinterpret_cast<fftwf_complex*>(data);
+      fftwf_execute_dft(plan, fftw_data, fftw_data);
+      return;
+    }
+  const int n = this->get_length();
+  for (int i=0; i<n; ++i)
+    work_buffer[i] = data[static_cast<std::ptrdiff_t>(i)*stride];
+  fftwf_complex* fftw_data = reinterpret_cast<fftwf_complex*>(work_buffer);
+  fftwf_execute_dft(plan, fftw_data, fftw_data);
+  for (int i=0; i<n; ++i)
+    data[static_cast<std::ptrdiff_t>(i)*stride] = work_buffer[i];
+}
+#endif
+
+} // end of namespace detail
+
+FourierPlan::
+FourierPlan(const int length, const int sign)
+  : length(length), sign(sign)
+{}
+
+std::string
+FourierPlan::
+get_backend_name()
+{
+#ifdef HAVE_FFTW3
+  return "FFTW3";
+#else
+  return "STIR mixed-radix";
+#endif
+}
+
+shared_ptr<const FourierPlan>
+FourierPlan::
+get_plan(const int length, const int sign)
+{
+  if (length <= 0)
+    error("FourierPlan::get_plan called with length %d", length);
+  if (sign != 1 && sign != -1)
+    error("FourierPlan::get_plan called with sign %d (should be 1 or -1)", sign);
+
+  typedef std::map<std::pair<int,int>, shared_ptr<const FourierPlan> > cache_type;
+  const std::pair<int,int> key(length, sign);
+  // every thread keeps its own copy of the plans that it has used, such that it
+  // does not need to lock in the common case
+  static thread_local cache_type thread_cache;
+  const cache_type::const_iterator thread_iter = thread_cache.find(key);
+  if (thread_iter != thread_cache.end())
+    return thread_iter->second;
+
+  static cache_type cache;
+  static std::mutex cache_mutex;
+  shared_ptr<const FourierPlan> plan_sptr;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    shared_ptr<const FourierPlan>& cached_plan_sptr = cache[key];
+    if (!cached_plan_sptr)
+      {
+#ifdef HAVE_FFTW3
+        cached_plan_sptr.reset(new detail::FourierPlanFFTW3(length, sign));
+#else
+        cached_plan_sptr.reset(new detail::FourierPlanMixedRadix(length, sign));
+#endif
+      }
+    plan_sptr = cached_plan_sptr;
+  }
+  thread_cache[key] = plan_sptr;
+  return plan_sptr;
+}
+
+void
+FourierPlan::
+transform(complex_type* data, const int stride) const
+{
+  std::vector<complex_type> work_buffer(length);
+  transform_using_buffer(data, stride, &work_buffer[0]);
+}
+
+void
+FourierPlan::
+transform_many(complex_type* data, const int num_transforms,
+               const int stride, const int distance) const
+{
+  // only use multiple threads when there is enough work
+#ifdef STIR_OPENMP
+#pragma omp parallel if (num_transforms > 1 && static_cast<double>(num_transforms)*length >= 32768)
+#endif
+  {
+    std::vector<complex_type> work_buffer(length);
+#ifdef STIR_OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int t=0; t<num_transforms; ++t)
+      transform_using_buffer(data + static_cast<std::ptrdiff_t>(t)*distance, stride, &work_buffer[0]);
+  }
+}
+
+END_NAMESPACE_STIR
@@ -4,9 +4,11 @@
   \brief Functions for computing discrete fourier transforms
 
   \author Kris Thielemans
+  \author STIR developers
 */
 /*
     Copyright (C) 2003 - 2005-01-17, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
 
     This file is part of STIR.
 
@@ -23,193 +25,130 @@
     See STIR/LICENSE.txt for details
 */
 #include "stir/numerics/fourier.h"
-#include "stir/round.h"
+#include "stir/numerics/FourierPlan.h"
 #include "stir/modulo.h"
 #include "stir/array_index_functions.h"
+#include <algorithm>
 START_NAMESPACE_STIR
 
 
-template <typename T>
-static void bitreversal(VectorWithOffset<T>& data)
-{
-  const int n=data.get_length();
-  int   j=1;
-  for (int i=0;i<n;++i) {
-    if (j/2 > i) {
-      std::swap(data[j/2],data[i]);
-    }
-    int m=n;
-    while (m >= 2 && j > m) {
-      j -= m;
-      m >>= 1;
-    }
-    j += m;
-  }
-}
+namespace detail {
 
-/* We cache factors exp(i*_PI/pow(2,k)). They will be computed during the first
-   call of the Fourier functions, and then stored in static arrays.
+/* All complex transforms are done with a FourierPlan on a contiguous block of memory.
+   For multi-dimensional arrays, the transform along one dimension is a batch
+   of 1D transforms with a stride equal to the product of the sizes of the
+   'inner' dimensions.
 */
-// exparray[k][i] = exp(i*_PI/pow(2,k))
-typedef VectorWithOffset<VectorWithOffset<std::complex<float> > > exparray_t;
-static   exparray_t exparray;
 
-static void init_exparray(const int k, const int pow2k)
+//! transform along dimension \a dim (1-based) of a contiguous regular array with sizes \a sizes
+template <int num_dimensions>
+static void
+fourier_along_dimension(std::complex<float>* data,
+                        const BasicCoordinate<num_dimensions, int>& sizes,
+                        const int dim, const int sign)
 {
-  if (exparray.get_max_index() >= k && exparray[k].size()>0)
+  const int length = sizes[dim];
+  if (length <= 1)
     return;
-
-  if (exparray.get_max_index() <k)
-    exparray.grow(0, k);
-  exparray[k].grow(0,pow2k-1);
-  for (int i=0; i< pow2k; ++i)
-    exparray[k][i]= std::exp(std::complex<float>(0, static_cast<float>((i*_PI)/pow2k)));
+  int num_inner = 1;
+  for (int d=dim+1; d<=num_dimensions; ++d)
+    num_inner *= sizes[d];
+  int num_outer = 1;
+  for (int d=1; d<dim; ++d)
+    num_outer *= sizes[d];
+
+  shared_ptr<const FourierPlan> plan_sptr = FourierPlan::get_plan(length, sign);
+  if (num_inner == 1)
+    plan_sptr->transform_many(data, num_outer, 1, length);
+  else
+    for (int outer=0; outer<num_outer; ++outer)
+      plan_sptr->transform_many(data + static_cast<std::ptrdiff_t>(outer)*length*num_inner,
+                                num_inner, num_inner, 1);
 }
 
-// expminarray[k][i] = exp(-i*_PI/pow(2,k))
-// obviously just the complex conjugate of exparray
-static   exparray_t expminarray;
-
-static void init_expminarray(const int k, const int pow2k)
+//! transform along the first dimension, or along all dimensions
+template <int num_dimensions>
+static void
+fourier_of_array(Array<num_dimensions, std::complex<float> >& c, const int sign,
+                 const bool only_first_dimension)
 {
-  if (expminarray.get_max_index() >= k && expminarray[k].size()>0)
-    return;
-
-  if (expminarray.get_max_index() <k)
-    expminarray.grow(0, k);
-  expminarray[k].grow(0,pow2k-1);
-  for (int i=0; i< pow2k; ++i)
-    expminarray[k][i]= std::exp(std::complex<float>(0, static_cast<float>(-(i*_PI)/pow2k)));
-}
+  if (c.size_all()==0) return;
+  assert(sign==1 || sign ==-1);
+  BasicCoordinate<num_dimensions, int> min_index, max_index;
+  if (!c.get_regular_range(min_index, max_index))
+    error("fourier: can only handle arrays with a regular index range");
+  assert(min_index == (min_index*0));
+  const BasicCoordinate<num_dimensions, int> sizes = max_index - min_index + 1;
 
+  if (!c.is_contiguous())
+    {
+      // copy to a contiguous array, and copy back afterwards
+      Array<num_dimensions, std::complex<float> > tmp(c.get_index_range());
+      std::copy(c.begin_all_const(), c.end_all_const(), tmp.begin_all());
+      fourier_of_array(tmp, sign, only_first_dimension);
+      std::copy(tmp.begin_all_const(), tmp.end_all_const(), c.begin_all());
+      return;
+    }
 
-/* First we define 1D fourier transforms of vectors with almost arbitrary
-   element types.
-   This is almost a straightforward 1D FFT implementation. The only tricky bit
-   is to make sure that all operations are written in a way that is defined
-   (and efficient) in the case that the element type is a vector again.
-*/
+  std::complex<float>* data = c.get_full_data_ptr();
+  const int max_dim = only_first_dimension ? 1 : num_dimensions;
+  for (int dim=1; dim<=max_dim; ++dim)
+    fourier_along_dimension(data, sizes, dim, sign);
+  c.release_full_data_ptr();
+}
 
-template <typename T>
-void fourier_1d(T& c, const int sign)
+static void
+fourier_of_vector(VectorWithOffset<std::complex<float> >& c, const int sign)
 {
   if (c.size()==0) return;
   assert(c.get_min_index()==0);
   assert(sign==1 || sign ==-1);
-  bitreversal(c);
-  // find 'nn' which is such that length==2^nn
-  const int nn=round(log(static_cast<double>(c.size()))/log(2.));
-  if (c.get_length()!= round(pow(2.,nn)))
-    error ("fourier_1d called with array length %d which is not 2^%d\n", c.size(), nn);
-
-  int k=0;
-  int pow2k = 1; // will be updated to be round(pow(2,k))
-  const int pow2nn=c.get_length(); // ==round(pow(2,nn)); 
-  for (; k<nn; ++k, pow2k*=2)
-  {
-    if (sign==1)
-      init_exparray(k,pow2k);
-    else
-      init_expminarray(k,pow2k);
-    const exparray_t& cur_exparray =
-      sign==1? exparray : expminarray;      
-    for (int j=0; j< pow2nn;j+= pow2k*2) 
-      for (int i=0; i< pow2k; ++i)
-      {
-        typename T::reference c1= c[i + j];
-        typename T::reference c2= c[i + j + pow2k];
-        
-        typename T::value_type const t1 = c1; 
-	/* here is what we have to do:
-            typename T::value_type const t2 = 
-              c2*cur_exparray[k][i];
-            c1 = t1+t2; c2 = t1-t2;
-	 however, this would create an unnecessary copy of t2, which is 
-	 potentially large.
-	 So, we rewrite it without t2, and using operations that also 
-	 work when using multi-dim arrays.
-	 Note that for multi-dimensional arrays, this code involves 4 
-	 loops over the same data.
-	 Using expression templates would speed this up.
-	*/
-        c2 *= cur_exparray[k][i];
-        c1 += c2;
-        c2 *= -1;
-        c2 += t1;
-      }
-  }
+  shared_ptr<const FourierPlan> plan_sptr = FourierPlan::get_plan(c.get_length(), sign);
+  plan_sptr->transform(c.get_data_ptr());
+  c.release_data_ptr();
 }
 
-namespace detail {
-
-/* A class that does the recursion for multi-dimensional arrays.
+// overloads to select the above functions for the supported types
 
-   This is done with a class because partial template specialisation is
-   more powerful than function overloading.
-*/
-template <typename elemT>
-struct fourier_auxiliary
+static inline void
+do_fourier_1d(VectorWithOffset<std::complex<float> >& c, const int sign)
 {
-  static void 
-  do_fourier(VectorWithOffset<elemT >& c, const int sign)
-  {
-    fourier_1d(c, sign);
-    const typename VectorWithOffset<elemT>::iterator iter_end = c.end();
-    for (typename VectorWithOffset<elemT>::iterator iter = c.begin();
-	 iter != iter_end;
-	 ++iter)
-      fourier(*iter, sign);
-  }
-};
-
-// specialisation for the one-dimensional case
-#ifndef BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+  fourier_of_vector(c, sign);
+}
 
-template <typename elemT>
-struct fourier_auxiliary<std::complex<elemT> >
+template <int num_dimensions>
+static inline void
+do_fourier_1d(Array<num_dimensions, std::complex<float> >& c, const int sign)
 {
-  static void 
-  do_fourier(VectorWithOffset<std::complex<elemT> >& c, const int sign)
-  {
-    fourier_1d(c, sign);
-  }
-};
-
-
-#else  //no partial template specialisation
+  fourier_of_array(c, sign, /* only_first_dimension = */ true);
+}
 
-// we just list float and double explicitly
-struct fourier_auxiliary<std::complex<float> >
+static inline void
+do_fourier(VectorWithOffset<std::complex<float> >& c, const int sign)
 {
-  static void 
-  do_fourier(VectorWithOffset<std::complex<float> >& c, const int sign)
-  {
-    fourier_1d(c, sign);
-  }
-};
+  fourier_of_vector(c, sign);
+}
 
-struct fourier_auxiliary<std::complex<double> >
+template <int num_dimensions>
+static inline void
+do_fourier(Array<num_dimensions, std::complex<float> >& c, const int sign)
 {
-  static void 
-  do_fourier(VectorWithOffset<std::complex<double> >& c, const int sign)
-  {
-    fourier_1d(c, sign);
-  }
-};
-#endif
+  fourier_of_array(c, sign, /* only_first_dimension = */ false);
+}
 
 } // end of namespace detail
 
-// now the fourier function is easy to define in terms of the class above
+template <typename T>
+void fourier_1d(T& c, const int sign)
+{
+  detail::do_fourier_1d(c, sign);
+}
+
 template <typename T>
 void 
 fourier(T& c, const int sign)
 {
-#if !defined(_MSC_VER) || _MSC_VER>1200
-  detail::fourier_auxiliary<typename T::value_type>::do_fourier(c,sign);
-#else
-  detail::fourier_auxiliary<T::value_type>::do_fourier(c,sign);
-#endif
+  detail::do_fourier(c, sign);
 }
 
 
@@ -253,9 +192,7 @@ fourier_1d_for_real_data(const Array<1,T>& v, const int sign)
     {
       const complex_t t1 = 
 	(c[i]+std::conj(c[n-i]));
-      // TODO could get exp() from static exparray
-      // the nice thing about this code that it works even when the length is not a power of 2
-      // (but of course, the call to fourier_1d would currently abort in that case)
+      // TODO could get exp() from the twiddle factors of the FourierPlan
       const complex_t t2 = 			   
 	std::exp(complex_t(0, static_cast<T>(sign*(i*_PI)/n-_PI/2)))*
 	(c[i]-std::conj(c[n-i]));
@@ -280,9 +217,8 @@ inverse_fourier_1d_for_real_data_corrupting_input(Array<1,std::complex<T> >& c,
   if (c.size()==0) return Array<1,T>();
   assert(c.get_min_index()==0);
   assert(sign==1 || sign ==-1);
+  // note: the result will have length 2*n, so n itself does not need to be even
   const int n = c.get_length()-1;
-  if (n%2!=0)
-    error("inverse_fourier_1d_of_real_data can only handle arrays of even length.\n");
 
   /* Problematic asserts to check that the imaginary part of c[0] and c[n] is 0
      Trouble is that it could be only approximately 0 (e.g. when calling 
@@ -298,7 +234,7 @@ inverse_fourier_1d_for_real_data_corrupting_input(Array<1,std::complex<T> >& c,
   for (int i=1; i<=n/2; ++i)
     {
       const complex_t t1 = (c[i]+std::conj(c[n-i]));
-      // TODO could get exp() from static exparray
+      // TODO could get exp() from the twiddle factors of the FourierPlan
       const complex_t t2 = 			   
 	std::exp(complex_t(0, static_cast<T>(-sign*(i*_PI)/n+_PI/2)))*
 	(c[i]-std::conj(c[n-i]));
@@ -349,36 +285,52 @@ struct fourier_for_real_data_auxiliary
   static Array<num_dimensions,std::complex<elemT> >
   do_fourier_for_real_data(const Array<num_dimensions,elemT >& c, const int sign)
   {
-    // complicated business to get index range which is as follows:
-    // outer_dimension = outer_dimension of c
-    // all other dimensions are as small as possible (to avoid reallocations)
+    if (c.size_all()==0) return Array<num_dimensions,std::complex<elemT> >();
+    // the result has the same index range as c, except that the last dimension
+    // only contains the positive frequencies
     BasicCoordinate<num_dimensions, int> min_index, max_index;
-    for (int d=2; d<=num_dimensions; ++d)
-      min_index[d] = max_index[d] = 0;
-    min_index[1] = c.get_min_index();
-    max_index[1] = c.get_max_index();
+    if (!c.get_regular_range(min_index, max_index))
+      error("fourier_for_real_data can only handle arrays with a regular index range.\n");
+    const int length = max_index[num_dimensions] - min_index[num_dimensions] + 1;
+    if (length%2!=0)
+      error("fourier_for_real_data can only handle arrays of even length in the last dimension.\n");
+    max_index[num_dimensions] = min_index[num_dimensions] + length/2;
     Array<num_dimensions, std::complex<elemT> > array(IndexRange<num_dimensions>(min_index, max_index));
+
+    // the rows are independent
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
     for (int i=c.get_min_index(); i<=c.get_max_index(); ++i)
-      array[i] = fourier_for_real_data(c[i], sign);
+      {
+        const Array<num_dimensions-1, std::complex<elemT> > row = fourier_for_real_data(c[i], sign);
+        std::copy(row.begin_all_const(), row.end_all_const(), array[i].begin_all());
+      }
     fourier_1d(array, sign);
     return array;
   }
   static Array<num_dimensions,elemT>
   do_inverse_fourier_for_real_data_corrupting_input(Array<num_dimensions,std::complex<elemT> >& c, const int sign)
   {
-    inverse_fourier_1d(c, sign);
-    // complicated business to get index range which is as follows:
-    // outer_dimension = outer_dimension of c
-    // all other dimensions are as small as possible (to avoid reallocations)
+    if (c.size_all()==0) return Array<num_dimensions,elemT>();
+    // the result has the same index range as c, except for the last dimension
     BasicCoordinate<num_dimensions, int> min_index, max_index;
-    for (int d=2; d<=num_dimensions; ++d)
-      min_index[d] = max_index[d] = 0;
-    min_index[1] = c.get_min_index();
-    max_index[1] = c.get_max_index();
+    if (!c.get_regular_range(min_index, max_index))
+      error("inverse_fourier_for_real_data can only handle arrays with a regular index range.\n");
+    const int n = max_index[num_dimensions] - min_index[num_dimensions];
+    max_index[num_dimensions] = min_index[num_dimensions] + 2*n - 1;
     Array<num_dimensions, elemT> array(IndexRange<num_dimensions>(min_index, max_index));
 
+    inverse_fourier_1d(c, sign);
+    // the rows are independent
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
     for (int i=c.get_min_index(); i<=c.get_max_index(); ++i)
-      array[i] = inverse_fourier_for_real_data_corrupting_input(c[i], sign);
+      {
+        const Array<num_dimensions-1, elemT> row = inverse_fourier_for_real_data_corrupting_input(c[i], sign);
+        std::copy(row.begin_all_const(), row.end_all_const(), array[i].begin_all());
+      }
     return array;
   }
 };
@@ -530,6 +482,22 @@ template
 void 
 fourier<>(VectorWithOffset<std::complex<float> >& c, const int sign);
 
+template
+void
+fourier_1d<>(Array<3,std::complex<float> >& c, const int sign);
+
+template
+void
+fourier_1d<>(Array<2,std::complex<float> >& c, const int sign);
+
+template
+void
+fourier_1d<>(Array<1,std::complex<float> >& c, const int sign);
+
+template
+void
+fourier_1d<>(VectorWithOffset<std::complex<float> >& c, const int sign);
+
 #define INSTANTIATE(d,type) \
  template \
  Array<d,std::complex<type> > \
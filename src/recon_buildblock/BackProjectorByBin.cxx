@@ -9,12 +9,14 @@
   \author Kris Thielemans
   \author PARAPET project
   \author Richard Brown
-  
+  \author STIR developers
+
 */
 /*
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000- 2011, Hammersmith Imanet Ltd
     Copyright (C) 2015, 2018-2019, University College London
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -40,9 +42,8 @@
 #include "stir/is_null_ptr.h"
 #include "stir/DataProcessor.h"
 #include <vector>
+#include <algorithm>
 #ifdef STIR_OPENMP
-#include "stir/is_null_ptr.h"
-#include "stir/DiscretisedDensity.h"
 #include <omp.h>
 #endif
 #include <boost/format.hpp>
@@ -57,6 +58,9 @@ BackProjectorByBin::BackProjectorByBin()
 
 BackProjectorByBin::~BackProjectorByBin()
 {
+#ifdef STIR_OPENMP
+  destroy_local_output_image_locks();
+#endif
 }
 
 void
@@ -64,6 +68,7 @@ BackProjectorByBin::
 set_defaults()
 {
   _post_data_processor_sptr.reset();
+  _max_num_accumulation_images = 0;
 }
 
 void
@@ -73,6 +78,7 @@ initialise_keymap()
   parser.add_start_key("Back Projector Parameters");
   parser.add_stop_key("End Back Projector Parameters");
   parser.add_parsing_key("post data processor", &_post_data_processor_sptr);
+  parser.add_key("maximum number of images for accumulation", &_max_num_accumulation_images);
 }
 
 void
@@ -85,11 +91,20 @@ set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
   _density_sptr.reset(density_info_sptr->clone());
 
 #ifdef STIR_OPENMP
+  int num_threads = 1;
 #pragma omp parallel
     {
 #pragma omp single
-      _local_output_image_sptrs.resize(omp_get_num_threads(), shared_ptr<DiscretisedDensity<3,float> >());
+      num_threads = omp_get_num_threads();
     }
+    const int num_images =
+      _max_num_accumulation_images > 0 ? std::min(_max_num_accumulation_images, num_threads) : num_threads;
+    destroy_local_output_image_locks();
+    _local_output_image_sptrs.resize(num_images, shared_ptr<DiscretisedDensity<3,float> >());
+    _local_output_image_locks.resize(num_images);
+    for (int i=0; i<num_images; ++i)
+      omp_init_lock(&_local_output_image_locks[i]);
+    _local_output_image_index_for_thread.assign(num_threads, -1);
     for (int i=0; i<static_cast<int>(_local_output_image_sptrs.size()); ++i)
       if(!is_null_ptr(_local_output_image_sptrs[i])) // already created in previous run
         if (!_local_output_image_sptrs[i]->has_same_characteristics(*density_info_sptr))
@@ -101,6 +116,75 @@ set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
 #endif
 }
 
+#ifdef STIR_OPENMP
+void
+BackProjectorByBin::
+destroy_local_output_image_locks()
+{
+  for (std::vector<omp_lock_t>::iterator iter = _local_output_image_locks.begin();
+       iter != _local_output_image_locks.end(); ++iter)
+    omp_destroy_lock(&*iter);
+  _local_output_image_locks.clear();
+}
+
+int
+BackProjectorByBin::
+lock_local_output_image()
+{
+  const int thread_num=omp_get_thread_num();
+  if (thread_num >= static_cast<int>(_local_output_image_index_for_thread.size()))
+    error("BackProjectorByBin: more OpenMP threads than when set_up() was called");
+  const int num_images = static_cast<int>(_local_output_image_sptrs.size());
+  // start with our "own" image, but take any other free one if it is in use
+  int image_index = -1;
+  for (int i=0; i<num_images; ++i)
+    {
+      const int candidate = (thread_num + i) % num_images;
+      if (omp_test_lock(&_local_output_image_locks[candidate]))
+        {
+          image_index = candidate;
+          break;
+        }
+    }
+  if (image_index < 0)
+    {
+      image_index = thread_num % num_images;
+      omp_set_lock(&_local_output_image_locks[image_index]);
+    }
+  // only the thread holding the lock can get here, so no race
+  if(is_null_ptr(_local_output_image_sptrs[image_index]))
+    _local_output_image_sptrs[image_index].reset(_density_sptr->get_empty_copy());
+  _local_output_image_index_for_thread[thread_num] = image_index;
+  return image_index;
+}
+
+void
+BackProjectorByBin::
+unlock_local_output_image(const int image_index)
+{
+  _local_output_image_index_for_thread[omp_get_thread_num()] = -1;
+  omp_unset_lock(&_local_output_image_locks[image_index]);
+}
+#endif
+
+void
+BackProjectorByBin::
+sum_images(DiscretisedDensity<3,float>& density,
+           const std::vector< shared_ptr<DiscretisedDensity<3,float> > >& image_sptrs)
+{
+  // every thread handles a slab of planes, such that no synchronisation is needed
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int z=density.get_min_index(); z<=density.get_max_index(); ++z)
+    {
+      density[z].fill(0.F);
+      for (std::size_t i=0; i<image_sptrs.size(); ++i)
+        if(!is_null_ptr(image_sptrs[i])) // only accumulate if a thread filled something in
+          density[z] += (*image_sptrs[i])[z];
+    }
+}
+
 void
 BackProjectorByBin::
 check(const ProjDataInfo& proj_data_info, const DiscretisedDensity<3,float>& density_info) const
@@ -218,27 +302,15 @@ BackProjectorByBin::back_project(const ProjData& proj_data, int subset_num, int
     for (int i=0; i<static_cast<int>(vs_nums_to_process.size()); ++i)
       {
         const ViewSegmentNumbers vs=vs_nums_to_process[i];
-#ifdef STIR_OPENMP
-        RelatedViewgrams<float> viewgrams;
-#pragma omp critical (BACKPROJECTORBYBIN_GETVIEWGRAMS)
-        viewgrams = proj_data.get_related_viewgrams(vs, symmetries_sptr);
-#else
+        // no critical section needed, ProjData handles concurrent reads
         const RelatedViewgrams<float> viewgrams =
           proj_data.get_related_viewgrams(vs, symmetries_sptr);
-#endif
 
         info(boost::format("Processing view %1% of segment %2%") % vs.view_num() % vs.segment_num(), 2);
         back_project(viewgrams);
       }
   }
-#ifdef STIR_OPENMP
-  // "reduce" data constructed by threads
-  {
-    for (int i=0; i<static_cast<int>(_local_output_image_sptrs.size()); ++i)
-      if(!is_null_ptr(_local_output_image_sptrs[i])) // only accumulate if a thread filled something in
-        (*_density_sptr) += *(_local_output_image_sptrs[i]);
-  }
-#endif
+  // note: the images of the threads are summed by get_output()
 }
 
 void
@@ -276,12 +348,6 @@ back_project(const RelatedViewgrams<float>& viewgrams,
 
   start_timers();
 
-#ifdef STIR_OPENMP
-  const int thread_num=omp_get_thread_num();
-  if(is_null_ptr(_local_output_image_sptrs[thread_num]))
-    _local_output_image_sptrs[thread_num].reset(_density_sptr->get_empty_copy());
-#endif
-
   // first check symmetries
   {
     const ViewSegmentNumbers basic_vs = viewgrams.get_basic_view_segment_num();
@@ -301,12 +367,18 @@ back_project(const RelatedViewgrams<float>& viewgrams,
     }
   }
 
+#ifdef STIR_OPENMP
+  const int image_index = lock_local_output_image();
+#endif
   actual_back_project(
          viewgrams,
          min_axial_pos_num,
          max_axial_pos_num,
          min_tangential_pos_num,
          max_tangential_pos_num);
+#ifdef STIR_OPENMP
+  unlock_local_output_image(image_index);
+#endif
   stop_timers();
 }
 
@@ -323,9 +395,15 @@ start_accumulating_in_new_target()
       {
         if (!_local_output_image_sptrs.at(i)->has_same_characteristics(*_density_sptr))
           error("BackProjectorByBin implementation error: local images for openmp have wrong size");
-        _local_output_image_sptrs.at(i)->fill(0.F);
       }
-
+  // set all images to zero, in parallel over planes
+#pragma omp parallel for schedule(static)
+  for (int z=_density_sptr->get_min_index(); z<=_density_sptr->get_max_index(); ++z)
+    {
+      for (int i=0; i<static_cast<int>(_local_output_image_sptrs.size()); ++i)
+        if(!is_null_ptr(_local_output_image_sptrs[i]))
+          (*_local_output_image_sptrs[i])[z].fill(0.F);
+    }
 #endif
     _density_sptr->fill(0.);
 }
@@ -342,13 +420,7 @@ get_output(DiscretisedDensity<3,float> &density) const
         error("BackProjectorByBin::get_output() cannot be called inside a thread");
 
   // "reduce" data constructed by threads
-  {
-    density.fill(0.F);
-    for (int i=0; i<static_cast<int>(_local_output_image_sptrs.size()); ++i) {
-        if(!is_null_ptr(_local_output_image_sptrs[i]))// only accumulate if a thread filled something in
-            density += *(_local_output_image_sptrs[i]);
-    }
-  }
+  sum_images(density, _local_output_image_sptrs);
 #else
     std::copy(_density_sptr->begin_all(), _density_sptr->end_all(), density.begin_all());
 #endif
@@ -368,6 +440,23 @@ set_post_data_processor(shared_ptr<DataProcessor<DiscretisedDensity<3,float> > >
     _post_data_processor_sptr = post_data_processor_sptr;
 }
 
+void
+BackProjectorByBin::
+set_max_num_accumulation_images(const int max_num_images)
+{
+  if (max_num_images < 0)
+    error("BackProjectorByBin::set_max_num_accumulation_images: argument should be at least 0");
+  _max_num_accumulation_images = max_num_images;
+  _already_set_up = false;
+}
+
+int
+BackProjectorByBin::
+get_max_num_accumulation_images() const
+{
+  return _max_num_accumulation_images;
+}
+
 void
 BackProjectorByBin::
 actual_back_project(DiscretisedDensity<3,float>&,
@@ -386,8 +475,11 @@ actual_back_project(const RelatedViewgrams<float>& viewgrams,
 {
     shared_ptr<DiscretisedDensity<3,float> > density_sptr = _density_sptr;
 #ifdef STIR_OPENMP
-    const int thread_num=omp_get_thread_num();
-    density_sptr = _local_output_image_sptrs[thread_num];
+    // use the image locked by this thread in back_project()
+    const int image_index = _local_output_image_index_for_thread[omp_get_thread_num()];
+    if (image_index < 0)
+      error("BackProjectorByBin::actual_back_project called without locking an image");
+    density_sptr = _local_output_image_sptrs[image_index];
 #endif
     actual_back_project(*density_sptr, viewgrams,
                         min_axial_pos_num, max_axial_pos_num,
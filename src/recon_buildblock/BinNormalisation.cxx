@@ -133,27 +133,14 @@ apply(ProjData& proj_data,const double start_time, const double end_time,
     {
       const ViewSegmentNumbers vs=vs_nums_to_process[i];
       
-      RelatedViewgrams<float> viewgrams;
-#ifdef STIR_OPENMP
-      // reading/writing to streams is not safe in multi-threaded code
-      // so protect with a critical section
-      // note that the name of the section has to be same for the get/set
-      // function as they're reading from/writing to the same stream
-#pragma omp critical (BINNORMALISATION_APPLY__VIEWGRAMS)
-#endif
-      {
-        viewgrams = 
-          proj_data.get_related_viewgrams(vs, symmetries_sptr);
-      }
+      // no critical sections needed, ProjData handles concurrent reads and writes
+      // (ProjDataFromStream protects its stream internally)
+      RelatedViewgrams<float> viewgrams =
+        proj_data.get_related_viewgrams(vs, symmetries_sptr);
 
       this->apply(viewgrams, start_time, end_time);
 
-#ifdef STIR_OPENMP
-#pragma omp critical (BINNORMALISATION_APPLY__VIEWGRAMS)
-#endif
-      {
-        proj_data.set_related_viewgrams(viewgrams);
-      }
+      proj_data.set_related_viewgrams(viewgrams);
     }
 }
 
@@ -179,23 +166,12 @@ undo(ProjData& proj_data,const double start_time, const double end_time,
     {
       const ViewSegmentNumbers vs=vs_nums_to_process[i];
       
-      RelatedViewgrams<float> viewgrams;
-#ifdef STIR_OPENMP
-#pragma omp critical (BINNORMALISATION_UNDO__VIEWGRAMS)
-#endif
-      {
-        viewgrams = 
-          proj_data.get_related_viewgrams(vs, symmetries_sptr);
-      }
+      RelatedViewgrams<float> viewgrams =
+        proj_data.get_related_viewgrams(vs, symmetries_sptr);
 
       this->undo(viewgrams, start_time, end_time);
 
-#ifdef STIR_OPENMP
-#pragma omp critical (BINNORMALISATION_UNDO__VIEWGRAMS)
-#endif
-      {
-        proj_data.set_related_viewgrams(viewgrams);
-      }
+      proj_data.set_related_viewgrams(viewgrams);
     }
 }
 
@@ -0,0 +1,119 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup distributable
+
+  \brief Implementation of class stir::DistributableCostModel
+
+  \author STIR developers
+*/
+
+#include "stir/recon_buildblock/DistributableCostModel.h"
+#include "stir/DataSymmetriesForViewSegmentNumbers.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Bin.h"
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+DistributableCostModel::
+DistributableCostModel()
+{
+  reset();
+}
+
+void
+DistributableCostModel::
+reset()
+{
+  measured_costs.clear();
+  sum_measured_costs = 0.;
+  sum_geometric_costs_of_measured = 0.;
+}
+
+double
+DistributableCostModel::
+get_geometric_cost(const ProjDataInfo& proj_data_info,
+                   const DataSymmetriesForViewSegmentNumbers& symmetries,
+                   const ViewSegmentNumbers& vs_num)
+{
+  const int segment_num = vs_num.segment_num();
+  const int num_axial_poss = proj_data_info.get_num_axial_poss(segment_num);
+  const Bin bin(segment_num, vs_num.view_num(),
+                proj_data_info.get_min_axial_pos_num(segment_num) + num_axial_poss/2, 0);
+  const double tantheta = proj_data_info.get_tantheta(bin);
+  return
+    static_cast<double>(symmetries.num_related_view_segment_numbers(vs_num)) *
+    num_axial_poss * proj_data_info.get_num_tangential_poss() *
+    std::sqrt(1 + tantheta*tantheta);
+}
+
+double
+DistributableCostModel::
+get_estimated_cost(const ProjDataInfo& proj_data_info,
+                   const DataSymmetriesForViewSegmentNumbers& symmetries,
+                   const ViewSegmentNumbers& vs_num) const
+{
+  const costs_type::const_iterator iter = measured_costs.find(vs_num);
+  if (iter != measured_costs.end())
+    return iter->second.first;
+  const double geometric_cost = get_geometric_cost(proj_data_info, symmetries, vs_num);
+  if (sum_geometric_costs_of_measured > 0.)
+    return geometric_cost * sum_measured_costs / sum_geometric_costs_of_measured;
+  return geometric_cost;
+}
+
+void
+DistributableCostModel::
+set_measured_cost(const ViewSegmentNumbers& vs_num, const double measured_cost, const double geometric_cost)
+{
+  std::pair<double, double>& costs = measured_costs[vs_num];
+  // remove previous measurement (if any) from the sums
+  sum_measured_costs -= costs.first;
+  sum_geometric_costs_of_measured -= costs.second;
+  costs = std::make_pair(measured_cost, geometric_cost);
+  sum_measured_costs += measured_cost;
+  sum_geometric_costs_of_measured += geometric_cost;
+}
+
+std::vector<ViewSegmentNumbers>
+DistributableCostModel::
+sort_by_decreasing_cost(const std::vector<ViewSegmentNumbers>& vs_nums,
+                        const ProjDataInfo& proj_data_info,
+                        const DataSymmetriesForViewSegmentNumbers& symmetries) const
+{
+  std::vector<std::pair<double, ViewSegmentNumbers> > costs_and_vs_nums;
+  costs_and_vs_nums.reserve(vs_nums.size());
+  for (std::vector<ViewSegmentNumbers>::const_iterator iter = vs_nums.begin(); iter != vs_nums.end(); ++iter)
+    costs_and_vs_nums.push_back(std::make_pair(get_estimated_cost(proj_data_info, symmetries, *iter), *iter));
+  // stable_sort such that the order is reproducible for equal costs
+  std::stable_sort(costs_and_vs_nums.begin(), costs_and_vs_nums.end(),
+                   [](const std::pair<double, ViewSegmentNumbers>& a, const std::pair<double, ViewSegmentNumbers>& b)
+                   { return a.first > b.first; });
+  std::vector<ViewSegmentNumbers> result;
+  result.reserve(vs_nums.size());
+  for (std::size_t i=0; i<costs_and_vs_nums.size(); ++i)
+    result.push_back(costs_and_vs_nums[i].second);
+  return result;
+}
+
+END_NAMESPACE_STIR
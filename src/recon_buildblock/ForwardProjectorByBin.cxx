@@ -215,13 +215,9 @@ ForwardProjectorByBin::forward_project(ProjData& proj_data,
       RelatedViewgrams<float> viewgrams =
         proj_data.get_empty_related_viewgrams(vs, symmetries_sptr);
       forward_project(viewgrams);
-#ifdef STIR_OPENMP
-#pragma omp critical (FORWARDPROJ_SETVIEWGRAMS)
-#endif
-      {
-        if (!(proj_data.set_related_viewgrams(viewgrams) == Succeeded::yes))
-          error("Error set_related_viewgrams in forward projecting");
-      }
+      // no critical section needed, ProjData handles concurrent writes
+      if (!(proj_data.set_related_viewgrams(viewgrams) == Succeeded::yes))
+        error("Error set_related_viewgrams in forward projecting");
     }
 
 }
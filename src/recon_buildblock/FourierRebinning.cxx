@@ -7,6 +7,7 @@
   \author Kris Thielemans
   \author Oliver Nix
   \author PARAPET project
+  \author STIR developers
 */
 /*
     Copyright (C) 1193 - 1996, Matthias Egger (copyright transfered to Hammersmith Imanet Ltd)
@@ -15,6 +16,7 @@
     Copyright (C) 2004 - 2005 DKFZ Heidelberg, Germany
     Copyright (C) 2011-07-01 - 2012, Kris Thielemans
     Copyright (C) 2013, University College London
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -51,6 +53,11 @@
 #include "stir/numerics/fourier.h"
 #include "stir/interpolate.h"
 #include "stir/info.h"
+#include <algorithm>
+#include <vector>
+#ifdef STIR_OPENMP
+#include <omp.h>
+#endif
 
 #define POSITIVE_Z_SHIFT -1
 #define NEGATIVE_Z_SHIFT 1
@@ -265,7 +272,11 @@ rebin()
   //CL now finally fill in the new sinogram s
   SegmentBySinogram<float> sino2D_rebinned = rebinned_proj_data_sptr->get_empty_segment_by_sinogram(0);
 
-  
+  //CON The planes are independent, so they can be processed in parallel
+  //CON (except when displaying debug information).
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic) if(fore_debug_level<3)
+#endif
   for (int plane=FT_rebinned_data.get_min_index();plane <= FT_rebinned_data.get_max_index(); plane++){
    
    if(plane%10==0) info(boost::format("FORE Rebinning :: Inv FFT rebinned z-position (slice) = %1%") % plane);
@@ -309,7 +320,7 @@ rebin()
     }
   
   //CON inverse FFT the rebinned sinograms  
-    rebinned_sinogram = inverse_fourier_for_real_data(FT_rebinned_sinogram); 
+    rebinned_sinogram = inverse_fourier_for_real_data_corrupting_input(FT_rebinned_sinogram); 
 
    //CL Keep only one half of data [o.._PI]
     for (int i=0;i<(int)(num_views_pow2/2);i++) 
@@ -360,35 +371,90 @@ do_rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &We
    const int local_miss= count_rebinned.miss;
    const int local_ssrb= count_rebinned.ssrb;
 
-//CON Loop over all slices, FFT the sinograms and call the actual rebinning kernel.
-   for (int axial_pos_num = segment.get_min_axial_pos_num(); axial_pos_num <= segment.get_max_axial_pos_num() ;axial_pos_num++)   
-     {
+   const ProjDataInfo& proj_data_info = *segment.get_proj_data_info_sptr();
+   const int max_k = num_views_pow2/2;
+
+   //CON The sinograms are processed in batches. First the 2D FFTs of all sinograms in the batch
+   //CON are computed in parallel. Then the rebinning kernel is called for every sinogram
+   //CON where every thread handles a range of angular frequencies k. Every element of
+   //CON FT_rebinned_data is therefore still updated in the same order as when looping over the sinograms
+   //CON serially, such that the result does not depend on the number of threads.
+#ifdef STIR_OPENMP
+   const int batch_size = 4*omp_get_max_threads();
+#else
+   const int batch_size = 1;
+#endif
+   std::vector<Array<2,std::complex<float> > > FT_sinograms(batch_size);
+   std::vector<int> zs(batch_size);
 
-      if(axial_pos_num%10 == 0)  info(boost::format("FORE Rebinning z (slice) = %1%") % axial_pos_num);   
-      Array<2,float> current_sinogram(IndexRange2D(0,num_tang_poss_pow2-1,0,num_views_pow2-1));
+   for (int first_axial_pos_num = segment.get_min_axial_pos_num();
+        first_axial_pos_num <= segment.get_max_axial_pos_num();
+        first_axial_pos_num += batch_size)
+     {
+       const int last_axial_pos_num = std::min(first_axial_pos_num + batch_size - 1, segment.get_max_axial_pos_num());
+
+       for (int axial_pos_num = first_axial_pos_num; axial_pos_num <= last_axial_pos_num; axial_pos_num++)
+         {
+           if(axial_pos_num%10 == 0)  info(boost::format("FORE Rebinning z (slice) = %1%") % axial_pos_num);   
+           //CON determine the axial position of the middle of the LOR in mm relative to Bin(segment=0,view=0,axial_pos=0,tang_pos=0)  
+           const float z_in_mm = proj_data_info.get_m(Bin(segment.get_segment_num(),0,axial_pos_num,0)) - proj_data_info.get_m(Bin(0,0,0,0));
+           //CON determine z position (sino identifier)
+           const int z = round(z_in_mm/half_distance_between_rings);
+           // TODO replace call to error() by warning() and returning Succeeded::no
+           if(fabs(static_cast<float>(z_in_mm/half_distance_between_rings - z)) > .0001)
+             error("FORE rebinning :: rebinning kernel expected integer z coordinate but found a non integer value %g\n", z_in_mm);
+           zs[axial_pos_num - first_axial_pos_num] = z;
+         }
+
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+       for (int axial_pos_num = first_axial_pos_num; axial_pos_num <= last_axial_pos_num; axial_pos_num++)
+         {
+           Array<2,float> current_sinogram(IndexRange2D(0,num_tang_poss_pow2-1,0,num_views_pow2-1));
   
-  //CL Calculate the 2D FFT of P(w,k) of the merged segment
-  //CON copy the sinogram data of slice axial_pos_num from the segment array to slicedata
-  //CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
-  //CON coefficients are assigned opposite.
-     for (int j = 0; j < segment.get_num_tangential_poss(); j++) 
-      for (int i = 0; i < num_views_pow2; i++) 
-        current_sinogram[j][i] = segment[axial_pos_num][i][j + segment.get_min_tangential_pos_num()];
+           //CL Calculate the 2D FFT of P(w,k) of the merged segment
+           //CON copy the sinogram data of slice axial_pos_num from the segment array to slicedata
+           //CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
+           //CON coefficients are assigned opposite.
+           for (int j = 0; j < segment.get_num_tangential_poss(); j++) 
+             for (int i = 0; i < num_views_pow2; i++) 
+               current_sinogram[j][i] = segment[axial_pos_num][i][j + segment.get_min_tangential_pos_num()];
        
-  //CON FFT slicedata
-   const Array<2,std::complex<float> > FT_current_sinogram = fourier_for_real_data(current_sinogram);
-
-  //CON determine the axial position of the middle of the LOR in mm relative to Bin(segment=0,view=0,axial_pos=0,tang_pos=0)  
-    const ProjDataInfo& proj_data_info = *segment.get_proj_data_info_sptr();
-    const float z_in_mm = proj_data_info.get_m(Bin(segment.get_segment_num(),0,axial_pos_num,0)) - proj_data_info.get_m(Bin(0,0,0,0));
-
-  //CON Call the rebinning kernel.                                                             
-    rebinning(FT_rebinned_data,Weights_for_FT_rebinned_data,count_rebinned,FT_current_sinogram,
-              z_in_mm, average_ring_difference_in_segment, num_views_pow2,
-              num_tang_poss_pow2,half_distance_between_rings,sampling_distance_in_s,radial_sampling_freq_w,
-              R_field_of_view_mm,ratio_ring_spacing_to_ring_radius);
+           //CON FFT slicedata
+           FT_sinograms[axial_pos_num - first_axial_pos_num] = fourier_for_real_data(current_sinogram);
+         }
 
- }//CL End of loop of axial_pos_num
+#ifdef STIR_OPENMP
+#pragma omp parallel
+#endif
+       {
+#ifdef STIR_OPENMP
+         const int thread_num = omp_get_thread_num();
+         const int num_threads = omp_get_num_threads();
+#else
+         const int thread_num = 0;
+         const int num_threads = 1;
+#endif
+         //CON contiguous range of k for this thread
+         const int min_k_this_thread = (max_k+1)*thread_num/num_threads;
+         const int max_k_this_thread = (max_k+1)*(thread_num+1)/num_threads - 1;
+         PETCount_rebinned count_this_thread(0,0,0);
+
+         //CON Call the rebinning kernel.                                                             
+         for (int axial_pos_num = first_axial_pos_num; axial_pos_num <= last_axial_pos_num; axial_pos_num++)
+           rebinning(FT_rebinned_data,Weights_for_FT_rebinned_data,count_this_thread,
+                     FT_sinograms[axial_pos_num - first_axial_pos_num],
+                     zs[axial_pos_num - first_axial_pos_num], average_ring_difference_in_segment, num_views_pow2,
+                     num_tang_poss_pow2,half_distance_between_rings,sampling_distance_in_s,radial_sampling_freq_w,
+                     R_field_of_view_mm,ratio_ring_spacing_to_ring_radius,
+                     min_k_this_thread, max_k_this_thread);
+#ifdef STIR_OPENMP
+#pragma omp critical(FORE_COUNT_REBINNED)
+#endif
+         count_rebinned += count_this_thread;
+       }
+     }//CL End of loop of axial_pos_num
      
     if(fore_debug_level > 0){
       info(boost::format("Total rebinned: %1%\n"
@@ -406,20 +472,16 @@ void
 FourierRebinning::
 rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &Weights_for_FT_rebinned_data,
           PETCount_rebinned &num_rebinned, const Array<2,std::complex<float> > &FT_current_sinogram,
-	  const float z_in_mm, const float delta, 
+	  const int z, const float delta, 
           const int num_views_pow2, const int num_tang_poss_pow2, const float half_distance_between_rings, 
 	  const float sampling_distance_in_s, const float radial_sampling_freq_w, const float R_field_of_view_mm, 
-          const float ratio_ring_spacing_to_ring_radius)
+          const float ratio_ring_spacing_to_ring_radius,
+          const int min_k, const int max_k)
 {
 
  
   //CON prevent rebinning to non existing z-positions (sinograms)
   const int maxplane = FT_rebinned_data.get_max_index();
-  //CON determine z position (sino identifier)
-  const int z = round(z_in_mm/half_distance_between_rings);
-  // TODO replace call to error() by warning() and returning Succeeded::no
-  if(fabs(static_cast<float>(z_in_mm/half_distance_between_rings - z)) > .0001)
-       error("FORE rebinning :: rebinning kernel expected integer z coordinate but found a non integer value %g\n", z_in_mm);
           
   //CL t is the tangent of the angle theta between the LOR and the transaxial plane
   const float   t = delta * ratio_ring_spacing_to_ring_radius / 2.F;
@@ -432,7 +494,7 @@ rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &Weigh
   //CON Iterate over all frequency tuples (w,k) starting from wmin,kmin up to num_tang_poss_pow2/2,num_views_pow2/2
 
       for (int j = wmin; j <= num_tang_poss_pow2/2;j++) {
-        for (int i = kmin; i <= num_views_pow2/2; i++) {
+        for (int i = std::max(kmin, min_k); i <= std::min(num_views_pow2/2, max_k); i++) {
 
               float w = static_cast<float>(j) * radial_sampling_freq_w;
               float k = static_cast<float>(i);     
@@ -509,7 +571,7 @@ rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &Weigh
      //CON and therefore there will be only contributions to one direct sinogram and the weights are therefore always 1. 
     
        for (int j = 0; j < wmin; j++){
-         for (int i = 0; i <= num_views_pow2/2; i++) {
+         for (int i = min_k; i <= std::min(num_views_pow2/2, max_k); i++) {
 	 
 	       for(int shift_direction=POSITIVE_Z_SHIFT;shift_direction<=NEGATIVE_Z_SHIFT;shift_direction+=CHANGE_Z_SHIFT){
 
@@ -535,7 +597,7 @@ rebinning(Array<3,std::complex<float> > &FT_rebinned_data, Array<3,float> &Weigh
 //CL Small k :
 //CL Next treat small k's and w=wNyq=(num_tang_poss_pow2 / 2)+1, k=1..klim :
        for (int j = wmin; j <= num_tang_poss_pow2/2; j++) {
-         for (int i = 0; i <= kmin; i++) {
+         for (int i = min_k; i <= std::min(kmin, max_k); i++) {
           
                for(int shift_direction=POSITIVE_Z_SHIFT;shift_direction<=NEGATIVE_Z_SHIFT;shift_direction+=CHANGE_Z_SHIFT){
 
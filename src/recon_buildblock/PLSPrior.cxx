@@ -36,12 +36,10 @@
 #include "stir/is_null_ptr.h"
 #include "stir/info.h"
 #include <algorithm>
+#include <vector>
 using std::min;
 using std::max;
 
-/* Pretty horrible code because we don't have an iterator of neigbhourhoods yet
- */
-
 START_NAMESPACE_STIR
 
 template <typename elemT>
@@ -288,55 +286,64 @@ template <typename elemT> void PLSPrior<elemT>::set_anatomical_filename(const st
   info(boost::format("Reading anatomical data '%1%'") % anatomical_filename  );
 }
 
+/* compute (pet_im_grad - anatomical_grad * inner_product/norm)/penalty for one voxel
+   (used for the gradient of the prior)
+*/
 template <typename elemT>
-void PLSPrior<elemT>::compute_image_gradient_element(DiscretisedDensity<3,elemT> & image_gradient_elem, int direction, const DiscretisedDensity<3,elemT> & image ){
-//std::cout<<"dentro ="<<direction<<std::endl;
-
-    const int min_z = image.get_min_index();
-    const int max_z = image.get_max_index();
-
-
-        for (int z=min_z; z<=max_z; z++)
-          {
-
-            const int min_y = image[z].get_min_index();
-            const int max_y = image[z].get_max_index();
-
-
-
-              for (int y=min_y;y<= max_y;y++)
-                {
-
-                  const int min_x = image[z][y].get_min_index();
-                  const int max_x = image[z][y].get_max_index();
-
-
+static inline elemT
+PLS_gradient_term(const DiscretisedDensity<3,elemT>& pet_im_grad,
+                  const DiscretisedDensity<3,elemT>& anatomical_grad,
+                  const DiscretisedDensity<3,elemT>& inner_product,
+                  const DiscretisedDensity<3,elemT>& norm,
+                  const DiscretisedDensity<3,elemT>& penalty,
+                  const int z, const int y, const int x)
+{
+  return (pet_im_grad[z][y][x]-anatomical_grad[z][y][x]*inner_product[z][y][x]/norm[z][y][x])/
+    penalty[z][y][x];
+}
 
-                    for (int x=min_x;x<= max_x;x++)
-                    {
+template <typename elemT>
+void PLSPrior<elemT>::compute_image_gradient_element(DiscretisedDensity<3,elemT> & image_gradient_elem, int direction, const DiscretisedDensity<3,elemT> & image ){
 
-                        if(direction==0){
-                            if(z+1>max_z)
-                                continue;
-                       image_gradient_elem[z][y][x]=image[z+1][y][x]- image[z][y][x];
+  const int min_z = image.get_min_index();
+  const int max_z = image.get_max_index();
 
-                        }
-                        if(direction==1){
-                            if(y+1>max_y)
-                                continue;
-                       image_gradient_elem[z][y][x]=image[z][y+1][x]- image[z][y][x];
-//                       std::cout<<"grady ="<<image[z][y+1][x]- image[z][y][x]<<std::endl;
-                        }
-                        if(direction==2){
-                            if(x+1>max_x )
-                                continue;
-                       image_gradient_elem[z][y][x]=image[z][y][x+1]- image[z][y][x];
-                        }
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_y = image[z].get_min_index();
+      const int max_y = image[z].get_max_index();
 
-                    }
-                 }
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_x = image[z][y].get_min_index();
+          const int max_x = image[z][y].get_max_index();
+          const Array<1,elemT>& row = image[z][y];
+          Array<1,elemT>& gradient_row = image_gradient_elem[z][y];
+
+          // note: the last element in the direction of the gradient is not set
+          if(direction==0){
+            if(z+1>max_z)
+              continue;
+            const Array<1,elemT>& next_row = image[z+1][y];
+            for (int x=min_x;x<= max_x;x++)
+              gradient_row[x]=next_row[x]- row[x];
           }
-
+          if(direction==1){
+            if(y+1>max_y)
+              continue;
+            const Array<1,elemT>& next_row = image[z][y+1];
+            for (int x=min_x;x<= max_x;x++)
+              gradient_row[x]=next_row[x]- row[x];
+          }
+          if(direction==2){
+            for (int x=min_x;x< max_x;x++)
+              gradient_row[x]=row[x+1]- row[x];
+          }
+        }
+    }
 }
 
 template <typename elemT>
@@ -346,39 +353,37 @@ PLSPrior<elemT>::compute_normalisation_anatomical_gradient(DiscretisedDensity<3,
                                           const DiscretisedDensity<3,elemT> &image_grad_y,
                                           const DiscretisedDensity<3,elemT> &image_grad_x){
 
-    const int min_z = image_grad_x.get_min_index();
-    const int max_z = image_grad_x.get_max_index();
-
+  const int min_z = image_grad_x.get_min_index();
+  const int max_z = image_grad_x.get_max_index();
 
-        for (int z=min_z; z<=max_z; z++)
-          {
-
-            const int min_y = image_grad_x[z].get_min_index();
-            const int max_y = image_grad_x[z].get_max_index();
-
-
-
-              for (int y=min_y;y<= max_y;y++)
-                {
-
-                  const int min_x = image_grad_x[z][y].get_min_index();
-                  const int max_x = image_grad_x[z][y].get_max_index();
-
-
-
-                    for (int x=min_x;x<= max_x;x++)
-                    {
-                        if(only_2D){
-                     norm_im_grad[z][y][x]   = sqrt (square(image_grad_y[z][y][x]) + square(image_grad_x[z][y][x]) + square(this->eta));}
-                        else{
-                            norm_im_grad[z][y][x]   = sqrt (square(image_grad_z[z][y][x]) + square(image_grad_y[z][y][x]) +
-                                                            square(image_grad_x[z][y][x]) + square(this->eta));
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_y = image_grad_x[z].get_min_index();
+      const int max_y = image_grad_x[z].get_max_index();
 
-                        }
-                    }
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_x = image_grad_x[z][y].get_min_index();
+          const int max_x = image_grad_x[z][y].get_max_index();
+          const Array<1,elemT>& grad_y_row = image_grad_y[z][y];
+          const Array<1,elemT>& grad_x_row = image_grad_x[z][y];
+          Array<1,elemT>& norm_row = norm_im_grad[z][y];
 
-                 }
+          if(only_2D){
+            for (int x=min_x;x<= max_x;x++)
+              norm_row[x] = sqrt (square(grad_y_row[x]) + square(grad_x_row[x]) + square(this->eta));
           }
+          else{
+            const Array<1,elemT>& grad_z_row = image_grad_z[z][y];
+            for (int x=min_x;x<= max_x;x++)
+              norm_row[x] = sqrt (square(grad_z_row[x]) + square(grad_y_row[x]) +
+                                  square(grad_x_row[x]) + square(this->eta));
+          }
+        }
+    }
 }
 
 template <typename elemT>
@@ -391,59 +396,68 @@ compute_inner_product_and_penalty(DiscretisedDensity<3,elemT> &inner_product,
                                   DiscretisedDensity<3,elemT> &pet_im_grad_x,
                       const DiscretisedDensity<3,elemT> &pet_image){
 
-
-
-    if(!only_2D)
+  if(!only_2D)
     compute_image_gradient_element (pet_im_grad_z,0,pet_image);
 
-    compute_image_gradient_element (pet_im_grad_y,1,pet_image);
-    compute_image_gradient_element (pet_im_grad_x,2,pet_image);
-
-
-    const int min_z = pet_image.get_min_index();
-    const int max_z = pet_image.get_max_index();
+  compute_image_gradient_element (pet_im_grad_y,1,pet_image);
+  compute_image_gradient_element (pet_im_grad_x,2,pet_image);
 
+  // get references outside of the loop to avoid copying shared_ptrs for every voxel
+  const DiscretisedDensity<3,elemT>& norm = *this->get_norm_sptr();
+  const DiscretisedDensity<3,elemT>& anatomical_grad_y = *this->anatomical_grad_y_sptr;
+  const DiscretisedDensity<3,elemT>& anatomical_grad_x = *this->anatomical_grad_x_sptr;
 
-        for (int z=min_z; z<=max_z; z++)
-          {
-
-            const int min_y = pet_image[z].get_min_index();
-            const int max_y = pet_image[z].get_max_index();
-
+  const int min_z = pet_image.get_min_index();
+  const int max_z = pet_image.get_max_index();
 
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_y = pet_image[z].get_min_index();
+      const int max_y = pet_image[z].get_max_index();
 
-              for (int y=min_y;y<= max_y;y++)
-                {
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_x = pet_image[z][y].get_min_index();
+          const int max_x = pet_image[z][y].get_max_index();
+          const Array<1,elemT>& norm_row = norm[z][y];
+          const Array<1,elemT>& pet_grad_y_row = pet_im_grad_y[z][y];
+          const Array<1,elemT>& pet_grad_x_row = pet_im_grad_x[z][y];
+          const Array<1,elemT>& anatomical_grad_y_row = anatomical_grad_y[z][y];
+          const Array<1,elemT>& anatomical_grad_x_row = anatomical_grad_x[z][y];
+          Array<1,elemT>& inner_product_row = inner_product[z][y];
+          Array<1,elemT>& penalty_row = penalty[z][y];
+
+          if(only_2D){
+            for (int x=min_x;x<= max_x;x++)
+              {
+                inner_product_row[x]   = ((pet_grad_y_row[x]*anatomical_grad_y_row[x]/norm_row[x]) +
+                                          (pet_grad_x_row[x]*anatomical_grad_x_row[x]/norm_row[x]));
 
-                  const int min_x = pet_image[z][y].get_min_index();
-                  const int max_x = pet_image[z][y].get_max_index();
-
-
-
-                    for (int x=min_x;x<= max_x;x++)
-                    {
-                        if(only_2D){
-                            inner_product[z][y][x]   = ((pet_im_grad_y[z][y][x]*(*anatomical_grad_y_sptr)[z][y][x]/(*get_norm_sptr())[z][y][x]) +
-                                                        (pet_im_grad_x[z][y][x]*(*anatomical_grad_x_sptr)[z][y][x]/(*get_norm_sptr())[z][y][x]));
-
-                            penalty[z][y][x]= sqrt (square(this->alpha) + square(pet_im_grad_y[z][y][x]) +
-                                                                              square(pet_im_grad_x[z][y][x]) -
-                                                                              square(inner_product[z][y][x]));
-                        }
-                        else{
-                     inner_product[z][y][x]   = (pet_im_grad_z[z][y][x]*(*anatomical_grad_z_sptr)[z][y][x] +
-                                                 pet_im_grad_y[z][y][x]*(*anatomical_grad_y_sptr)[z][y][x] +
-                                                 pet_im_grad_x[z][y][x]*(*anatomical_grad_x_sptr)[z][y][x])/(*get_norm_sptr())[z][y][x];
-
-                     penalty[z][y][x]= sqrt (square(this->alpha) + square(pet_im_grad_z[z][y][x]) +
-                                                                       square(pet_im_grad_y[z][y][x]) +
-                                                                       square(pet_im_grad_x[z][y][x]) -
-                                                                       square(inner_product[z][y][x]));
-                        }
-                    }
-                 }
+                penalty_row[x]= sqrt (square(this->alpha) + square(pet_grad_y_row[x]) +
+                                      square(pet_grad_x_row[x]) -
+                                      square(inner_product_row[x]));
+              }
           }
-
+          else{
+            const Array<1,elemT>& pet_grad_z_row = pet_im_grad_z[z][y];
+            const Array<1,elemT>& anatomical_grad_z_row = (*this->anatomical_grad_z_sptr)[z][y];
+            for (int x=min_x;x<= max_x;x++)
+              {
+                inner_product_row[x]   = (pet_grad_z_row[x]*anatomical_grad_z_row[x] +
+                                          pet_grad_y_row[x]*anatomical_grad_y_row[x] +
+                                          pet_grad_x_row[x]*anatomical_grad_x_row[x])/norm_row[x];
+
+                penalty_row[x]= sqrt (square(this->alpha) + square(pet_grad_z_row[x]) +
+                                      square(pet_grad_y_row[x]) +
+                                      square(pet_grad_x_row[x]) -
+                                      square(inner_product_row[x]));
+              }
+          }
+        }
+    }
 }
 
 template <typename elemT>
@@ -481,41 +495,51 @@ compute_value(const DiscretisedDensity<3,elemT> &current_image_estimate)
     error("PLSPrior: kappa image has not the same index range as the reconstructed image\n");
 
 
-  double result = 0.;
+  /* formula:
+     sum_x,y,z
+      (penalty[z][y][x]) * (*kappa_ptr)[z][y][x];
+  */
   const int min_z = current_image_estimate.get_min_index();
   const int max_z = current_image_estimate.get_max_index();
+  // sum every plane separately such that the result does not depend on the number of threads
+  std::vector<double> plane_values(max_z - min_z + 1, 0.);
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
   for (int z=min_z; z<=max_z; z++)
     {
-
       const int min_y = current_image_estimate[z].get_min_index();
       const int max_y = current_image_estimate[z].get_max_index();
+      double plane_value = 0.;
 
-        for (int y=min_y;y<= max_y;y++)
-          {
-
-            const int min_x = current_image_estimate[z][y].get_min_index();
-            const int max_x = current_image_estimate[z][y].get_max_index();
-
-            for (int x=min_x;x<= max_x;x++)
-              {
-
-                /* formula:
-                  sum_x,y,z
-
-                   (penalty[z][y][x]) * (*kappa_ptr)[z][y][x];
-                */
-
-                        elemT current = (*penalty_sptr)[z][y][x];
-
-                        if (do_kappa)
-                          current *=
-                            (*kappa_ptr)[z][y][x] ;
-
-                        result += static_cast<double>(current);
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_x = current_image_estimate[z][y].get_min_index();
+          const int max_x = current_image_estimate[z][y].get_max_index();
+          const Array<1,elemT>& penalty_row = (*penalty_sptr)[z][y];
 
-              }
-          }
+          if (do_kappa)
+            {
+              const Array<1,elemT>& kappa_row = (*kappa_ptr)[z][y];
+              for (int x=min_x;x<= max_x;x++)
+                {
+                  elemT current = penalty_row[x];
+                  current *= kappa_row[x];
+                  plane_value += static_cast<double>(current);
+                }
+            }
+          else
+            {
+              for (int x=min_x;x<= max_x;x++)
+                plane_value += static_cast<double>(penalty_row[x]);
+            }
+        }
+      plane_values[z-min_z] = plane_value;
     }
+
+  double result = 0.;
+  for (std::vector<double>::const_iterator iter = plane_values.begin(); iter != plane_values.end(); ++iter)
+    result += *iter;
   return result * this->penalisation_factor;
 }
 
@@ -563,103 +587,87 @@ compute_gradient(DiscretisedDensity<3,elemT>& prior_gradient,
     error("PLSPrior: kappa image has not the same index range as the reconstructed image\n");
  shared_ptr<DiscretisedDensity<3,elemT> > gradient_sptr(this->anatomical_sptr->get_empty_copy ());
 
+  // get references outside of the loop to avoid copying shared_ptrs for every voxel
+  const DiscretisedDensity<3,elemT>& norm = *this->get_norm_sptr();
+  const DiscretisedDensity<3,elemT>& inner_product = *inner_product_sptr;
+  const DiscretisedDensity<3,elemT>& penalty = *penalty_sptr;
+
   const int min_z = current_image_estimate.get_min_index();
   const int max_z = current_image_estimate.get_max_index();
 
+  /* formula:
+     sum_x,y,z
+      div * (pet_im_grad[z][y][x]-inner_product[z][y][x]*anatomical_im_grad[z][y][x]/(*get_norm_sptr ())[z][y][x])*
+      (*kappa_ptr)[z][y][x] /penalty[z][y][x];
+
+     Note: iteration z only writes in planes z (x and y) and z+1 (z), so the loop over z can be
+     done in parallel.
+  */
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
   for (int z=min_z; z<=max_z; z++)
     {
-
       const int min_y = current_image_estimate[z].get_min_index();
       const int max_y = current_image_estimate[z].get_max_index();
 
       for (int y=min_y;y<= max_y;y++)
         {
-
-
           const int min_x = current_image_estimate[z][y].get_min_index();
           const int max_x = current_image_estimate[z][y].get_max_index();
 
-          for (int x=min_x;x<= max_x;x++)
-            {
-
-              if(x+1>max_x || y+1>max_y ||(z+1>max_z && !only_2D))
-                  continue;
+          if(y+1>max_y ||(z+1>max_z && !only_2D))
+            continue;
 
-                /* formula:
-                  sum_x,y,z
-                   div * (pet_im_grad[z][y][x]-inner_product[z][y][x]*anatomical_im_grad[z][y][x]/(*get_norm_sptr ())[z][y][x])*
-                   (*kappa_ptr)[z][y][x] /penalty[z][y][x];
-                */
-
-              if(only_2D){
-                  (*gradientx_sptr)[z][y][x+1] =
-                     (((*pet_im_grad_x_sptr)[z][y][x+1]-(*anatomical_grad_x_sptr)[z][y][x+1]*(*inner_product_sptr)[z][y][x+1]/
-                          (*get_norm_sptr ())[z][y][x+1])/(*penalty_sptr)[z][y][x+1] -
-                     (((*pet_im_grad_x_sptr)[z][y][x]-(*anatomical_grad_x_sptr)[z][y][x]*(*inner_product_sptr)[z][y][x]/(*get_norm_sptr ())[z][y][x])/
-                      (*penalty_sptr)[z][y][x]) );
-
-                  (*gradienty_sptr)[z][y+1][x] =
-                      (((*pet_im_grad_y_sptr)[z][y+1][x]-(*anatomical_grad_y_sptr)[z][y+1][x]*(*inner_product_sptr)[z][y+1][x]/
-                          (*get_norm_sptr ())[z][y+1][x])/(*penalty_sptr)[z][y+1][x] -
-                      (((*pet_im_grad_y_sptr)[z][y][x]-(*anatomical_grad_y_sptr)[z][y][x]*(*inner_product_sptr)[z][y][x]/(*get_norm_sptr ())[z][y][x])/
-                       (*penalty_sptr)[z][y][x]) );
-              }
-              else{
-
-                  (*gradientx_sptr)[z][y][x+1] =
-                          (((*pet_im_grad_x_sptr)[z][y][x+1]-(*anatomical_grad_x_sptr)[z][y][x+1]*(*inner_product_sptr)[z][y][x+1]/(*get_norm_sptr ())[z][y][x+1])/
-                          (*penalty_sptr)[z][y][x+1] -
-                          ((*pet_im_grad_x_sptr)[z][y][x]-(*anatomical_grad_x_sptr)[z][y][x]*(*inner_product_sptr)[z][y][x]/(*get_norm_sptr ())[z][y][x])/
-                          (*penalty_sptr)[z][y][x]);
-
-                  (*gradienty_sptr)[z][y+1][x] =
-                          (((*pet_im_grad_y_sptr)[z][y+1][x]-(*anatomical_grad_y_sptr)[z][y+1][x]*(*inner_product_sptr)[z][y+1][x]/
-                          (*get_norm_sptr ())[z][y+1][x])/(*penalty_sptr)[z][y+1][x] -
-                          (((*pet_im_grad_y_sptr)[z][y][x]-(*anatomical_grad_y_sptr)[z][y][x]*(*inner_product_sptr)[z][y][x]/
-                            (*get_norm_sptr ())[z][y][x])/(*penalty_sptr)[z][y][x]) );
-
-                  (*gradientz_sptr)[z+1][y][x] =
-                      (((*pet_im_grad_z_sptr)[z+1][y][x]-(*anatomical_grad_z_sptr)[z+1][y][x]*(*inner_product_sptr)[z+1][y][x]/
-                          (*get_norm_sptr ())[z+1][y][x])/(*penalty_sptr)[z+1][y][x] -
-                          (((*pet_im_grad_z_sptr)[z][y][x]-(*anatomical_grad_z_sptr)[z][y][x]*(*inner_product_sptr)[z][y][x]/
-                            (*get_norm_sptr ())[z][y][x])/(*penalty_sptr)[z][y][x]) );
+          for (int x=min_x;x< max_x;x++)
+            {
+              (*gradientx_sptr)[z][y][x+1] =
+                PLS_gradient_term(*pet_im_grad_x_sptr, *anatomical_grad_x_sptr, inner_product, norm, penalty, z, y, x+1) -
+                PLS_gradient_term(*pet_im_grad_x_sptr, *anatomical_grad_x_sptr, inner_product, norm, penalty, z, y, x);
+
+              (*gradienty_sptr)[z][y+1][x] =
+                PLS_gradient_term(*pet_im_grad_y_sptr, *anatomical_grad_y_sptr, inner_product, norm, penalty, z, y+1, x) -
+                PLS_gradient_term(*pet_im_grad_y_sptr, *anatomical_grad_y_sptr, inner_product, norm, penalty, z, y, x);
+
+              if(!only_2D){
+                (*gradientz_sptr)[z+1][y][x] =
+                  PLS_gradient_term(*pet_im_grad_z_sptr, *anatomical_grad_z_sptr, inner_product, norm, penalty, z+1, y, x) -
+                  PLS_gradient_term(*pet_im_grad_z_sptr, *anatomical_grad_z_sptr, inner_product, norm, penalty, z, y, x);
               }
-              }}}
+            }
+        }
+    }
 
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
   for (int z=min_z; z<=max_z; z++)
     {
-
       const int min_y = current_image_estimate[z].get_min_index();
       const int max_y = current_image_estimate[z].get_max_index();
 
       for (int y=min_y;y<= max_y;y++)
         {
-
-
           const int min_x = current_image_estimate[z][y].get_min_index();
           const int max_x = current_image_estimate[z][y].get_max_index();
+          Array<1,elemT>& gradient_row = (*gradient_sptr)[z][y];
 
           for (int x=min_x;x<= max_x;x++)
             {
               if(only_2D){
-
-              (*gradient_sptr)[z][y][x] = -((*gradienty_sptr)[z][y][x] + (*gradientx_sptr)[z][y][x]);
-
+                gradient_row[x] = -((*gradienty_sptr)[z][y][x] + (*gradientx_sptr)[z][y][x]);
               }
               else{
-
-              (*gradient_sptr)[z][y][x] = -((*gradientz_sptr)[z][y][x] + (*gradienty_sptr)[z][y][x] + (*gradientx_sptr)[z][y][x]);
-
+                gradient_row[x] = -((*gradientz_sptr)[z][y][x] + (*gradienty_sptr)[z][y][x] + (*gradientx_sptr)[z][y][x]);
               }
 
               if (do_kappa)
-                  (*gradient_sptr)[z][y][x] *=
-                  (*kappa_ptr)[z][y][x] ;
+                gradient_row[x] *= (*kappa_ptr)[z][y][x] ;
 
-
-
-                        prior_gradient[z][y][x]= (*gradient_sptr)[z][y][x] * this->penalisation_factor;
-            }}}
+              prior_gradient[z][y][x]= gradient_row[x] * this->penalisation_factor;
+            }
+        }
+    }
 
   info(boost::format("Prior gradient max %1%, min %2%\n") % prior_gradient.find_max() % prior_gradient.find_min());
 
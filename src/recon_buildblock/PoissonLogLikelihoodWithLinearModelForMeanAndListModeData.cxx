@@ -144,12 +144,13 @@ Succeeded
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeData<TargetT>::
 set_up(shared_ptr <TargetT > const& target_sptr)
 {
-  if ( base_type::set_up(target_sptr) != Succeeded::yes)
-    return Succeeded::no;
-
   // handle time frame definitions etc
+  // (needs to be done before calling set_up_before_sensitivity(), as derived classes might read events)
     if(this->num_events_to_use==0 && this->frame_defs_filename.size() == 0)
       do_time_frame = true;
+
+  if ( base_type::set_up(target_sptr) != Succeeded::yes)
+    return Succeeded::no;
  
     return Succeeded::yes;
 }
@@ -32,6 +32,7 @@
 #include "stir/ProjDataInfoCylindricalNoArcCorr.h"
 #include "stir/ProjData.h"
 #include "stir/listmode/ListRecord.h"
+#include "stir/listmode/ListModeDataReadAhead.h"
 #include "stir/Viewgram.h"
 #include "stir/info.h"
 #include <boost/format.hpp>
@@ -45,6 +46,7 @@
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <limits>
 #include "stir/stream.h"
 
 #include "stir/recon_buildblock/ForwardProjectorByBinUsingProjMatrixByBin.h"
@@ -55,11 +57,56 @@
 #ifdef STIR_MPI
 #include "stir/recon_buildblock/distributed_functions.h"
 #endif
+#ifdef STIR_OPENMP
+#include <omp.h>
+#endif
 
 
 #include <vector>
 START_NAMESPACE_STIR
 
+namespace {
+  // helper class to get records one by one, either directly from the list mode data,
+  // or via ListModeDataReadAhead
+  class RecordReader
+  {
+  public:
+    RecordReader(const shared_ptr<ListModeData>& lm_data_sptr, const bool read_ahead)
+      : lm_data_sptr(lm_data_sptr),
+        num_records_in_batch(0), current_record_num(0)
+    {
+      if (read_ahead)
+        read_ahead_sptr.reset(new ListModeDataReadAhead(lm_data_sptr));
+      else
+        record_sptr = lm_data_sptr->get_empty_record_sptr();
+    }
+
+    //! return the next record (or 0 at the end of the data)
+    const ListRecord* get_next_record()
+    {
+      if (is_null_ptr(read_ahead_sptr))
+        return lm_data_sptr->get_next_record(*record_sptr) == Succeeded::yes ? record_sptr.get() : 0;
+
+      if (current_record_num == num_records_in_batch)
+        {
+          num_records_in_batch = read_ahead_sptr->get_next_records(records);
+          current_record_num = 0;
+          if (num_records_in_batch == 0)
+            return 0;
+        }
+      return records[current_record_num++].get();
+    }
+
+  private:
+    shared_ptr<ListModeData> lm_data_sptr;
+    shared_ptr<ListRecord> record_sptr;
+    shared_ptr<ListModeDataReadAhead> read_ahead_sptr;
+    ListModeDataReadAhead::RecordBatch records;
+    std::size_t num_records_in_batch;
+    std::size_t current_record_num;
+  };
+}
+
 template<typename TargetT>
 const char * const 
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
@@ -86,6 +133,11 @@ set_defaults()
 
   this->normalisation_sptr.reset(new TrivialBinNormalisation);
   this->do_time_frame = false;
+  this->num_events_per_batch = 100000;
+  this->cache_lm_events = false;
+  this->read_ahead = false;
+  this->event_cache.clear();
+  this->event_cache_frame_num = 0;
 } 
  
 template <typename TargetT> 
@@ -101,6 +153,9 @@ initialise_keymap()
   this->parser.add_key("additive sinogram",&this->additive_projection_data_filename);
  
   this->parser.add_key("num_events_to_use",&this->num_events_to_use);
+  this->parser.add_key("num_events_per_batch",&this->num_events_per_batch);
+  this->parser.add_key("cache list mode events",&this->cache_lm_events);
+  this->parser.add_key("read list mode data in background thread",&this->read_ahead);
 
 } 
 template <typename TargetT> 
@@ -202,6 +257,18 @@ set_up_before_sensitivity(shared_ptr <const TargetT > const& target_sptr)
                 new ProjectorByBinPairUsingProjMatrixByBin(this->PM_sptr));
     this->projector_pair_sptr->set_up(proj_data_info_sptr->create_shared_clone(),target_sptr);
 
+    // additive data might have been set via set_additive_proj_data_sptr(), make sure it's in memory
+    {
+      const shared_ptr<ProjData> set_additive_proj_data_sptr =
+        PoissonLogLikelihoodWithLinearModelForMeanAndListModeData<TargetT>::additive_proj_data_sptr;
+      if (!is_null_ptr(set_additive_proj_data_sptr))
+        {
+          this->additive_proj_data_sptr = dynamic_pointer_cast<ProjDataInMemory>(set_additive_proj_data_sptr);
+          if (is_null_ptr(this->additive_proj_data_sptr))
+            this->additive_proj_data_sptr.reset(new ProjDataInMemory(*set_additive_proj_data_sptr));
+        }
+    }
+
     if (is_null_ptr(this->normalisation_sptr))
     {
         warning("Invalid normalisation object");
@@ -225,6 +292,9 @@ set_up_before_sensitivity(shared_ptr <const TargetT > const& target_sptr)
             return Succeeded::no;
         }
 
+    if (this->cache_lm_events)
+      this->cache_events();
+
     return Succeeded::yes;
 } 
  
@@ -242,6 +312,9 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
     { warning("You need to specify a projection matrix"); return true; } 
 
+  if (this->num_events_per_batch == 0)
+    { warning("num_events_per_batch should be at least 1"); return true; }
+
 #else
   if(is_null_ptr(this->projector_pair_sptr->get_forward_projector_sptr()))
     {
@@ -408,6 +481,133 @@ construct_target_ptr() const
    this->target_parameter_parser.create(this->get_input_data());
 } 
  
+template <typename TargetT>
+bool
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
+get_bin_and_subset_for_event(Bin& measured_bin, int& subset_num, const ListEvent& event) const
+{
+  measured_bin.set_bin_value(1.0f);
+  event.get_bin(measured_bin, *proj_data_info_sptr);
+
+  if (measured_bin.get_bin_value() != 1.0f
+      || measured_bin.segment_num() < proj_data_info_sptr->get_min_segment_num()
+      || measured_bin.segment_num()  > proj_data_info_sptr->get_max_segment_num()
+      || measured_bin.tangential_pos_num() < proj_data_info_sptr->get_min_tangential_pos_num()
+      || measured_bin.tangential_pos_num() > proj_data_info_sptr->get_max_tangential_pos_num()
+      || measured_bin.axial_pos_num() < proj_data_info_sptr->get_min_axial_pos_num(measured_bin.segment_num())
+      || measured_bin.axial_pos_num() > proj_data_info_sptr->get_max_axial_pos_num(measured_bin.segment_num()))
+    {
+      return false;
+    }
+
+  measured_bin.set_bin_value(1.0f);
+  // find the subset the bin belongs to
+  if (this->num_subsets > 1)
+    {
+      Bin basic_bin = measured_bin;
+      this->PM_sptr->get_symmetries_ptr()->find_basic_bin(basic_bin);
+      subset_num = static_cast<int>(basic_bin.view_num() % this->num_subsets);
+    }
+  else
+    subset_num = 0;
+  return true;
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
+cache_events()
+{
+  info(boost::format("Caching list mode events of time frame %1% for %2% subsets")
+       % this->current_frame_num % this->num_subsets);
+
+  // check if all bins fit in the compact storage
+  {
+    const int max_allowed = std::numeric_limits<boost::int16_t>::max();
+    const int min_allowed = std::numeric_limits<boost::int16_t>::min();
+    bool ok =
+      proj_data_info_sptr->get_min_segment_num() >= min_allowed &&
+      proj_data_info_sptr->get_max_segment_num() <= max_allowed &&
+      proj_data_info_sptr->get_min_view_num() >= min_allowed &&
+      proj_data_info_sptr->get_max_view_num() <= max_allowed &&
+      proj_data_info_sptr->get_min_tangential_pos_num() >= min_allowed &&
+      proj_data_info_sptr->get_max_tangential_pos_num() <= max_allowed;
+    for (int segment_num=proj_data_info_sptr->get_min_segment_num();
+         ok && segment_num<=proj_data_info_sptr->get_max_segment_num();
+         ++segment_num)
+      ok =
+        proj_data_info_sptr->get_min_axial_pos_num(segment_num) >= min_allowed &&
+        proj_data_info_sptr->get_max_axial_pos_num(segment_num) <= max_allowed;
+    if (!ok)
+      error("PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin: "
+            "projection data sizes are too large for caching the events");
+  }
+
+  const double start_time = this->frame_defs.get_start_time(this->current_frame_num);
+  const double end_time = this->frame_defs.get_end_time(this->current_frame_num);
+
+  this->event_cache.clear();
+  this->event_cache.resize(this->num_subsets);
+
+  // as in the non-cached case, num_events_to_use limits the number of events per subset
+  std::vector<long int> more_events(this->num_subsets,
+                                    this->do_time_frame? 1 : this->num_events_to_use);
+  int num_subsets_to_fill = this->num_subsets;
+  long num_cached_events = 0;
+
+  this->list_mode_data_sptr->reset();
+  double current_time = 0.;
+  RecordReader record_reader(this->list_mode_data_sptr, this->read_ahead);
+
+  while (num_subsets_to_fill>0)
+    {
+      const ListRecord * const record_ptr = record_reader.get_next_record();
+      if (record_ptr == 0)
+        {
+          info("End of file!");
+          break; //get out of while loop
+        }
+      const ListRecord& record = *record_ptr;
+
+      if(record.is_time() && end_time > 0.01)
+        {
+          current_time = record.time().get_time_in_secs();
+          if (this->do_time_frame && current_time >= end_time)
+            break; // get out of while loop
+          if (current_time < start_time)
+            continue;
+        }
+
+      if (record.is_event() && record.event().is_prompt())
+        {
+          Bin measured_bin;
+          int subset_num;
+          if (!this->get_bin_and_subset_for_event(measured_bin, subset_num, record.event()))
+            continue;
+          if (more_events[subset_num]==0)
+            continue;
+
+          this->event_cache[subset_num].push_back(this->make_cached_event(measured_bin));
+
+          if(!this->do_time_frame)
+            {
+              more_events[subset_num] -= 1;
+              if (more_events[subset_num]==0)
+                --num_subsets_to_fill;
+            }
+
+          num_cached_events += 1;
+
+          if (num_cached_events%2000000L==0)
+            info( boost::format("Cached Events: %1% ") % num_cached_events);
+        }
+    }
+
+  this->event_cache_frame_num = this->current_frame_num;
+  info(boost::format("Number of cached events: %1% (using %2% MB)")
+       % num_cached_events % (num_cached_events*sizeof(CachedEvent)/1000000));
+}
+
 template <typename TargetT> 
 void 
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>:: 
@@ -419,21 +619,39 @@ compute_sub_gradient_without_penalty_plus_sensitivity(TargetT& gradient,
     assert(subset_num>=0);
     assert(subset_num<this->num_subsets);
 
+    gradient.fill(0);
+    this->start_accumulating_events_in_new_gradient(gradient);
+
+    if (this->cache_lm_events)
+      {
+        if (this->event_cache_frame_num != this->current_frame_num ||
+            static_cast<int>(this->event_cache.size()) != this->num_subsets)
+          this->cache_events();
+
+        const std::vector<CachedEvent>& events = this->event_cache[subset_num];
+        for (std::size_t start=0; start<events.size(); start+=this->num_events_per_batch)
+          {
+            const std::size_t end = std::min(events.size(), start+this->num_events_per_batch);
+            this->add_events_to_gradient(gradient, current_estimate,
+                                         events.begin()+start, events.begin()+end);
+          }
+        this->finish_accumulating_events_in_gradient(gradient);
+        info(boost::format("Number of used events: %1%") % events.size());
+        return;
+      }
+
     const double start_time = this->frame_defs.get_start_time(this->current_frame_num);
     const double end_time = this->frame_defs.get_end_time(this->current_frame_num);
 
     long num_used_events = 0;
-    const float max_quotient = 10000.F;
 
     //go to the beginning of this frame
     //  list_mode_data_sptr->set_get_position(start_time);
     // TODO implement function that will do this for a random time
     this->list_mode_data_sptr->reset();
     double current_time = 0.;
-    ProjMatrixElemsForOneBin proj_matrix_row;
-    gradient.fill(0);
-    shared_ptr<ListRecord> record_sptr = this->list_mode_data_sptr->get_empty_record_sptr();
-    ListRecord& record = *record_sptr;
+
+    RecordReader record_reader(this->list_mode_data_sptr, this->read_ahead);
 
     VectorWithOffset<ListModeData::SavedPosition>
             frame_start_positions(1, static_cast<int>(this->frame_defs.get_num_frames()));
@@ -441,20 +659,36 @@ compute_sub_gradient_without_penalty_plus_sensitivity(TargetT& gradient,
     long int more_events =
             this->do_time_frame? 1 : this->num_events_to_use;
 
-    while (more_events)//this->list_mode_data_sptr->get_next_record(record) == Succeeded::yes)
+    // Events are decoded serially (the list mode data cannot be read in parallel),
+    // and collected in a batch. Every batch is then projected by all threads,
+    // see add_events_to_gradient().
+    std::vector<CachedEvent> event_batch;
+    event_batch.reserve(this->num_events_per_batch);
+    bool end_of_data = false;
+
+    while (more_events && !end_of_data)
     {
+      event_batch.clear();
+      while (more_events && event_batch.size() < this->num_events_per_batch)
+      {
 
-        if (this->list_mode_data_sptr->get_next_record(record) == Succeeded::no)
+        const ListRecord * const record_ptr = record_reader.get_next_record();
+        if (record_ptr == 0)
         {
             info("End of file!");
+            end_of_data = true;
             break; //get out of while loop
         }
+        const ListRecord& record = *record_ptr;
 
         if(record.is_time() && end_time > 0.01)
         {
             current_time = record.time().get_time_in_secs();
             if (this->do_time_frame && current_time >= end_time)
+            {
+                end_of_data = true;
                 break; // get out of while loop
+            }
             if (current_time < start_time)
                 continue;
         }
@@ -462,43 +696,14 @@ compute_sub_gradient_without_penalty_plus_sensitivity(TargetT& gradient,
         if (record.is_event() && record.event().is_prompt())
         {
             Bin measured_bin;
-            measured_bin.set_bin_value(1.0f);
-            record.event().get_bin(measured_bin, *proj_data_info_sptr);
-
-            if (measured_bin.get_bin_value() != 1.0f
-                    || measured_bin.segment_num() < proj_data_info_sptr->get_min_segment_num()
-                    || measured_bin.segment_num()  > proj_data_info_sptr->get_max_segment_num()
-                    || measured_bin.tangential_pos_num() < proj_data_info_sptr->get_min_tangential_pos_num()
-                    || measured_bin.tangential_pos_num() > proj_data_info_sptr->get_max_tangential_pos_num()
-                    || measured_bin.axial_pos_num() < proj_data_info_sptr->get_min_axial_pos_num(measured_bin.segment_num())
-                    || measured_bin.axial_pos_num() > proj_data_info_sptr->get_max_axial_pos_num(measured_bin.segment_num()))
-            {
+            int event_subset_num;
+            if (!this->get_bin_and_subset_for_event(measured_bin, event_subset_num, record.event()))
+                continue;
+            // check if the current bin belongs to the current subset
+            if (event_subset_num != subset_num)
                 continue;
-            }
 
-            measured_bin.set_bin_value(1.0f);
-            // If more than 1 subsets, check if the current bin belongs to
-            // the current.
-            if (this->num_subsets > 1)
-            {
-                Bin basic_bin = measured_bin;
-                this->PM_sptr->get_symmetries_ptr()->find_basic_bin(basic_bin);
-                if (subset_num != static_cast<int>(basic_bin.view_num() % this->num_subsets))
-                    continue;
-            }
-            this->PM_sptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, measured_bin);
-            //in_the_range++;
-            Bin fwd_bin;
-            fwd_bin.set_bin_value(0.0f);
-            proj_matrix_row.forward_project(fwd_bin,current_estimate);
-            // additive sinogram
-            if (!is_null_ptr(this->additive_proj_data_sptr))
-            {
-                float add_value = this->additive_proj_data_sptr->get_bin_value(measured_bin);
-                float value= fwd_bin.get_bin_value()+add_value;
-                fwd_bin.set_bin_value(value);
-            }
-            float  measured_div_fwd = 0.0f;
+            event_batch.push_back(this->make_cached_event(measured_bin));
 
             if(!this->do_time_frame)
                 more_events -=1 ;
@@ -507,20 +712,105 @@ compute_sub_gradient_without_penalty_plus_sensitivity(TargetT& gradient,
 
             if (num_used_events%200000L==0)
                 info( boost::format("Stored Events: %1% ") % num_used_events);
-
-            if ( measured_bin.get_bin_value() <= max_quotient *fwd_bin.get_bin_value())
-                measured_div_fwd = 1.0f /fwd_bin.get_bin_value();
-            else
-                continue;
-
-            measured_bin.set_bin_value(measured_div_fwd);
-            proj_matrix_row.back_project(gradient, measured_bin);
-
         }
+      }
+
+      this->add_events_to_gradient(gradient, current_estimate,
+                                   event_batch.begin(), event_batch.end());
     }
+
+    this->finish_accumulating_events_in_gradient(gradient);
     info(boost::format("Number of used events: %1%") % num_used_events);
 }
 
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
+start_accumulating_events_in_new_gradient(const TargetT& gradient)
+{
+#ifdef STIR_OPENMP
+  if (omp_get_num_threads()!=1)
+    error("PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin: "
+          "start_accumulating_events_in_new_gradient cannot be called inside a thread");
+
+  this->local_gradient_sptrs.resize(omp_get_max_threads());
+  for (int i=0; i<static_cast<int>(this->local_gradient_sptrs.size()); ++i)
+    if (!is_null_ptr(this->local_gradient_sptrs[i]))
+      {
+        if (this->local_gradient_sptrs[i]->has_same_characteristics(gradient))
+          this->local_gradient_sptrs[i]->fill(0.F);
+        else
+          this->local_gradient_sptrs[i].reset(); // will be reallocated by the thread when needed
+      }
+#endif
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
+add_events_to_gradient(TargetT& gradient,
+                       const TargetT& current_estimate,
+                       const typename std::vector<CachedEvent>::const_iterator events_begin,
+                       const typename std::vector<CachedEvent>::const_iterator events_end)
+{
+  const float max_quotient = 10000.F;
+
+#ifdef STIR_OPENMP
+#pragma omp parallel shared(gradient, current_estimate)
+#endif
+  {
+    TargetT* gradient_ptr = &gradient;
+#ifdef STIR_OPENMP
+    const int thread_num=omp_get_thread_num();
+    if (is_null_ptr(this->local_gradient_sptrs[thread_num]))
+      this->local_gradient_sptrs[thread_num].reset(gradient.get_empty_copy());
+    gradient_ptr = this->local_gradient_sptrs[thread_num].get();
+#endif
+    ProjMatrixElemsForOneBin proj_matrix_row;
+
+#ifdef STIR_OPENMP
+#pragma omp for schedule(runtime)
+#endif
+    // note: older versions of openmp need an int as loop
+    for (int i=0; i<static_cast<int>(events_end - events_begin); ++i)
+      {
+        Bin measured_bin = events_begin[i].get_bin();
+        this->PM_sptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, measured_bin);
+        Bin fwd_bin;
+        fwd_bin.set_bin_value(0.0f);
+        proj_matrix_row.forward_project(fwd_bin,current_estimate);
+        // additive sinogram (value was found when reading the event)
+        if (!is_null_ptr(this->additive_proj_data_sptr))
+          {
+            float value= fwd_bin.get_bin_value()+events_begin[i].additive_value;
+            fwd_bin.set_bin_value(value);
+          }
+
+        float  measured_div_fwd = 0.0f;
+        if ( measured_bin.get_bin_value() <= max_quotient *fwd_bin.get_bin_value())
+          measured_div_fwd = 1.0f /fwd_bin.get_bin_value();
+        else
+          continue;
+
+        measured_bin.set_bin_value(measured_div_fwd);
+        proj_matrix_row.back_project(*gradient_ptr, measured_bin);
+      }
+  }
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::
+finish_accumulating_events_in_gradient(TargetT& gradient)
+{
+#ifdef STIR_OPENMP
+  // "reduce" data constructed by threads
+  for (int i=0; i<static_cast<int>(this->local_gradient_sptrs.size()); ++i)
+    if (!is_null_ptr(this->local_gradient_sptrs[i])) // only accumulate if a thread filled something in
+      gradient += *(this->local_gradient_sptrs[i]);
+#endif
+}
+
 #  ifdef _MSC_VER
 // prevent warning message on instantiation of abstract class 
 #  pragma warning(disable:4661)
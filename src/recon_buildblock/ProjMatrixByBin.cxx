@@ -13,6 +13,7 @@
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000-2009, Hammersmith Imanet Ltd
     Copyright (C) 2013, 2015 University College London
+    Copyright (C) 2026, STIR developers
 
     This file is part of STIR.
 
@@ -32,6 +33,8 @@
 
 #include "stir/recon_buildblock/ProjMatrixByBin.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/error.h"
+#include "stir/warning.h"
 
 // define a local preprocessor symbol to keep code relatively clean
 #ifdef STIR_NO_MUTABLE
@@ -46,6 +49,7 @@ void ProjMatrixByBin::set_defaults()
 {
   cache_disabled=false;
   cache_stores_only_basic_bins=true;
+  cache_memory_limit_in_MB=0;
 }
 
 void 
@@ -53,15 +57,25 @@ ProjMatrixByBin::initialise_keymap()
 {
   parser.add_key("disable caching", &cache_disabled);
   parser.add_key("store_only_basic_bins_in_cache", &cache_stores_only_basic_bins);
+  parser.add_key("cache memory limit in MB", &cache_memory_limit_in_MB);
 }
 
 bool
 ProjMatrixByBin::post_processing()
 {
+  if (cache_memory_limit_in_MB < 0)
+    {
+      warning("ProjMatrixByBin: cache memory limit in MB should be non-negative");
+      return true;
+    }
   return false;
 }
 
 ProjMatrixByBin::ProjMatrixByBin()
+  : cache_memory_used_in_bytes(0),
+    cache_num_evictions(0),
+    clock_hand_view_num(0),
+    clock_hand_segment_num(0)
 { 
   set_defaults();
 }
@@ -86,6 +100,51 @@ ProjMatrixByBin::
 does_cache_store_only_basic_bins() const
 { return cache_stores_only_basic_bins; }
 
+void
+ProjMatrixByBin::
+set_cache_memory_limit_in_MB(const int limit)
+{
+  if (limit < 0)
+    error("ProjMatrixByBin::set_cache_memory_limit_in_MB: limit should be non-negative");
+  cache_memory_limit_in_MB = limit;
+}
+
+int
+ProjMatrixByBin::
+get_cache_memory_limit_in_MB() const
+{ return cache_memory_limit_in_MB; }
+
+ProjMatrixByBin::CacheStatistics
+ProjMatrixByBin::
+get_cache_statistics() const
+{
+  CacheStatistics statistics;
+  for (std::vector<CacheCounters>::const_iterator iter = this->cache_counters.begin();
+       iter != this->cache_counters.end();
+       ++iter)
+    {
+      statistics.num_hits += iter->num_hits.load(std::memory_order_relaxed);
+      statistics.num_misses += iter->num_misses.load(std::memory_order_relaxed);
+    }
+  statistics.num_evictions = this->cache_num_evictions.load();
+  statistics.memory_used_in_bytes = this->cache_memory_used_in_bytes.load();
+  return statistics;
+}
+
+void
+ProjMatrixByBin::
+reset_cache_statistics() STIR_MUTABLE_CONST
+{
+  for (std::vector<CacheCounters>::iterator iter = this->cache_counters.begin();
+       iter != this->cache_counters.end();
+       ++iter)
+    {
+      iter->num_hits.store(0, std::memory_order_relaxed);
+      iter->num_misses.store(0, std::memory_order_relaxed);
+    }
+  this->cache_num_evictions.store(0);
+}
+
 void 
 ProjMatrixByBin::
 clear_cache() STIR_MUTABLE_CONST
@@ -104,6 +163,7 @@ clear_cache() STIR_MUTABLE_CONST
           this->cache_collection[i][j].clear();
         }
     }
+  this->cache_memory_used_in_bytes.store(0);
 }
 
 /*
@@ -131,6 +191,14 @@ set_up(
 
   this->cache_collection.recycle();
   this->cache_collection.resize(min_view_num, max_view_num);
+  this->cache_memory_used_in_bytes.store(0);
+#ifdef STIR_OPENMP
+  this->cache_counters.resize(static_cast<std::size_t>(omp_get_max_threads()));
+#else
+  this->cache_counters.resize(1);
+#endif
+  this->clock_hand_view_num = min_view_num;
+  this->clock_hand_segment_num = min_segment_num;
 #ifdef STIR_OPENMP
   this->cache_locks.recycle();
   this->cache_locks.resize(min_view_num, max_view_num);
@@ -176,17 +244,111 @@ cache_proj_matrix_elems_for_one_bin(
   //std::cerr << "cached lor size " << probabilities.size() << " capacity " << probabilities.capacity() << std::endl;    
   // insert probabilities into the collection	
   const Bin bin = probabilities.get_bin();
+  const std::size_t element_size = cache_element_size_in_bytes(probabilities);
 #ifdef STIR_OPENMP
   omp_set_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
 #endif
-  cache_collection[bin.view_num()][bin.segment_num()].insert(MapProjMatrixElemsForOneBin::value_type( cache_key(bin), 
-                                                                                                      probabilities));  
+  const bool inserted =
+    cache_collection[bin.view_num()][bin.segment_num()].insert(MapProjMatrixElemsForOneBin::value_type( cache_key(bin), 
+                                                                                                            CachedProjMatrixElemsForOneBin(probabilities))).second;
 #ifdef STIR_OPENMP
   omp_unset_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
 #endif
+  if (!inserted) // another thread was quicker
+    return;
+
+  const std::size_t current_memory_used =
+    this->cache_memory_used_in_bytes.fetch_add(element_size) + element_size;
+
+  if (this->cache_memory_limit_in_MB > 0 &&
+      current_memory_used > static_cast<std::size_t>(this->cache_memory_limit_in_MB)*1000000U)
+    this->evict_from_cache();
+}
+
+std::size_t
+ProjMatrixByBin::
+cache_element_size_in_bytes(const ProjMatrixElemsForOneBin& elems)
+{
+  // element storage plus estimated overhead of the hash-map node
+  return
+    sizeof(CacheKey) + sizeof(CachedProjMatrixElemsForOneBin) + 2*sizeof(void *) +
+    elems.size()*sizeof(ProjMatrixElemsForOneBin::value_type);
+}
+
+void
+ProjMatrixByBin::
+evict_from_cache() STIR_MUTABLE_CONST
+{
+#ifdef STIR_OPENMP
+#pragma omp critical(PROJMATRIXBYBINEVICT)
+#endif
+  {
+    const std::size_t target_memory =
+      static_cast<std::size_t>(this->cache_memory_limit_in_MB)*900000U;
+    const int min_view_num = this->cache_collection.get_min_index();
+    const int max_view_num = this->cache_collection.get_max_index();
+    const int min_segment_num = this->cache_collection[min_view_num].get_min_index();
+    const int max_segment_num = this->cache_collection[min_view_num].get_max_index();
+    // we need at most 2 sweeps: the first one resets all 'recently used' flags
+    const int max_num_visits = 2*(max_view_num - min_view_num + 1)*(max_segment_num - min_segment_num + 1);
+
+    for (int num_visits=0;
+         this->cache_memory_used_in_bytes.load() > target_memory && num_visits < max_num_visits;
+         ++num_visits)
+      {
+        const int view_num = this->clock_hand_view_num;
+        const int segment_num = this->clock_hand_segment_num;
+        // advance clock hand
+        if (++this->clock_hand_segment_num > max_segment_num)
+          {
+            this->clock_hand_segment_num = min_segment_num;
+            if (++this->clock_hand_view_num > max_view_num)
+              this->clock_hand_view_num = min_view_num;
+          }
+
+        std::size_t memory_freed = 0;
+        unsigned long num_evicted = 0;
+#ifdef STIR_OPENMP
+        omp_set_lock(&this->cache_locks[view_num][segment_num]);
+#endif
+        MapProjMatrixElemsForOneBin& map = this->cache_collection[view_num][segment_num];
+        for (MapProjMatrixElemsForOneBinIterator iter = map.begin(); iter != map.end(); )
+          {
+            if (iter->second.recently_used.load(std::memory_order_relaxed))
+              {
+                // give it a second chance
+                iter->second.recently_used.store(false, std::memory_order_relaxed);
+                ++iter;
+              }
+            else
+              {
+                memory_freed += cache_element_size_in_bytes(iter->second.elems);
+                ++num_evicted;
+                iter = map.erase(iter);
+              }
+          }
+#ifdef STIR_OPENMP
+        omp_unset_lock(&this->cache_locks[view_num][segment_num]);
+#endif
+        this->cache_memory_used_in_bytes.fetch_sub(memory_freed);
+        this->cache_num_evictions.fetch_add(num_evicted);
+      }
+  }
 }
 
 
+ProjMatrixByBin::CacheCounters&
+ProjMatrixByBin::
+get_cache_counters_for_this_thread() const
+{
+#ifdef STIR_OPENMP
+  // there could be more threads than at set_up (e.g. nested parallelism), so these share counters
+  return this->cache_counters[static_cast<std::size_t>(omp_get_thread_num()) % this->cache_counters.size()];
+#else
+  return this->cache_counters[0];
+#endif
+}
+
 Succeeded 
 ProjMatrixByBin::
 get_cached_proj_matrix_elems_for_one_bin(
@@ -212,13 +374,17 @@ get_cached_proj_matrix_elems_for_one_bin(
 #endif
 
   {
+    const MapProjMatrixElemsForOneBin& map = cache_collection[bin.view_num()][bin.segment_num()];
     const_MapProjMatrixElemsForOneBinIterator pos = 
-      cache_collection[bin.view_num()][bin.segment_num()].find(cache_key( bin));
+      map.find(cache_key( bin));
   
-    if ( pos != cache_collection[bin.view_num()][bin.segment_num()]. end())
+    if ( pos != map.end())
       { 
 	//cout << Key << " =========>> entry found in cache " <<  endl;
-	probabilities = pos->second;
+	probabilities = pos->second.elems;
+        // only write when needed, such that hits do not make cache lines bounce between threads
+        if (!pos->second.recently_used.load(std::memory_order_relaxed))
+          pos->second.recently_used.store(true, std::memory_order_relaxed);
 	// note: cannot return from inside an OPENMP critical section
 	//return Succeeded::yes;	
 	found=true;
@@ -227,10 +393,15 @@ get_cached_proj_matrix_elems_for_one_bin(
 #ifdef STIR_OPENMP
   omp_unset_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
 #endif
+  CacheCounters& counters = this->get_cache_counters_for_this_thread();
   if (found)
-    return Succeeded::yes;	
+    {
+      counters.num_hits.fetch_add(1, std::memory_order_relaxed);
+      return Succeeded::yes;
+    }
   else
     {
+      counters.num_misses.fetch_add(1, std::memory_order_relaxed);
       //cout << " This entry  is not in the cache :" << Key << endl;	
       return Succeeded::no;
     }
@@ -2,6 +2,7 @@
     Copyright (C) 2004 - 2008, Hammersmith Imanet Ltd
     Copyright (C) 2011 - 2012, Kris Thielemans
     Copyright (C) 2014, University College London
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -44,8 +45,13 @@
 //#include "stir/info.h"
 #include "boost/cstdint.hpp"
 #include "boost/scoped_ptr.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
 #include <fstream>
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 using std::string;
 
@@ -111,9 +117,9 @@ ProjMatrixByBinFromFile::post_processing()
   if (ProjMatrixByBin::post_processing() == true)
     return true;
 
-  if (this->parsed_version != "1.0")
+  if (this->parsed_version != "1.0" && this->parsed_version != "2.0")
     { 
-      warning("version has to be 1.0");
+      warning("version has to be 1.0 or 2.0");
       return true;
     }
   this->symmetries_type = standardise_interfile_keyword(this->symmetries_type);
@@ -216,6 +222,21 @@ set_up(
   // every LOR that's in the file in the cache
   ProjMatrixByBin::set_up(this->proj_data_info_ptr, density_info_ptr);
 
+  if (this->parsed_version == "2.0")
+    {
+      // elements will be read from the mapped file when needed
+      if (map_data() == Succeeded::no)
+        error("Something wrong reading the matrix from file. Exiting.");
+      return;
+    }
+
+  if (this->get_cache_memory_limit_in_MB() > 0)
+    {
+      // all elements are read into the cache, so we cannot remove any of them
+      warning("ProjMatrixByBinFromFile cannot use a cache memory limit with version 1.0 files. Removing the limit.");
+      this->set_cache_memory_limit_in_MB(0);
+    }
+
   if (read_data() ==Succeeded::no)
     error("Something wrong reading the matrix from file. Exiting.");
 }
@@ -328,6 +349,71 @@ namespace {
       }  
     return readReturnType::ok;
   }
+
+  /* Layout of version 2.0 files:
+     - FileHeaderV2
+     - all elements (as PackedElementV2), row after row
+     - padding up to a multiple of 8 bytes
+     - FileHeaderV2::num_lors IndexEntryV2 objects
+  */
+  static const char magic_v2[8] = {'S','T','I','R','P','M','2','\0'};
+
+  struct FileHeaderV2
+  {
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t element_size;
+    boost::uint64_t num_lors;
+    boost::uint64_t index_offset;
+  };
+
+  struct PackedElementV2
+  {
+    boost::int16_t c1, c2, c3, unused;
+    float value;
+  };
+
+  struct IndexEntryV2
+  {
+    boost::int32_t segment_num, view_num, axial_pos_num, tangential_pos_num;
+    boost::uint32_t num_elements, unused;
+    boost::uint64_t offset;
+  };
+
+  BOOST_STATIC_ASSERT(sizeof(FileHeaderV2) == 32);
+  BOOST_STATIC_ASSERT(sizeof(PackedElementV2) == 12);
+  BOOST_STATIC_ASSERT(sizeof(IndexEntryV2) == 32);
+
+  // static (i.e. private) function to write the elements of an lor, and fill in the index entry
+  static Succeeded
+  write_lor_v2(std::ostream&fst, IndexEntryV2& index_entry, const ProjMatrixElemsForOneBin& lor)
+  {
+    const Bin bin = lor.get_bin();
+    index_entry.segment_num = bin.segment_num();
+    index_entry.view_num = bin.view_num();
+    index_entry.axial_pos_num = bin.axial_pos_num();
+    index_entry.tangential_pos_num = bin.tangential_pos_num();
+    index_entry.num_elements = static_cast<boost::uint32_t>(lor.size());
+    index_entry.unused = 0;
+    index_entry.offset = static_cast<boost::uint64_t>(fst.tellp());
+
+    if (lor.size() == 0)
+      return fst ? Succeeded::yes : Succeeded::no;
+    std::vector<PackedElementV2> elements(lor.size());
+    std::vector<PackedElementV2>::iterator packed_element_iter = elements.begin();
+    for (ProjMatrixElemsForOneBin::const_iterator element_ptr = lor.begin();
+         element_ptr != lor.end();
+         ++element_ptr, ++packed_element_iter)
+      {
+        packed_element_iter->c1 = static_cast<boost::int16_t>(element_ptr->coord1());
+        packed_element_iter->c2 = static_cast<boost::int16_t>(element_ptr->coord2());
+        packed_element_iter->c3 = static_cast<boost::int16_t>(element_ptr->coord3());
+        packed_element_iter->unused = 0;
+        packed_element_iter->value = element_ptr->get_value();
+      }
+    fst.write(reinterpret_cast<const char *>(&elements[0]), elements.size()*sizeof(PackedElementV2));
+    return fst ? Succeeded::yes : Succeeded::no;
+  }
 } // end of anonymous namespace
     
 Succeeded
@@ -335,8 +421,14 @@ ProjMatrixByBinFromFile::
 write_to_file(const std::string& output_filename_prefix, 
 	      const ProjMatrixByBin& proj_matrix,
 	      const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
-	      const DiscretisedDensity<3,float>& template_density)
+	      const DiscretisedDensity<3,float>& template_density,
+	      const std::string& version)
 {
+  if (version != "1.0" && version != "2.0")
+    {
+      warning("ProjMatrixByBinFromFile::write_to_file: version has to be 1.0 or 2.0");
+      return Succeeded::no;
+    }
 
   string template_density_filename =
     output_filename_prefix + "_template_density";
@@ -349,8 +441,9 @@ write_to_file(const std::string& output_filename_prefix,
 	return Succeeded::no;
       }
   }
+  // note: ProjDataInterfile writes the header with extension .hs, so use that name in the matrix header
   string template_proj_data_filename =
-    output_filename_prefix + "_template_proj_data";
+    output_filename_prefix + "_template_proj_data.hs";
   {
     // the following constructor will write an interfile header (and empty data) to disk
     shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
@@ -374,7 +467,7 @@ write_to_file(const std::string& output_filename_prefix,
       }
 
     header << "Projection Matrix By Bin From File Parameters:=\n"
-	   << "Version := 1.0\n";
+	   << "Version := " << version << '\n';
     // TODO symmetries should not be hard-coded
     if (!is_null_ptr(dynamic_cast<const DataSymmetriesForBins_PET_CartesianGrid * const>(proj_matrix.get_symmetries_ptr())))
       {
@@ -412,6 +505,17 @@ write_to_file(const std::string& output_filename_prefix,
 
   std::ofstream fst;
   open_write_binary(fst, data_filename.c_str());
+
+  const bool write_v2 = version == "2.0";
+  // index for version 2.0 files
+  std::vector<IndexEntryV2> index_entries;
+  if (write_v2)
+    {
+      // write a header now, it will be overwritten at the end
+      FileHeaderV2 file_header;
+      std::memset(&file_header, 0, sizeof(file_header));
+      fst.write(reinterpret_cast<const char *>(&file_header), sizeof(file_header));
+    }
   
   // loop over bins
   // the complication here is that we cannot just test if each bin in the range is 'basic'
@@ -496,10 +600,38 @@ write_to_file(const std::string& output_filename_prefix,
 	    //  continue;
 	    
 	    proj_matrix.get_proj_matrix_elems_for_one_bin(lor,bin);
-	    if (write_lor(fst, lor) == Succeeded::no)
-	      return Succeeded::no;
+	    if (write_v2)
+	      {
+	        index_entries.push_back(IndexEntryV2());
+	        if (write_lor_v2(fst, index_entries.back(), lor) == Succeeded::no)
+	          return Succeeded::no;
+	      }
+	    else
+	      {
+	        if (write_lor(fst, lor) == Succeeded::no)
+	          return Succeeded::no;
+	      }
 	  }
   }
+  if (write_v2)
+    {
+      // pad to 8 bytes, and write the index
+      const char padding[8] = {0,0,0,0,0,0,0,0};
+      const std::streamoff num_bytes_written = fst.tellp();
+      fst.write(padding, (8 - num_bytes_written%8)%8);
+      FileHeaderV2 file_header;
+      std::memcpy(file_header.magic, magic_v2, sizeof(magic_v2));
+      file_header.version = 2;
+      file_header.element_size = sizeof(PackedElementV2);
+      file_header.num_lors = index_entries.size();
+      file_header.index_offset = static_cast<boost::uint64_t>(fst.tellp());
+      if (!index_entries.empty())
+        fst.write(reinterpret_cast<const char *>(&index_entries[0]), index_entries.size()*sizeof(IndexEntryV2));
+      fst.seekp(0);
+      fst.write(reinterpret_cast<const char *>(&file_header), sizeof(file_header));
+      if (!fst)
+        return Succeeded::no;
+    }
   return Succeeded::yes;
 }
 
@@ -525,13 +657,102 @@ read_data()
 }
 
 
+boost::uint64_t
+ProjMatrixByBinFromFile::
+make_index_key(const Bin& bin)
+{
+  // 16 bits for every coordinate, made positive
+  return
+    (static_cast<boost::uint64_t>(static_cast<boost::uint16_t>(bin.segment_num() + 32768)) << 48) |
+    (static_cast<boost::uint64_t>(static_cast<boost::uint16_t>(bin.view_num() + 32768)) << 32) |
+    (static_cast<boost::uint64_t>(static_cast<boost::uint16_t>(bin.axial_pos_num() + 32768)) << 16) |
+    static_cast<boost::uint64_t>(static_cast<boost::uint16_t>(bin.tangential_pos_num() + 32768));
+}
+
+Succeeded
+ProjMatrixByBinFromFile::
+map_data()
+{
+  using namespace boost::interprocess;
+  this->index.clear();
+  try
+    {
+      const file_mapping mapping(data_filename.c_str(), read_only);
+      this->mapped_region_sptr.reset(new mapped_region(mapping, read_only));
+    }
+  catch (interprocess_exception& e)
+    {
+      warning("ProjMatrixByBinFromFile: error mapping file %s: %s",
+              data_filename.c_str(), e.what());
+      return Succeeded::no;
+    }
+  const char * const data_ptr = static_cast<const char *>(this->mapped_region_sptr->get_address());
+  const std::size_t file_size = this->mapped_region_sptr->get_size();
+
+  FileHeaderV2 file_header;
+  if (file_size < sizeof(file_header))
+    {
+      warning("ProjMatrixByBinFromFile: file %s is too small", data_filename.c_str());
+      return Succeeded::no;
+    }
+  std::memcpy(&file_header, data_ptr, sizeof(file_header));
+  if (std::memcmp(file_header.magic, magic_v2, sizeof(magic_v2)) != 0 ||
+      file_header.version != 2 ||
+      file_header.element_size != sizeof(PackedElementV2))
+    {
+      warning("ProjMatrixByBinFromFile: file %s is not a version 2.0 file (or has the wrong byte order)",
+              data_filename.c_str());
+      return Succeeded::no;
+    }
+  if (file_header.index_offset + file_header.num_lors*sizeof(IndexEntryV2) > file_size)
+    {
+      warning("ProjMatrixByBinFromFile: file %s is too small for its index", data_filename.c_str());
+      return Succeeded::no;
+    }
+
+  for (boost::uint64_t i=0; i<file_header.num_lors; ++i)
+    {
+      IndexEntryV2 index_entry;
+      std::memcpy(&index_entry,
+                  data_ptr + file_header.index_offset + i*sizeof(IndexEntryV2),
+                  sizeof(index_entry));
+      if (index_entry.offset + index_entry.num_elements*sizeof(PackedElementV2) > file_header.index_offset)
+        {
+          warning("ProjMatrixByBinFromFile: file %s has an inconsistent index", data_filename.c_str());
+          return Succeeded::no;
+        }
+      const Bin bin(index_entry.segment_num, index_entry.view_num,
+                    index_entry.axial_pos_num, index_entry.tangential_pos_num);
+      IndexEntry& entry = this->index[make_index_key(bin)];
+      entry.offset = index_entry.offset;
+      entry.num_elements = index_entry.num_elements;
+    }
+  return Succeeded::yes;
+}
+
 void 
 ProjMatrixByBinFromFile::
 calculate_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& lor
 					) const
 {
-  //error("ProjMatrixByBinFromFile element not found in cache (and hence file)");
   lor.erase();
+  // for version 1.0 files, all elements are already in the cache
+  if (is_null_ptr(this->mapped_region_sptr))
+    return;
+  //error("ProjMatrixByBinFromFile element not found in cache (and hence file)");
+  const Index::const_iterator iter = this->index.find(make_index_key(lor.get_bin()));
+  if (iter == this->index.end())
+    return;
+
+  // elements are 4-byte aligned in the file, so we can use them directly
+  const PackedElementV2 * element_ptr =
+    reinterpret_cast<const PackedElementV2 *>(static_cast<const char *>(this->mapped_region_sptr->get_address()) +
+                                              iter->second.offset);
+  const PackedElementV2 * const end_element_ptr = element_ptr + iter->second.num_elements;
+  lor.reserve(iter->second.num_elements);
+  for (; element_ptr != end_element_ptr; ++element_ptr)
+    lor.push_back(ProjMatrixElemsForOneBin::value_type(Coordinate3D<int>(element_ptr->c1, element_ptr->c2, element_ptr->c3),
+                                                       element_ptr->value));
 }
 END_NAMESPACE_STIR
 
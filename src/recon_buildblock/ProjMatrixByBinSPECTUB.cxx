@@ -248,6 +248,13 @@ set_up(
 
   ProjMatrixByBin::set_up(proj_data_info_ptr_v, density_info_ptr);
 
+  if (this->get_cache_memory_limit_in_MB() > 0)
+    {
+      // elements are computed per subset of views, so cannot be recomputed individually
+      warning("SPECTUB matrix cannot use a cache memory limit. Removing the limit.");
+      this->set_cache_memory_limit_in_MB(0);
+    }
+
 #ifdef STIR_OPENMP
   if (!this->keep_all_views_in_cache)
     {
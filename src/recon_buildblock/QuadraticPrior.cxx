@@ -34,6 +34,7 @@
 #include "stir/IO/read_from_file.h"
 #include "stir/is_null_ptr.h"
 #include "stir/info.h"
+#include "stir/recon_buildblock/neighbourhood_prior_functions.h"
 #include <algorithm>
 using std::min;
 using std::max;
@@ -189,6 +190,26 @@ set_kappa_sptr(const shared_ptr<const DiscretisedDensity<3,elemT> >& k)
 { this->kappa_ptr = k; }
 
 
+namespace {
+// Potential function for use with the functions in neighbourhood_prior_functions.h
+template <typename elemT>
+class QuadraticPotential
+{
+public:
+  elemT value(const float weight, const elemT val_j, const elemT val_k) const
+  {
+    const elemT current = weight * square(val_j - val_k)/4;
+    return current;
+  }
+
+  elemT derivative(const float weight, const elemT val_j, const elemT val_k) const
+  {
+    const elemT current = weight * (val_j - val_k);
+    return current;
+  }
+};
+}
+
 // TODO move to set_up
 // initialise to 1/Euclidean distance
 static void 
@@ -248,53 +269,16 @@ compute_value(const DiscretisedDensity<3,elemT> &current_image_estimate)
     error("QuadraticPrior: kappa image has not the same index range as the reconstructed image\n");
 
 
-  double result = 0.;
-  const int min_z = current_image_estimate.get_min_index(); 
-  const int max_z = current_image_estimate.get_max_index(); 
-  for (int z=min_z; z<=max_z; z++)
-    {
-      const int min_dz = max(weights.get_min_index(), min_z-z);
-      const int max_dz = min(weights.get_max_index(), max_z-z);
-        
-      const int min_y = current_image_estimate[z].get_min_index();
-      const int max_y = current_image_estimate[z].get_max_index();
-
-        for (int y=min_y;y<= max_y;y++)
-          {
-            const int min_dy = max(weights[0].get_min_index(), min_y-y);
-            const int max_dy = min(weights[0].get_max_index(), max_y-y);            
-
-            const int min_x = current_image_estimate[z][y].get_min_index(); 
-            const int max_x = current_image_estimate[z][y].get_max_index(); 
-
-            for (int x=min_x;x<= max_x;x++)       
-              {
-                const int min_dx = max(weights[0][0].get_min_index(), min_x-x);
-                const int max_dx = min(weights[0][0].get_max_index(), max_x-x);
-                
-                /* formula:
-                  sum_dx,dy,dz
-                   1/4 weights[dz][dy][dx] *
-                   (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx])^2 *
-                   (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-                */
-                for (int dz=min_dz;dz<=max_dz;++dz)
-                  for (int dy=min_dy;dy<=max_dy;++dy)
-                    for (int dx=min_dx;dx<=max_dx;++dx)
-                      {
-                        elemT current =
-                          weights[dz][dy][dx] *
-                          square(current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx])/4;
-
-                        if (do_kappa)
-                          current *= 
-                            (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-
-                        result += static_cast<double>(current);
-                      }
-              }              
-          }
-    }
+  /* formula:
+     sum_x,y,z,dx,dy,dz
+      1/4 weights[dz][dy][dx] *
+      (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx])^2 *
+      (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+  */
+  const double result =
+    compute_neighbourhood_prior_value(current_image_estimate, this->weights,
+                                      do_kappa ? this->kappa_ptr.get() : 0,
+                                      QuadraticPotential<elemT>());
   return result * this->penalisation_factor;
 }
 
@@ -328,101 +312,15 @@ compute_gradient(DiscretisedDensity<3,elemT>& prior_gradient,
   if (do_kappa && !kappa_ptr->has_same_characteristics(current_image_estimate))
     error("QuadraticPrior: kappa image has not the same index range as the reconstructed image\n");
 
-  const int min_z = current_image_estimate.get_min_index();  
-  const int max_z = current_image_estimate.get_max_index();  
-  for (int z=min_z; z<=max_z; z++) 
-    { 
-      const int min_dz = max(weights.get_min_index(), min_z-z); 
-      const int max_dz = min(weights.get_max_index(), max_z-z); 
-      
-      const int min_y = current_image_estimate[z].get_min_index(); 
-      const int max_y = current_image_estimate[z].get_max_index(); 
-      
-      for (int y=min_y;y<= max_y;y++) 
-        { 
-          const int min_dy = max(weights[0].get_min_index(), min_y-y); 
-          const int max_dy = min(weights[0].get_max_index(), max_y-y);             
-          
-          const int min_x = current_image_estimate[z][y].get_min_index();
-          const int max_x = current_image_estimate[z][y].get_max_index();  
-          
-          for (int x=min_x;x<= max_x;x++)
-            {
-              const int min_dx = max(weights[0][0].get_min_index(), min_x-x);
-              const int max_dx = min(weights[0][0].get_max_index(), max_x-x);
-                
-                /* formula:
-                  sum_dx,dy,dz
-                   weights[dz][dy][dx] *
-                   (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) *
-                   (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-                */
-#if 1
-                elemT gradient = 0;
-                for (int dz=min_dz;dz<=max_dz;++dz)
-                  for (int dy=min_dy;dy<=max_dy;++dy)
-                    for (int dx=min_dx;dx<=max_dx;++dx)
-                      {
-                        elemT current =
-                          weights[dz][dy][dx] *
-                          (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]);
-
-                        if (do_kappa)
-                          current *= 
-                            (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-
-                        gradient += current;
-                      }
-#else
-                // attempt to speed up by precomputing the sum of weights.
-                // The current code gives identical results but is actually slower
-                // than the above, at least when kappas are present.
-
-
-                // precompute sum of weights
-                // TODO without kappas, this is just weights.sum() most of the time, 
-                // but not near edges
-                float sum_of_weights = 0;
-                {
-                  if (do_kappa)
-                    {                
-                      for (int dz=min_dz;dz<=max_dz;++dz)
-                        for (int dy=min_dy;dy<=max_dy;++dy)
-                          for (int dx=min_dx;dx<=max_dx;++dx)
-                            sum_of_weights +=  weights[dz][dy][dx]*(*kappa_ptr)[z+dz][y+dy][x+dx];
-                    }
-                  else
-                    {
-                      for (int dz=min_dz;dz<=max_dz;++dz)
-                        for (int dy=min_dy;dy<=max_dy;++dy)
-                          for (int dx=min_dx;dx<=max_dx;++dx)
-                            sum_of_weights +=  weights[dz][dy][dx];
-                    }
-                }
-                // now compute contribution of central term
-                elemT gradient = sum_of_weights * current_image_estimate[z][y][x] ;
-
-                // subtract the rest
-                for (int dz=min_dz;dz<=max_dz;++dz)
-                  for (int dy=min_dy;dy<=max_dy;++dy)
-                    for (int dx=min_dx;dx<=max_dx;++dx)
-                      {
-                        elemT current =
-                          weights[dz][dy][dx] * current_image_estimate[z+dz][y+dy][x+dx];
-
-                        if (do_kappa)
-                          current *= (*kappa_ptr)[z+dz][y+dy][x+dx];
-
-                        gradient -= current;
-                      }
-                // multiply with central kappa
-                if (do_kappa)
-                  gradient *= (*kappa_ptr)[z][y][x];
-#endif
-                prior_gradient[z][y][x]= gradient * this->penalisation_factor;
-              }              
-          }
-    }
+  /* formula:
+     sum_dx,dy,dz
+      weights[dz][dy][dx] *
+      (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) *
+      (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+  */
+  compute_neighbourhood_prior_gradient(prior_gradient, current_image_estimate, this->weights,
+                                       do_kappa ? this->kappa_ptr.get() : 0,
+                                       QuadraticPotential<elemT>(), static_cast<elemT>(this->penalisation_factor));
 
   info(boost::format("Prior gradient max %1%, min %2%\n") % prior_gradient.find_max() % prior_gradient.find_min());
 
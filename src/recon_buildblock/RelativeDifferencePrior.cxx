@@ -36,13 +36,11 @@
 #include "stir/IO/read_from_file.h"
 #include "stir/is_null_ptr.h"
 #include "stir/info.h"
+#include "stir/recon_buildblock/neighbourhood_prior_functions.h"
 #include <algorithm>
 using std::min;
 using std::max;
 
-/* Pretty horrible code because we don't have an iterator of neigbhourhoods yet
- */
-
 START_NAMESPACE_STIR
 
 template <typename elemT>
@@ -225,6 +223,51 @@ set_kappa_sptr(const shared_ptr<DiscretisedDensity<3,elemT> >& k)
 { this->kappa_ptr = k; }
 
 
+namespace {
+/* Potential function for the RDP, for use with the functions in neighbourhood_prior_functions.h.
+   Note that the expressions have to be kept the same as in the formulas in the documentation.
+*/
+template <typename elemT>
+class RelativeDifferencePotential
+{
+public:
+  RelativeDifferencePotential(const float gamma, const float epsilon)
+    : gamma(gamma), epsilon(epsilon)
+  {}
+
+  elemT value(const float weight, const elemT val_j, const elemT val_k) const
+  {
+    if (this->epsilon ==0.0 && val_j == 0.0 && val_k == 0.0)
+      {
+        // handle the undefined nature of the function
+        return 0;
+      }
+    const elemT current = weight * 0.5 *
+      (pow(val_j-val_k,2)/
+       (val_j+val_k + this->gamma * abs(val_j-val_k) + this->epsilon ));
+    return current;
+  }
+
+  elemT derivative(const float weight, const elemT val_j, const elemT val_k) const
+  {
+    if (this->epsilon ==0.0 && val_j == 0.0 && val_k == 0.0)
+      {
+        // handle the undefined nature of the gradient
+        return 0;
+      }
+    const elemT current = weight *
+      (((val_j - val_k) *
+        (this->gamma * abs(val_j - val_k) + val_j + 3 * val_k + 2 * this->epsilon))/
+       (square((val_j + val_k) + this->gamma * abs(val_j - val_k) + this->epsilon)));
+    return current;
+  }
+
+private:
+  const float gamma;
+  const float epsilon;
+};
+}
+
 // TODO move to set_up
 // initialise to 1/Euclidean distance
 static void 
@@ -284,53 +327,11 @@ compute_value(const DiscretisedDensity<3,elemT> &current_image_estimate)
     error("RelativeDifferencePrior: kappa image has not the same index range as the reconstructed image\n");
 
 
-  double result = 0.;
-  const int min_z = current_image_estimate.get_min_index(); 
-  const int max_z = current_image_estimate.get_max_index(); 
-  for (int z=min_z; z<=max_z; z++)
-    {
-      const int min_dz = max(weights.get_min_index(), min_z-z);
-      const int max_dz = min(weights.get_max_index(), max_z-z);
-        
-      const int min_y = current_image_estimate[z].get_min_index();
-      const int max_y = current_image_estimate[z].get_max_index();
-
-        for (int y=min_y;y<= max_y;y++)
-          {
-            const int min_dy = max(weights[0].get_min_index(), min_y-y);
-            const int max_dy = min(weights[0].get_max_index(), max_y-y);            
-
-            const int min_x = current_image_estimate[z][y].get_min_index(); 
-            const int max_x = current_image_estimate[z][y].get_max_index(); 
-
-            for (int x=min_x;x<= max_x;x++)       
-              {
-                const int min_dx = max(weights[0][0].get_min_index(), min_x-x);
-                const int max_dx = min(weights[0][0].get_max_index(), max_x-x);
-                
-                for (int dz=min_dz;dz<=max_dz;++dz)
-                  for (int dy=min_dy;dy<=max_dy;++dy)
-                    for (int dx=min_dx;dx<=max_dx;++dx)
-                      {
-                        elemT current;
-                        if (this->epsilon ==0.0 && current_image_estimate[z][y][x] == 0.0 && current_image_estimate[z+dz][y+dy][x+dx] == 0.0){
-                          // handle the undefined nature of the function
-                          current = 0.0;
-                        } else {
-                          current = weights[dz][dy][dx] * 0.5 *
-                                  (pow(current_image_estimate[z][y][x]-current_image_estimate[z+dz][y+dy][x+dx],2)/
-                                  (current_image_estimate[z][y][x]+current_image_estimate[z+dz][y+dy][x+dx]
-                                  + this->gamma * abs(current_image_estimate[z][y][x]-current_image_estimate[z+dz][y+dy][x+dx]) + this->epsilon ));
-                        }
-                        if (do_kappa)
-                          current *= 
-                            (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-
-                        result += static_cast<double>(current);
-                      }
-              }              
-          }
-    }
+  const RelativeDifferencePotential<elemT> potential(this->gamma, this->epsilon);
+  const double result =
+    compute_neighbourhood_prior_value(current_image_estimate, this->weights,
+                                      do_kappa ? this->kappa_ptr.get() : 0,
+                                      potential);
   return result * this->penalisation_factor;
 }
 
@@ -363,57 +364,10 @@ compute_gradient(DiscretisedDensity<3,elemT>& prior_gradient,
   if (do_kappa && !kappa_ptr->has_same_characteristics(current_image_estimate))
     error("RelativeDifferencePrior: kappa image has not the same index range as the reconstructed image\n");
 
-  const int min_z = current_image_estimate.get_min_index();  
-  const int max_z = current_image_estimate.get_max_index();  
-  for (int z=min_z; z<=max_z; z++) 
-    { 
-      const int min_dz = max(weights.get_min_index(), min_z-z); 
-      const int max_dz = min(weights.get_max_index(), max_z-z); 
-      
-      const int min_y = current_image_estimate[z].get_min_index(); 
-      const int max_y = current_image_estimate[z].get_max_index(); 
-      
-      for (int y=min_y;y<= max_y;y++) 
-        { 
-          const int min_dy = max(weights[0].get_min_index(), min_y-y); 
-          const int max_dy = min(weights[0].get_max_index(), max_y-y);             
-          
-          const int min_x = current_image_estimate[z][y].get_min_index();
-          const int max_x = current_image_estimate[z][y].get_max_index();  
-          
-          for (int x=min_x;x<= max_x;x++)
-            {
-              const int min_dx = max(weights[0][0].get_min_index(), min_x-x);
-              const int max_dx = min(weights[0][0].get_max_index(), max_x-x);
-
-                elemT gradient = 0;
-                for (int dz=min_dz;dz<=max_dz;++dz)
-                  for (int dy=min_dy;dy<=max_dy;++dy)
-                    for (int dx=min_dx;dx<=max_dx;++dx)
-                      {
-
-                        elemT current;
-                        if (this->epsilon ==0.0 && current_image_estimate[z][y][x] == 0.0 && current_image_estimate[z+dz][y+dy][x+dx] == 0.0){
-                          // handle the undefined nature of the gradient
-                          current = 0.0;
-                        } else {
-                            current = weights[dz][dy][dx] *
-                                    (((current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) *
-                                      (this->gamma * abs(current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) +
-                                       current_image_estimate[z][y][x] + 3 * current_image_estimate[z+dz][y+dy][x+dx] + 2 * this->epsilon))/
-                                     (square((current_image_estimate[z][y][x] + current_image_estimate[z+dz][y+dy][x+dx]) +
-                                      this->gamma * abs(current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) + this->epsilon)));
-                        }
-                        if (do_kappa)
-                          current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-
-                        gradient += current;
-                      }
-
-                prior_gradient[z][y][x]= gradient * this->penalisation_factor;
-              }              
-          }
-    }
+  const RelativeDifferencePotential<elemT> potential(this->gamma, this->epsilon);
+  compute_neighbourhood_prior_gradient(prior_gradient, current_image_estimate, this->weights,
+                                       do_kappa ? this->kappa_ptr.get() : 0,
+                                       potential, static_cast<elemT>(this->penalisation_factor));
 
   info(boost::format("Prior gradient max %1%, min %2%\n") % prior_gradient.find_max() % prior_gradient.find_min());
 
@@ -2,6 +2,7 @@
     Copyright (C) 2000 PARAPET partners
     Copyright (C) 2000 - 2011, Hammersmith Imanet Ltd
     Copyright (C) 2013-2014, University College London
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -28,6 +29,7 @@
   \author Matthew Jacobson
   \author PARAPET project
   \author Tobias Beisel
+  \author STIR developers
 */
 /* Modification history:
    KT 30/05/2002
@@ -54,10 +56,13 @@
 #include "stir/recon_buildblock/BackProjectorByBin.h"
 #include "stir/recon_buildblock/BinNormalisation.h"
 #include "stir/recon_buildblock/find_basic_vs_nums_in_subsets.h"
+#include "stir/recon_buildblock/DistributableCostModel.h"
 #include "stir/is_null_ptr.h"
 #include "stir/info.h"
 #include <boost/format.hpp>
 #include <algorithm>
+#include <numeric>
+#include <vector>
 
 #ifdef STIR_MPI
 #include "stir/recon_buildblock/distributableMPICacheEnabled.h"
@@ -75,6 +80,21 @@
 
 START_NAMESPACE_STIR
 
+namespace {
+  //! cost estimates for the view/segments, reset by setup_distributable_computation()
+  DistributableCostModel cost_model;
+  //! times of the threads during the last distributable_computation()
+  std::vector<double> last_busy_times;
+  std::vector<double> last_idle_times;
+}
+
+void get_distributable_computation_thread_times(std::vector<double>& busy_times,
+                                                std::vector<double>& idle_times)
+{
+  busy_times = last_busy_times;
+  idle_times = last_idle_times;
+}
+
 /* WARNING: the sequence of steps here has to match what is on the receiving end 
    in DistributedWorker */
 void setup_distributable_computation(
@@ -86,6 +106,8 @@ void setup_distributable_computation(
                                      const bool distributed_cache_enabled)
 {
   set_num_threads();
+  // timings of a previous set-up are for different data or projectors
+  cost_model.reset();
 #ifdef STIR_OPENMP
   info(boost::format("Using distributable_computation with %d threads on %d processors.")
        % omp_get_max_threads() % omp_get_num_procs());
@@ -178,9 +200,7 @@ void get_viewgrams(shared_ptr<RelatedViewgrams<float> >& y,
 {
   if (!is_null_ptr(binwise_correction))
     {
-#ifdef STIR_OPENMP
-#pragma omp critical(ADDSINO)
-#endif
+      // no critical section needed, ProjData handles concurrent reads
 #if !defined(_MSC_VER) || _MSC_VER>1300
       additive_binwise_correction_viewgrams.reset(
         new RelatedViewgrams<float>
@@ -194,9 +214,6 @@ void get_viewgrams(shared_ptr<RelatedViewgrams<float> >& y,
                         
   if (read_from_proj_dat)
     {
-#ifdef STIR_OPENMP
-#pragma omp critical(VIEW)
-#endif
 #if !defined(_MSC_VER) || _MSC_VER>1300
       y.reset(new RelatedViewgrams<float>
 	      (proj_dat_ptr->get_related_viewgrams(view_segment_num, symmetries_ptr)));
@@ -220,6 +237,8 @@ void get_viewgrams(shared_ptr<RelatedViewgrams<float> >& y,
 				new RelatedViewgrams<float>(proj_dat_ptr->get_empty_related_viewgrams(view_segment_num, symmetries_ptr)));
       mult_viewgrams_sptr->fill(1.F);
 #ifdef STIR_OPENMP
+      // BinNormalisation::undo() is not guaranteed to be thread-safe (e.g. normalisation
+      // objects reading from file), so keep this one serialised
 #pragma omp critical(MULT)
 #endif
       normalisation_sptr->undo(*mult_viewgrams_sptr,start_time_of_frame,end_time_of_frame);
@@ -393,10 +412,15 @@ void distributable_computation(
   if (zero_seg0_end_planes)
     info("End-planes of segment 0 will be zeroed");
 
+  // process the most expensive view/segments first (see DistributableCostModel)
   const std::vector<ViewSegmentNumbers> vs_nums_to_process = 
-    detail::find_basic_vs_nums_in_subset(*proj_dat_ptr->get_proj_data_info_sptr(), *symmetries_ptr,
-                                         min_segment_num, max_segment_num,
-                                         subset_num, num_subsets);
+    cost_model.sort_by_decreasing_cost(
+      detail::find_basic_vs_nums_in_subset(*proj_dat_ptr->get_proj_data_info_sptr(), *symmetries_ptr,
+                                           min_segment_num, max_segment_num,
+                                           subset_num, num_subsets),
+      *proj_dat_ptr->get_proj_data_info_sptr(), *symmetries_ptr);
+  // time spent on every view/segment
+  std::vector<double> measured_costs(vs_nums_to_process.size(), 0.);
         
   int count=0, count2=0;
   
@@ -411,10 +435,13 @@ void distributable_computation(
   if (output_image_ptr != NULL)
     back_projector_ptr->start_accumulating_in_new_target();
 
+  HighResWallClockTimer loop_timer;
+  loop_timer.start();
+  std::vector<double> busy_times(1, 0.);
 #ifdef STIR_OPENMP
   std::vector<double> local_log_likelihoods;
   std::vector<int> local_counts, local_count2s;
-#pragma omp parallel shared(local_log_likelihoods, local_counts, local_count2s)
+#pragma omp parallel shared(local_log_likelihoods, local_counts, local_count2s, busy_times, measured_costs)
 #endif
 
   // start of threaded section if openmp
@@ -426,13 +453,17 @@ void distributable_computation(
       local_log_likelihoods.resize(omp_get_max_threads(), 0.);
       local_counts.resize(omp_get_max_threads(), 0);
       local_count2s.resize(omp_get_max_threads(), 0);
+      busy_times.resize(omp_get_num_threads(), 0.);
     }
-#pragma omp for schedule(runtime)  
+    // dynamic scheduling, such that the (sorted) expensive view/segments are processed first
+#pragma omp for schedule(dynamic)
 #endif
     // note: older versions of openmp need an int as loop
     for (int i=0; i<static_cast<int>(vs_nums_to_process.size()); ++i)
       {
         const ViewSegmentNumbers view_segment_num=vs_nums_to_process[i];
+        HighResWallClockTimer view_segment_timer;
+        view_segment_timer.start();
 
         shared_ptr<RelatedViewgrams<float> > y;
         shared_ptr<RelatedViewgrams<float> > additive_binwise_correction_viewgrams;
@@ -495,6 +526,13 @@ void distributable_computation(
                                         additive_binwise_correction_viewgrams.get(),
                                         mult_viewgrams_sptr.get());
 #endif // OPENMP                                    
+          view_segment_timer.stop();
+          measured_costs[i] = view_segment_timer.value();
+#ifdef STIR_OPENMP
+          busy_times[thread_num] += measured_costs[i];
+#else
+          busy_times[0] += measured_costs[i];
+#endif
 #endif // MPI
       } // end of for-loop 
   } // end of parallel section of openmp
@@ -510,6 +548,28 @@ void distributable_computation(
     count += std::accumulate(local_counts.begin(), local_counts.end(), 0);
     count2 += std::accumulate(local_count2s.begin(), local_count2s.end(), 0);
   }
+#endif
+  loop_timer.stop();
+#ifndef STIR_MPI
+  // store timings for the next call and report load (im)balance
+  {
+    for (std::size_t i=0; i<vs_nums_to_process.size(); ++i)
+      cost_model.set_measured_cost(vs_nums_to_process[i], measured_costs[i],
+                                   DistributableCostModel::get_geometric_cost(*proj_dat_ptr->get_proj_data_info_sptr(),
+                                                                              *symmetries_ptr, vs_nums_to_process[i]));
+    last_busy_times = busy_times;
+    last_idle_times.resize(busy_times.size());
+    for (std::size_t t=0; t<busy_times.size(); ++t)
+      {
+        last_idle_times[t] = std::max(loop_timer.value() - busy_times[t], 0.);
+        info(boost::format("Thread %1%: busy %2%s, idle %3%s") % t % busy_times[t] % last_idle_times[t], 2);
+      }
+    const double max_busy_time = *std::max_element(busy_times.begin(), busy_times.end());
+    if (max_busy_time > 0)
+      info(boost::format("Load balance of threads in distributable_computation: average busy time %1%s, maximum %2%s (%3%%%)")
+           % (std::accumulate(busy_times.begin(), busy_times.end(), 0.)/busy_times.size()) % max_busy_time
+           % (100*std::accumulate(busy_times.begin(), busy_times.end(), 0.)/busy_times.size()/max_busy_time), 2);
+  }
 #endif
   if (output_image_ptr != NULL)
     back_projector_ptr->get_output(*output_image_ptr);
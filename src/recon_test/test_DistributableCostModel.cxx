@@ -0,0 +1,137 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for stir::DistributableCostModel
+
+  \author STIR developers
+*/
+
+#include "stir/recon_buildblock/DistributableCostModel.h"
+#include "stir/TrivialDataSymmetriesForViewSegmentNumbers.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Scanner.h"
+#include "stir/RunTests.h"
+#include <algorithm>
+#include <iostream>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for DistributableCostModel
+
+  Checks that without measurements, oblique segments are estimated to be more expensive,
+  that measured costs are used when available and that the sorting is on decreasing cost.
+*/
+class DistributableCostModelTests : public RunTests
+{
+public:
+  void run_tests();
+};
+
+void
+DistributableCostModelTests::
+run_tests()
+{
+  std::cerr << "Tests for DistributableCostModel\n";
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(
+    ProjDataInfo::construct_proj_data_info(scanner_sptr, /*span*/ 1, /*max_delta*/ 4,
+                                           /*num_views*/ 8, /*num_tangential_poss*/ 16).release());
+  TrivialDataSymmetriesForViewSegmentNumbers symmetries;
+
+  std::vector<ViewSegmentNumbers> vs_nums;
+  for (int segment_num = -2; segment_num <= 2; ++segment_num)
+    for (int view_num = 0; view_num < 3; ++view_num)
+      vs_nums.push_back(ViewSegmentNumbers(view_num, segment_num));
+
+  DistributableCostModel cost_model;
+
+  // geometric estimates
+  {
+    const double cost0 = cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(0, 0));
+    const double cost2 = cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(0, 2));
+    check(cost0 > 0, "cost of segment 0 should be positive");
+    // segment 2 has fewer sinograms than segment 0 with span 1, but every LOR is longer
+    const double num_bins_ratio =
+      static_cast<double>(proj_data_info_sptr->get_num_axial_poss(2))/proj_data_info_sptr->get_num_axial_poss(0);
+    check(cost2/cost0 > num_bins_ratio, "oblique segment should cost more per bin");
+    check_if_equal(cost0, DistributableCostModel::get_geometric_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(0, 0)),
+                   "estimated cost without measurements should be the geometric cost");
+
+    const std::vector<ViewSegmentNumbers> sorted =
+      cost_model.sort_by_decreasing_cost(vs_nums, *proj_data_info_sptr, symmetries);
+    check_if_equal(sorted.size(), vs_nums.size(), "sorted size");
+    check(std::is_permutation(sorted.begin(), sorted.end(), vs_nums.begin()), "sorted should be a permutation");
+    for (std::size_t i=1; i<sorted.size(); ++i)
+      check(cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, sorted[i-1]) >=
+            cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, sorted[i]),
+            "sorting on geometric cost");
+  }
+
+  // measured costs
+  {
+    // pretend that view 1 of segment 0 is very expensive, while all others are as expected
+    const double seconds_per_unit = 1.E-6;
+    for (std::size_t i=0; i<vs_nums.size(); ++i)
+      {
+        const double geometric_cost =
+          DistributableCostModel::get_geometric_cost(*proj_data_info_sptr, symmetries, vs_nums[i]);
+        const double measured_cost =
+          geometric_cost * seconds_per_unit * (vs_nums[i] == ViewSegmentNumbers(1, 0) ? 100 : 1);
+        cost_model.set_measured_cost(vs_nums[i], measured_cost, geometric_cost);
+      }
+    const std::vector<ViewSegmentNumbers> sorted =
+      cost_model.sort_by_decreasing_cost(vs_nums, *proj_data_info_sptr, symmetries);
+    check(sorted[0] == ViewSegmentNumbers(1, 0), "measured expensive view/segment should be first");
+
+    // a view/segment that was not measured is scaled to the measurements
+    const ViewSegmentNumbers not_measured(5, 1);
+    const double geometric_cost =
+      DistributableCostModel::get_geometric_cost(*proj_data_info_sptr, symmetries, not_measured);
+    const double estimated_cost = cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, not_measured);
+    check(estimated_cost > geometric_cost * seconds_per_unit, "unmeasured cost should be scaled to measurements");
+    check(estimated_cost < geometric_cost * seconds_per_unit * 100, "unmeasured cost should be scaled to measurements");
+
+    // overwrite a measurement
+    cost_model.set_measured_cost(ViewSegmentNumbers(1, 0), 0., geometric_cost);
+    check_if_equal(cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(1, 0)), 0.,
+                   "overwritten measurement");
+
+    cost_model.reset();
+    check_if_equal(cost_model.get_estimated_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(1, 0)),
+                   DistributableCostModel::get_geometric_cost(*proj_data_info_sptr, symmetries, ViewSegmentNumbers(1, 0)),
+                   "estimated cost after reset should be the geometric cost");
+  }
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int main()
+{
+  DistributableCostModelTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,129 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for stir::FourierRebinning
+
+  \author STIR developers
+*/
+
+#include "stir/recon_buildblock/FourierRebinning.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/Succeeded.h"
+#include "stir/num_threads.h"
+#include "stir/RunTests.h"
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for FourierRebinning
+
+  Runs FORE on some (smooth) projection data with 1 thread and with several threads,
+  and checks that the results are identical.
+*/
+class FourierRebinningTests : public RunTests
+{
+public:
+  void run_tests();
+private:
+  //! run FORE with \a num_threads threads and return the rebinned segment
+  SegmentBySinogram<float>
+    rebin(const shared_ptr<ProjData>& proj_data_sptr, const int num_threads);
+};
+
+SegmentBySinogram<float>
+FourierRebinningTests::
+rebin(const shared_ptr<ProjData>& proj_data_sptr, const int num_threads)
+{
+  set_num_threads(num_threads);
+  const std::string output_filename_prefix =
+    "test_FourierRebinning_" + std::to_string(num_threads) + "_threads";
+
+  FourierRebinning fore;
+  fore.set_input_proj_data_sptr(proj_data_sptr);
+  fore.set_output_filename_prefix(output_filename_prefix);
+  fore.set_kmin(2);
+  fore.set_wmin(2);
+  fore.set_deltamin(2);
+  fore.set_kc(2);
+  check(fore.set_up() == Succeeded::yes, "FORE set_up");
+  check(fore.rebin() == Succeeded::yes, "FORE rebin");
+
+  shared_ptr<ProjData> rebinned_sptr = ProjData::read_from_file(output_filename_prefix + ".hs");
+  return rebinned_sptr->get_segment_by_sinogram(0);
+}
+
+void
+FourierRebinningTests::
+run_tests()
+{
+  std::cerr << "Tests for FourierRebinning\n";
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  scanner_sptr->set_num_rings(8);
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(
+    ProjDataInfo::construct_proj_data_info(scanner_sptr, /*span*/ 1, /*max_delta*/ 3,
+                                           /*num_views*/ 48, /*num_tang_poss*/ 64).release());
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
+  shared_ptr<ProjData> proj_data_sptr(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+
+  // fill with something smooth
+  for (int segment_num = proj_data_sptr->get_min_segment_num();
+       segment_num <= proj_data_sptr->get_max_segment_num();
+       ++segment_num)
+    {
+      SegmentBySinogram<float> segment = proj_data_sptr->get_empty_segment_by_sinogram(segment_num);
+      for (int a=segment.get_min_axial_pos_num(); a<=segment.get_max_axial_pos_num(); ++a)
+        for (int v=segment.get_min_view_num(); v<=segment.get_max_view_num(); ++v)
+          for (int t=segment.get_min_tangential_pos_num(); t<=segment.get_max_tangential_pos_num(); ++t)
+            segment[a][v][t] =
+              static_cast<float>(std::exp(-.002*square(t - 10*std::sin(v*_PI/segment.get_num_views()))) * (10 + a));
+      proj_data_sptr->set_segment(segment);
+    }
+
+  const SegmentBySinogram<float> rebinned_1 = rebin(proj_data_sptr, 1);
+  const SegmentBySinogram<float> rebinned_4 = rebin(proj_data_sptr, 4);
+  set_num_threads();
+
+  check(rebinned_1.find_max() > 0, "rebinned data should not be zero");
+  check(rebinned_1.get_index_range() == rebinned_4.get_index_range(), "index range of rebinned data");
+  check(std::equal(rebinned_1.begin_all(), rebinned_1.end_all(), rebinned_4.begin_all()),
+        "rebinned data should be identical when using multiple threads");
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int main()
+{
+  FourierRebinningTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
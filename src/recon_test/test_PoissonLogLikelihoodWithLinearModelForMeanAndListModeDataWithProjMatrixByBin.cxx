@@ -0,0 +1,196 @@
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for stir::PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin
+
+  \par Usage
+
+  <pre>
+  test_PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin listmode_filename
+  </pre>
+  The list mode file should have at least a few thousand prompts.
+
+  \author STIR developers
+*/
+
+#include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin.h"
+#include "stir/DiscretisedDensity.h"
+#include "stir/RunTests.h"
+#include "stir/Succeeded.h"
+#include "stir/num_threads.h"
+#include "stir/is_null_ptr.h"
+#include <boost/format.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin
+
+  Checks that the gradient computed with a single thread and a single batch of events
+  is the same as the one computed in parallel with (much) smaller batches, with and without
+  caching the events. The gradients are summed in a different order, so are only compared
+  up to the tolerance.
+
+  Also checks that <tt>num_events_per_batch := 0</tt> is rejected.
+*/
+class PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests :
+  public RunTests
+{
+public:
+  explicit PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests(const std::string& filename)
+    : list_mode_filename(filename)
+  {}
+
+  void run_tests();
+
+private:
+  typedef DiscretisedDensity<3,float> target_type;
+  typedef PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<target_type> objective_function_type;
+
+  std::string list_mode_filename;
+
+  //! construct the objective function by parsing, returns false if parsing failed
+  bool parse_objective_function(objective_function_type& objective_function,
+                                const unsigned long num_events_per_batch,
+                                const bool cache_events) const;
+  //! compute the gradient with the given settings
+  shared_ptr<target_type> compute_gradient(const unsigned long num_events_per_batch,
+                                           const bool cache_events,
+                                           const int num_threads);
+};
+
+bool
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::
+parse_objective_function(objective_function_type& objective_function,
+                         const unsigned long num_events_per_batch,
+                         const bool cache_events) const
+{
+  std::stringstream parameters;
+  parameters <<
+    "PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin Parameters:=\n"
+    "list mode filename := " << list_mode_filename << "\n"
+    "max ring difference num to process := 1\n"
+    "Matrix type := Ray Tracing\n"
+    "Ray tracing matrix parameters :=\n"
+    "End Ray tracing matrix parameters :=\n"
+    "num_events_to_use := 20000\n"
+    "num_events_per_batch := " << num_events_per_batch << "\n"
+    "cache list mode events := " << (cache_events ? 1 : 0) << "\n"
+    "sensitivity filename := 1\n"
+    "use subset sensitivities := 0\n"
+    "zoom := .2\n"
+    "XY output image size (in pixels) := 61\n"
+    "end PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin Parameters:=\n";
+  return objective_function.parse(parameters);
+}
+
+shared_ptr<PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::target_type>
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::
+compute_gradient(const unsigned long num_events_per_batch,
+                 const bool cache_events,
+                 const int num_threads)
+{
+  set_num_threads(num_threads);
+  objective_function_type objective_function;
+  if (!parse_objective_function(objective_function, num_events_per_batch, cache_events))
+    {
+      everything_ok = false;
+      std::cerr << "Error parsing objective function\n";
+      return shared_ptr<target_type>();
+    }
+  shared_ptr<target_type> estimate_sptr(objective_function.construct_target_ptr());
+  // use a non-uniform estimate
+  int value = 1;
+  for (target_type::full_iterator iter = estimate_sptr->begin_all(); iter != estimate_sptr->end_all(); ++iter)
+    {
+      *iter = static_cast<float>(value);
+      value = value%7 + 1;
+    }
+  if (objective_function.set_up(estimate_sptr) != Succeeded::yes)
+    {
+      everything_ok = false;
+      std::cerr << "Error setting up objective function\n";
+      return shared_ptr<target_type>();
+    }
+  shared_ptr<target_type> gradient_sptr(estimate_sptr->get_empty_copy());
+  objective_function.compute_sub_gradient_without_penalty_plus_sensitivity(*gradient_sptr, *estimate_sptr, 0);
+  return gradient_sptr;
+}
+
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::
+run_tests()
+{
+  std::cerr << "Tests for PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin\n";
+
+  {
+    objective_function_type objective_function;
+    std::cerr << "\nThe next test should give a warning about num_events_per_batch\n";
+    check(!parse_objective_function(objective_function, 0UL, false), "num_events_per_batch=0 should be rejected");
+  }
+
+  const int num_threads = std::max(get_default_num_threads(), 4);
+
+  std::cerr << "\nComputing reference gradient with 1 thread and 1 batch\n";
+  const shared_ptr<target_type> reference_sptr = compute_gradient(100000UL, false, 1);
+  if (is_null_ptr(reference_sptr))
+    return;
+  check(reference_sptr->find_max() > 0.F, "gradient should be non-zero");
+
+  for (int cache_events = 0; cache_events <= 1; ++cache_events)
+    {
+      const unsigned long batch_sizes[] = { 1000UL, 1UL };
+      for (unsigned i = 0; i < sizeof(batch_sizes)/sizeof(batch_sizes[0]); ++i)
+        {
+          const std::string name =
+            boost::str(boost::format("gradient with %1% threads, batches of %2% events%3%")
+                       % num_threads % batch_sizes[i] % (cache_events ? ", caching events" : ""));
+          std::cerr << "\nComputing " << name << '\n';
+          const shared_ptr<target_type> gradient_sptr =
+            compute_gradient(batch_sizes[i], cache_events != 0, num_threads);
+          if (is_null_ptr(gradient_sptr))
+            return;
+          check_if_equal(*reference_sptr, *gradient_sptr, name);
+        }
+    }
+  set_default_num_threads();
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+    {
+      std::cerr << "Usage : " << argv[0] << " listmode_filename\n";
+      return EXIT_FAILURE;
+    }
+  PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests tests(argv[1]);
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,211 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for the cache of stir::ProjMatrixByBin and stir::ProjMatrixByBinFromFile
+
+  Uses stir::ProjMatrixByBinUsingRayTracing.
+
+  \author STIR developers
+*/
+
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Scanner.h"
+#include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
+#include "stir/recon_buildblock/ProjMatrixByBinFromFile.h"
+#include "stir/ProjData.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/Succeeded.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/RunTests.h"
+#include "stir/warning.h"
+#include <boost/format.hpp>
+#include <iostream>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for the cache of ProjMatrixByBin
+
+  Compares the rows of a matrix without caching with those from a matrix
+  with a (small) memory limit on the cache, and checks the cache statistics.
+
+  Also checks that a matrix written to file (in both versions of the file format)
+  is read back correctly.
+*/
+class ProjMatrixByBinTests : public RunTests
+{
+public:
+  void run_tests();
+private:
+  shared_ptr<ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<DiscretisedDensity<3,float> > density_sptr;
+
+  //! get all rows for segments -1,0,1 from both matrices and compare them
+  void compare_all_rows(const ProjMatrixByBin& proj_matrix_no_cache,
+                        const ProjMatrixByBin& proj_matrix,
+                        const std::string& str);
+  void run_tests_cache_memory_limit();
+  void run_tests_from_file(const std::string& version);
+};
+
+void
+ProjMatrixByBinTests::
+compare_all_rows(const ProjMatrixByBin& proj_matrix_no_cache,
+                 const ProjMatrixByBin& proj_matrix,
+                 const std::string& str)
+{
+  ProjMatrixElemsForOneBin elems_no_cache;
+  ProjMatrixElemsForOneBin elems;
+  for (int s=-1; s<=1; ++s)
+    for (int v=proj_data_info_sptr->get_min_view_num();
+         v <= proj_data_info_sptr->get_max_view_num();
+         ++v)
+      for (int a=proj_data_info_sptr->get_min_axial_pos_num(s);
+           a <= proj_data_info_sptr->get_max_axial_pos_num(s);
+           ++a)
+        for (int t=proj_data_info_sptr->get_min_tangential_pos_num();
+             t<=proj_data_info_sptr->get_max_tangential_pos_num();
+             t+=5)
+          {
+            const Bin bin(s,v,a,t);
+            proj_matrix_no_cache.get_proj_matrix_elems_for_one_bin(elems_no_cache, bin);
+            proj_matrix.get_proj_matrix_elems_for_one_bin(elems, bin);
+            elems_no_cache.sort();
+            elems.sort();
+            if (!check(elems_no_cache == elems, "comparing lors " + str))
+              {
+                std::cerr << "Current bin:  segment = " << bin.segment_num()
+                          << ", axial pos " << bin.axial_pos_num()
+                          << ", view = " << bin.view_num()
+                          << ", tangential_pos_num = " << bin.tangential_pos_num() << "\n";
+                return;
+              }
+          }
+}
+
+void
+ProjMatrixByBinTests::
+run_tests_cache_memory_limit()
+{
+  std::cerr << "\nTests with cache memory limit\n";
+  ProjMatrixByBinUsingRayTracing proj_matrix_no_cache;
+  proj_matrix_no_cache.enable_cache(false);
+  proj_matrix_no_cache.set_up(proj_data_info_sptr, density_sptr);
+
+  // first without a limit
+  ProjMatrixByBinUsingRayTracing proj_matrix_unlimited;
+  proj_matrix_unlimited.set_up(proj_data_info_sptr, density_sptr);
+  compare_all_rows(proj_matrix_no_cache, proj_matrix_unlimited, "(unlimited cache, first pass)");
+  const ProjMatrixByBin::CacheStatistics statistics_unlimited_first_pass =
+    proj_matrix_unlimited.get_cache_statistics();
+  check(statistics_unlimited_first_pass.memory_used_in_bytes > 0, "unlimited cache should use memory");
+  check_if_equal(statistics_unlimited_first_pass.num_evictions, 0UL, "unlimited cache should not evict");
+  proj_matrix_unlimited.reset_cache_statistics();
+  compare_all_rows(proj_matrix_no_cache, proj_matrix_unlimited, "(unlimited cache, second pass)");
+  const ProjMatrixByBin::CacheStatistics statistics_unlimited =
+    proj_matrix_unlimited.get_cache_statistics();
+  check_if_equal(statistics_unlimited.num_misses, 0UL, "unlimited cache: second pass should not have any misses");
+  check(statistics_unlimited.num_hits > 0, "unlimited cache: second pass should have hits");
+  check_if_equal(statistics_unlimited.memory_used_in_bytes, statistics_unlimited_first_pass.memory_used_in_bytes,
+                 "unlimited cache: second pass should not use extra memory");
+
+  // now with a limit which is smaller than what the cache needs
+  const int limit_in_MB = 1;
+  if (statistics_unlimited.memory_used_in_bytes < 2000000U)
+    {
+      warning(boost::format("ProjMatrixByBin cache uses only %1% bytes. Test on memory limit will not be effective")
+              % statistics_unlimited.memory_used_in_bytes);
+    }
+  ProjMatrixByBinUsingRayTracing proj_matrix_limited;
+  proj_matrix_limited.set_cache_memory_limit_in_MB(limit_in_MB);
+  proj_matrix_limited.set_up(proj_data_info_sptr, density_sptr);
+  compare_all_rows(proj_matrix_no_cache, proj_matrix_limited, "(limited cache, first pass)");
+  compare_all_rows(proj_matrix_no_cache, proj_matrix_limited, "(limited cache, second pass)");
+  const ProjMatrixByBin::CacheStatistics statistics_limited =
+    proj_matrix_limited.get_cache_statistics();
+  check(statistics_limited.memory_used_in_bytes <= static_cast<std::size_t>(limit_in_MB)*1000000U,
+        "limited cache should stay within its memory limit");
+  check(statistics_limited.num_evictions > 0, "limited cache should evict elements");
+  check(statistics_limited.num_hits > 0, "limited cache should have hits");
+
+  proj_matrix_limited.clear_cache();
+  check_if_equal(proj_matrix_limited.get_cache_statistics().memory_used_in_bytes, std::size_t(0),
+                 "memory used after clear_cache()");
+}
+
+void
+ProjMatrixByBinTests::
+run_tests_from_file(const std::string& version)
+{
+  std::cerr << "\nTests for ProjMatrixByBinFromFile version " << version << "\n";
+  ProjMatrixByBinUsingRayTracing proj_matrix;
+  proj_matrix.set_up(proj_data_info_sptr, density_sptr);
+
+  const std::string prefix = "test_ProjMatrixByBinFromFile_v" + version.substr(0,1);
+  if (!check(ProjMatrixByBinFromFile::write_to_file(prefix, proj_matrix, proj_data_info_sptr,
+                                                    *density_sptr, version) == Succeeded::yes,
+             "writing matrix to file"))
+    return;
+
+  ProjMatrixByBinFromFile proj_matrix_from_file;
+  if (!check(proj_matrix_from_file.parse((prefix + ".hpm").c_str()), "parsing matrix header"))
+    return;
+  // use the template files written above, as they will be identical to what is used internally
+  shared_ptr<const DiscretisedDensity<3,float> >
+    template_density_sptr(read_from_file<DiscretisedDensity<3,float> >(prefix + "_template_density.hv"));
+  shared_ptr<ProjData> template_proj_data_sptr =
+    ProjData::read_from_file(prefix + "_template_proj_data.hs");
+  proj_matrix_from_file.set_up(template_proj_data_sptr->get_proj_data_info_sptr(), template_density_sptr);
+  compare_all_rows(proj_matrix, proj_matrix_from_file, "(from file, version " + version + ")");
+}
+
+void
+ProjMatrixByBinTests::
+run_tests()
+{
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  proj_data_info_sptr.reset(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                          /*span*/1, /*max_delta*/ 1,
+                                                          scanner_sptr->get_num_detectors_per_ring()/2,
+                                                          scanner_sptr->get_default_num_arccorrected_bins(),
+                                                          /*arc_corrected*/ false));
+  density_sptr.reset(new VoxelsOnCartesianGrid<float>(*proj_data_info_sptr));
+
+  run_tests_cache_memory_limit();
+  run_tests_from_file("1.0");
+  run_tests_from_file("2.0");
+}
+
+END_NAMESPACE_STIR
+
+
+USING_NAMESPACE_STIR
+
+int main()
+{
+  ProjMatrixByBinTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -48,6 +48,8 @@ protected:
     shared_ptr<ProjData> _input_sino_sptr;
     const std::vector<shared_ptr<DiscretisedDensity<3,float> > > post_data_processor_bck_proj();
     const std::vector<shared_ptr<ProjData> > pre_data_processor_fwd_proj(const DiscretisedDensity<3,float> &input_image);
+    //! back project with a limited number of accumulation images and compare with the default
+    void test_max_num_accumulation_images();
 };
 
 TestDataProcessorProjectors::TestDataProcessorProjectors(const std::string &sinogram_filename, const float fwhm) :
@@ -175,6 +177,10 @@ run_tests()
 
         // Compare forward projections
         compare_sinos(everything_ok, *fwd_projected_sinos[0],*fwd_projected_sinos[1]);
+
+        // Back project with fewer accumulation images than threads
+        std::cerr << "Tests for back projection with a limited number of accumulation images\n";
+        this->test_max_num_accumulation_images();
     }
     catch(const std::exception &error) {
         std::cerr << "\nHere's the error:\n\t" << error.what() << "\n\n";
@@ -206,12 +212,13 @@ get_data_processor(shared_ptr<DataProcessor<DiscretisedDensity<3,float> > > &dat
 
 static
 shared_ptr<BackProjectorByBin>
-get_back_projector_via_parser(const float fwhm = -1.f)
+get_back_projector_via_parser(const float fwhm = -1.f, const int max_num_accumulation_images = 0)
 {
     std::string buffer;
     std::stringstream parameterstream(buffer);
 
     parameterstream << "Back Projector parameters:=\n";
+    parameterstream << "maximum number of images for accumulation := " << max_num_accumulation_images << "\n";
     if (fwhm > 0)
         parameterstream
                     << "Post Data Processor := Separable Cartesian Metz\n"
@@ -347,6 +354,33 @@ post_data_processor_bck_proj()
     return images;
 }
 
+void
+TestDataProcessorProjectors::
+test_max_num_accumulation_images()
+{
+    // use more threads than images
+    set_num_threads(4);
+    shared_ptr<DiscretisedDensity<3,float> > reference_sptr;
+    for (int max_num_images=0; max_num_images<=2; ++max_num_images) {
+        shared_ptr<DiscretisedDensity<3,float> > image_sptr(
+                new VoxelsOnCartesianGrid<float>(*_input_sino_sptr->get_proj_data_info_sptr()));
+        shared_ptr<BackProjectorByBin> projector_sptr =
+                get_back_projector_via_parser(-1.f, max_num_images);
+        check_if_equal(projector_sptr->get_max_num_accumulation_images(), max_num_images,
+                       "parsing of maximum number of images for accumulation");
+        projector_sptr->set_up(_input_sino_sptr->get_proj_data_info_sptr()->create_shared_clone(),image_sptr);
+        projector_sptr->start_accumulating_in_new_target();
+        projector_sptr->back_project(*_input_sino_sptr);
+        projector_sptr->get_output(*image_sptr);
+        if (max_num_images == 0)
+            reference_sptr = image_sptr;
+        else
+            check_if_equal(*reference_sptr, *image_sptr,
+                           "back projection using " + std::to_string(max_num_images) + " accumulation image(s)");
+    }
+    set_default_num_threads();
+}
+
 END_NAMESPACE_STIR
 
 
@@ -0,0 +1,294 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for the value and gradient of stir::QuadraticPrior and
+  stir::RelativeDifferencePrior
+
+  The results are compared with a straightforward (serial) loop over all voxels and
+  their neighbourhood, i.e. the implementation used before
+  neighbourhood_prior_functions.h was introduced.
+
+  \author STIR developers
+*/
+
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/recon_buildblock/QuadraticPrior.h"
+#include "stir/recon_buildblock/RelativeDifferencePrior.h"
+#include "stir/RunTests.h"
+#include "stir/Succeeded.h"
+#include <boost/random/uniform_01.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+namespace {
+
+// reference potentials, identical to the expressions used in the original loops
+class QuadraticReference
+{
+public:
+  float value(const float weight, const float val_j, const float val_k) const
+  { return weight * square(val_j - val_k)/4; }
+  float derivative(const float weight, const float val_j, const float val_k) const
+  { return weight * (val_j - val_k); }
+};
+
+class RelativeDifferenceReference
+{
+public:
+  RelativeDifferenceReference(const float gamma, const float epsilon)
+    : gamma(gamma), epsilon(epsilon)
+  {}
+  float value(const float weight, const float val_j, const float val_k) const
+  {
+    if (epsilon ==0.0 && val_j == 0.0 && val_k == 0.0)
+      return 0.F;
+    return weight * 0.5 *
+      (pow(val_j-val_k,2)/(val_j+val_k + gamma * std::abs(val_j-val_k) + epsilon ));
+  }
+  float derivative(const float weight, const float val_j, const float val_k) const
+  {
+    if (epsilon ==0.0 && val_j == 0.0 && val_k == 0.0)
+      return 0.F;
+    return weight *
+      (((val_j - val_k) * (gamma * std::abs(val_j - val_k) + val_j + 3 * val_k + 2 * epsilon))/
+       (square((val_j + val_k) + gamma * std::abs(val_j - val_k) + epsilon)));
+  }
+private:
+  const float gamma;
+  const float epsilon;
+};
+
+//! the serial loop over voxels and neighbours, as it was in the prior classes
+template <class PotentialT>
+double
+reference_value(const DiscretisedDensity<3,float>& image, const Array<3,float>& weights,
+                const DiscretisedDensity<3,float> * const kappa_ptr, const PotentialT& potential)
+{
+  double result = 0.;
+  const int min_z = image.get_min_index();
+  const int max_z = image.get_max_index();
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_dz = std::max(weights.get_min_index(), min_z-z);
+      const int max_dz = std::min(weights.get_max_index(), max_z-z);
+      const int min_y = image[z].get_min_index();
+      const int max_y = image[z].get_max_index();
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_dy = std::max(weights[0].get_min_index(), min_y-y);
+          const int max_dy = std::min(weights[0].get_max_index(), max_y-y);
+          const int min_x = image[z][y].get_min_index();
+          const int max_x = image[z][y].get_max_index();
+          for (int x=min_x;x<= max_x;x++)
+            {
+              const int min_dx = std::max(weights[0][0].get_min_index(), min_x-x);
+              const int max_dx = std::min(weights[0][0].get_max_index(), max_x-x);
+              for (int dz=min_dz;dz<=max_dz;++dz)
+                for (int dy=min_dy;dy<=max_dy;++dy)
+                  for (int dx=min_dx;dx<=max_dx;++dx)
+                    {
+                      float current =
+                        potential.value(weights[dz][dy][dx], image[z][y][x], image[z+dz][y+dy][x+dx]);
+                      if (kappa_ptr != 0)
+                        current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+                      result += static_cast<double>(current);
+                    }
+            }
+        }
+    }
+  return result;
+}
+
+template <class PotentialT>
+void
+reference_gradient(DiscretisedDensity<3,float>& gradient,
+                   const DiscretisedDensity<3,float>& image, const Array<3,float>& weights,
+                   const DiscretisedDensity<3,float> * const kappa_ptr, const PotentialT& potential,
+                   const float penalisation_factor)
+{
+  const int min_z = image.get_min_index();
+  const int max_z = image.get_max_index();
+  for (int z=min_z; z<=max_z; z++)
+    {
+      const int min_dz = std::max(weights.get_min_index(), min_z-z);
+      const int max_dz = std::min(weights.get_max_index(), max_z-z);
+      const int min_y = image[z].get_min_index();
+      const int max_y = image[z].get_max_index();
+      for (int y=min_y;y<= max_y;y++)
+        {
+          const int min_dy = std::max(weights[0].get_min_index(), min_y-y);
+          const int max_dy = std::min(weights[0].get_max_index(), max_y-y);
+          const int min_x = image[z][y].get_min_index();
+          const int max_x = image[z][y].get_max_index();
+          for (int x=min_x;x<= max_x;x++)
+            {
+              const int min_dx = std::max(weights[0][0].get_min_index(), min_x-x);
+              const int max_dx = std::min(weights[0][0].get_max_index(), max_x-x);
+              float sum = 0;
+              for (int dz=min_dz;dz<=max_dz;++dz)
+                for (int dy=min_dy;dy<=max_dy;++dy)
+                  for (int dx=min_dx;dx<=max_dx;++dx)
+                    {
+                      float current =
+                        potential.derivative(weights[dz][dy][dx], image[z][y][x], image[z+dz][y+dy][x+dx]);
+                      if (kappa_ptr != 0)
+                        current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+                      sum += current;
+                    }
+              gradient[z][y][x] = sum * penalisation_factor;
+            }
+        }
+    }
+}
+
+} // end of unnamed namespace
+
+/*!
+  \ingroup test
+  \brief Test class for QuadraticPrior and RelativeDifferencePrior
+
+  The value and gradient are computed on an image with random values, with and
+  without \f$\kappa\f$, and compared with the original serial implementation.
+  The gradient is accumulated in the same order for every voxel, so it should be
+  (nearly) identical. The value is summed in a different order, so is compared
+  with a tolerance.
+*/
+class PriorTests : public RunTests
+{
+public:
+  void run_tests();
+private:
+  shared_ptr<DiscretisedDensity<3,float> > image_sptr;
+  shared_ptr<DiscretisedDensity<3,float> > kappa_sptr;
+
+  template <class PriorT, class PotentialT>
+  void run_tests_for_prior(PriorT& prior, const PotentialT& reference_potential,
+                           const bool do_kappa, const std::string& name);
+};
+
+template <class PriorT, class PotentialT>
+void
+PriorTests::
+run_tests_for_prior(PriorT& prior, const PotentialT& reference_potential,
+                    const bool do_kappa, const std::string& name)
+{
+  std::cerr << "Testing " << name << (do_kappa ? " with kappa\n" : " without kappa\n");
+  const float penalisation_factor = 1.3F;
+  prior.set_penalisation_factor(penalisation_factor);
+  if (do_kappa)
+    prior.set_kappa_sptr(kappa_sptr);
+  if (prior.set_up(image_sptr) != Succeeded::yes)
+    {
+      everything_ok = false;
+      std::cerr << "set_up failed for " << name << '\n';
+      return;
+    }
+
+  // this will also initialise the weights
+  const double value = prior.compute_value(*image_sptr);
+  const Array<3,float> weights = prior.get_weights();
+  const DiscretisedDensity<3,float> * const kappa_ptr = do_kappa ? kappa_sptr.get() : 0;
+
+  const double reference =
+    reference_value(*image_sptr, weights, kappa_ptr, reference_potential) * penalisation_factor;
+  {
+    const double old_tolerance = get_tolerance();
+    // values are summed in double precision, but in a different order
+    set_tolerance(1.E-6);
+    check_if_equal(value, reference, name + ": value");
+    set_tolerance(old_tolerance);
+  }
+
+  shared_ptr<DiscretisedDensity<3,float> > gradient_sptr(image_sptr->get_empty_copy());
+  shared_ptr<DiscretisedDensity<3,float> > reference_gradient_sptr(image_sptr->get_empty_copy());
+  prior.compute_gradient(*gradient_sptr, *image_sptr);
+  reference_gradient(*reference_gradient_sptr, *image_sptr, weights, kappa_ptr,
+                     reference_potential, penalisation_factor);
+  check_if_equal(*reference_gradient_sptr, *gradient_sptr, name + ": gradient");
+}
+
+void
+PriorTests::
+run_tests()
+{
+  const IndexRange3D range(0, 9, -12, 11, -13, 14);
+  const CartesianCoordinate3D<float> origin(0.F, 0.F, 0.F);
+  const CartesianCoordinate3D<float> grid_spacing(3.F, 2.F, 2.5F);
+  image_sptr.reset(new VoxelsOnCartesianGrid<float>(range, origin, grid_spacing));
+  kappa_sptr.reset(image_sptr->get_empty_copy());
+
+  // fill with random numbers between 0 and 1 (with some zeroes)
+  typedef boost::mt19937 base_generator_type;
+  // initialize by reproducible seed
+  base_generator_type generator(boost::uint32_t(42));
+  boost::uniform_01<base_generator_type> random01(generator);
+  for (DiscretisedDensity<3,float>::full_iterator iter=image_sptr->begin_all(); iter!=image_sptr->end_all(); ++iter)
+    {
+      const float value = static_cast<float>(random01());
+      *iter = value < .1F ? 0.F : value;
+    }
+  for (DiscretisedDensity<3,float>::full_iterator iter=kappa_sptr->begin_all(); iter!=kappa_sptr->end_all(); ++iter)
+    *iter = static_cast<float>(random01()) + .5F;
+
+  for (int do_kappa=0; do_kappa<=1; ++do_kappa)
+    {
+      {
+        QuadraticPrior<float> prior(/*only_2D*/ false, 1.F);
+        run_tests_for_prior(prior, QuadraticReference(), do_kappa!=0, "QuadraticPrior");
+      }
+      {
+        QuadraticPrior<float> prior(/*only_2D*/ true, 1.F);
+        run_tests_for_prior(prior, QuadraticReference(), do_kappa!=0, "QuadraticPrior (2D)");
+      }
+      {
+        const float gamma = 2.F;
+        const float epsilon = 0.F;
+        RelativeDifferencePrior<float> prior(/*only_2D*/ false, 1.F, gamma, epsilon);
+        run_tests_for_prior(prior, RelativeDifferenceReference(gamma, epsilon), do_kappa!=0,
+                            "RelativeDifferencePrior");
+      }
+      {
+        const float gamma = 1.F;
+        const float epsilon = .01F;
+        RelativeDifferencePrior<float> prior(/*only_2D*/ false, 1.F, gamma, epsilon);
+        run_tests_for_prior(prior, RelativeDifferenceReference(gamma, epsilon), do_kappa!=0,
+                            "RelativeDifferencePrior (epsilon>0)");
+      }
+    }
+}
+
+END_NAMESPACE_STIR
+
+
+USING_NAMESPACE_STIR
+
+int main()
+{
+  PriorTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -8,10 +8,12 @@
   \brief Tests for function in the DFT group
 
   \author Kris Thielemans
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2018, University College London
+    Copyright (C) 2026, STIR developers
     See STIR/LICENSE.txt for details
 */
 #include "stir/VectorWithOffset.h"
@@ -25,8 +27,10 @@
 #include "stir/IndexRange3D.h"
 #include "stir/numerics/norm.h"
 #include "stir/numerics/fourier.h"
+#include "stir/numerics/FourierPlan.h"
 #include <iostream>
 #include <algorithm>
+#include <string>
 
 
 using std::cin;
@@ -59,7 +63,11 @@ inline float rand1()
 
 /*!
   \ingroup numerics_test
-  \brief A simple class to test the erf and erfc functions.
+  \brief A simple class to test the DFT functions.
+
+  1D transforms of various lengths (including lengths that are not a power of 2)
+  are compared with a direct evaluation of the DFT. Multi-dimensional transforms
+  are checked via consistency between the complex and real versions, and the inverse.
 */
 class FourierTests : public RunTests
 {
@@ -70,8 +78,46 @@ public:
 private:
   template <int num_dimensions>
   void test_single_dimension(const IndexRange<num_dimensions>& index_range);
+  void test_1d_against_direct_DFT(const int length, const int sign);
+  //! relative tolerance for the residual norms
+  static const double tolerance;
 };
 
+const double FourierTests::tolerance = 1.E-5;
+
+void FourierTests::test_1d_against_direct_DFT(const int length, const int sign)
+{
+  ArrayC1 c(length);
+  for (int i=0; i<length; ++i)
+    c[i] = std::complex<float>(rand1(), rand1());
+
+  ArrayC1 direct(length);
+  for (int s=0; s<length; ++s)
+    {
+      std::complex<double> sum = 0;
+      for (int r=0; r<length; ++r)
+        sum += std::complex<double>(c[r]) *
+          std::exp(std::complex<double>(0, sign*2*_PI*((static_cast<long>(r)*s)%length)/length));
+      direct[s] = std::complex<float>(sum);
+    }
+
+  const ArrayC1 c_copy(c);
+  fourier(c, sign);
+  c -= direct;
+  const double residual =
+    norm(c.begin_all(), c.end_all())/norm(direct.begin_all(), direct.end_all());
+  check(residual < tolerance,
+        "FT of length " + std::to_string(length) + " with sign " + std::to_string(sign) +
+        " should agree with direct DFT (residual " + std::to_string(residual) + ")");
+
+  c = c_copy;
+  fourier(c, sign);
+  inverse_fourier(c, sign);
+  c -= c_copy;
+  check(norm(c.begin_all(), c.end_all())/norm(c_copy.begin_all(), c_copy.end_all()) < tolerance,
+        "inverse FT of length " + std::to_string(length));
+}
+
 template <int num_dimensions>
 void FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index_range)
 {
@@ -102,15 +148,19 @@ void FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index
   //cout << all_frequencies << complex_array;
   //cout << '\n' << complex_array-all_frequencies;
   complex_array -= all_frequencies;
-  cout << "\nReal FT Residual norm "  <<
-    norm(complex_array.begin_all(), complex_array.end_all())/norm(real_array.begin_all(), real_array.end_all());
+  const double real_residual =
+    norm(complex_array.begin_all(), complex_array.end_all())/norm(all_frequencies.begin_all(), all_frequencies.end_all());
+  cout << "\nReal FT Residual norm "  << real_residual;
+  check(real_residual < tolerance, "FT of real data should agree with complex FT");
 
   real_type test_inverse_real =
     inverse_fourier_for_real_data(pos_frequencies,sign);
   //cout <<"\nv,test "<< v << test_inverse_real << test_inverse_real/v;
   test_inverse_real -= real_array;
-  cout << "\ninverse Real FT Residual norm "  <<
+  const double inverse_real_residual =
     norm(test_inverse_real.begin_all(), test_inverse_real.end_all())/norm(real_array.begin_all(), real_array.end_all());
+  cout << "\ninverse Real FT Residual norm "  << inverse_real_residual;
+  check(inverse_real_residual < tolerance, "inverse FT of real data");
 
   // fill
   {
@@ -124,20 +174,34 @@ void FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index
   fourier(complex_array,sign);
   inverse_fourier(complex_array,sign);
   complex_array -= array_copy;
-  cout << "\ninverse  FT Residual norm "  <<
+  const double inverse_residual =
     norm(complex_array.begin_all(), complex_array.end_all())/norm(array_copy.begin_all(), array_copy.end_all());
+  cout << "\ninverse  FT Residual norm "  << inverse_residual << '\n';
+  check(inverse_residual < tolerance, "inverse FT");
 }
 
 void FourierTests::run_tests()
 {  
-  std::cerr << "Testing Fourier Functions..." << std::endl;
+  std::cerr << "Testing Fourier Functions (using " << FourierPlan::get_backend_name() << ")..." << std::endl;
 
+  std::cerr << "... Testing 1D against direct DFT\n";
+  {
+    const int lengths[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 16, 30, 49, 60, 64, 96, 100, 210 };
+    for (unsigned int i=0; i<sizeof(lengths)/sizeof(lengths[0]); ++i)
+      {
+        test_1d_against_direct_DFT(lengths[i], 1);
+        test_1d_against_direct_DFT(lengths[i], -1);
+      }
+  }
   std::cerr << "... Testing 1D\n";
   test_single_dimension(IndexRange<1>(128));
+  test_single_dimension(IndexRange<1>(90));
   std::cerr << "... Testing 2D\n";
   test_single_dimension(IndexRange2D(128,256));
+  test_single_dimension(IndexRange2D(30,42));
   std::cerr << "... Testing 3D\n";
   test_single_dimension(IndexRange3D(128,256,16));
+  test_single_dimension(IndexRange3D(15,24,10));
 }
 
 END_NAMESPACE_STIR
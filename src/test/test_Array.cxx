@@ -783,6 +783,99 @@ ArrayTests::run_tests()
     run_IO_tests(t1);
   }
 #endif
+  {
+    cerr << "Testing contiguous storage" << endl;
+
+    const IndexRange<3> range(Coordinate3D<int>(-1,1,4),Coordinate3D<int>(1,2,6));
+    Array<3,float> test(range);
+    check(test.is_contiguous(), "test is_contiguous() after construction");
+    {
+      float value = 1.F;
+      for (Array<3,float>::full_iterator iter = test.begin_all(); iter != test.end_all(); ++iter)
+        *iter = value++;
+    }
+    {
+      const float * const data_ptr = test.get_const_full_data_ptr();
+      check(data_ptr == &test[-1][1][4], "test get_const_full_data_ptr() points to first element");
+      Array<3,float>::const_full_iterator iter = test.begin_all_const();
+      for (std::size_t i=0; i<test.size_all(); ++i, ++iter)
+        check_if_equal(data_ptr[i], *iter, "test get_const_full_data_ptr() order of elements");
+      test.release_const_full_data_ptr();
+    }
+    check_if_equal(test.sum(), 171.F, "test sum() on contiguous array");
+    check_if_equal(test.find_max(), 18.F, "test find_max() on contiguous array");
+    check_if_equal(test.find_min(), 1.F, "test find_min() on contiguous array");
+
+    {
+      Array<3,float> test_copy(test);
+      check(test_copy.is_contiguous(), "test is_contiguous() after copy");
+      check_if_equal(test_copy, test, "test copy of contiguous array");
+      float * const data_ptr = test_copy.get_full_data_ptr();
+      data_ptr[3] = 100.F;
+      test_copy.release_full_data_ptr();
+      check_if_equal(test_copy[-1][2][4], 100.F, "test modifying data via get_full_data_ptr()");
+      check_if_equal(test[-1][2][4], 4.F, "test copy does not share data");
+    }
+    {
+      // growing a row makes the array non-contiguous
+      Array<3,float> irregular(test);
+      irregular[0][1].resize(3,7);
+      check(!irregular.is_contiguous(), "test is_contiguous() after resizing a row");
+      check_if_equal(irregular.sum(), test.sum(), "test sum() on non-contiguous array");
+      irregular.fill(2.F);
+      check_if_equal(irregular.sum(), 2.F*irregular.size_all(), "test fill() on non-contiguous array");
+      // but a copy will be contiguous again
+      Array<3,float> irregular_copy(irregular);
+      check(irregular_copy.is_contiguous(), "test is_contiguous() after copy of non-contiguous array");
+      check_if_equal(irregular_copy, irregular, "test copy of non-contiguous array");
+      // as will be an array after resize
+      irregular.resize(range);
+      check(irregular.is_contiguous(), "test is_contiguous() after resize");
+      check_if_equal(irregular.size_all(), test.size_all(), "test size_all() after resize");
+      check_if_equal(irregular[1][2][6], 2.F, "test data is preserved after resize");
+    }
+    {
+      // shrinking a row or resizing a plane also makes the array non-contiguous
+      Array<3,float> irregular(test);
+      check(irregular.is_contiguous(), "test is_contiguous() before shrinking a row");
+      irregular[-1][2].resize(4,5);
+      check(!irregular.is_contiguous(), "test is_contiguous() after shrinking a row");
+      Array<3,float> irregular2(test);
+      irregular2[1].resize(IndexRange<2>(Coordinate2D<int>(1,4),Coordinate2D<int>(3,6)));
+      check(!irregular2.is_contiguous(), "test is_contiguous() after resizing a plane");
+      check(irregular2[1].is_contiguous(), "test is_contiguous() of resized plane");
+      check_if_equal(irregular2.sum(), test.sum(), "test sum() after resizing a plane");
+    }
+    {
+      // const members can be used while a full data pointer is held
+      const float * const data_ptr = test.get_const_full_data_ptr();
+      check_if_equal(test.sum(), 171.F, "test sum() while holding a full data pointer");
+      check_if_equal(test.find_max(), data_ptr[test.size_all()-1], "test find_max() while holding a full data pointer");
+      test.release_const_full_data_ptr();
+    }
+    {
+      // assignment with a different range reallocates
+      Array<3,float> other(IndexRange<3>(Coordinate3D<int>(0,0,0),Coordinate3D<int>(1,1,1)));
+      other = test;
+      check(other.is_contiguous(), "test is_contiguous() after assignment");
+      check_if_equal(other, test, "test assignment with different range");
+      // growing keeps elements and sets new ones to 0
+      other.grow(IndexRange<3>(Coordinate3D<int>(-2,1,4),Coordinate3D<int>(1,2,6)));
+      check(other.is_contiguous(), "test is_contiguous() after grow");
+      check_if_equal(other[-2][1][4], 0.F, "test grow() sets new elements to 0");
+      check_if_equal(other[1][2][6], 18.F, "test grow() keeps elements");
+    }
+    {
+      Array<3,float> empty;
+      check(empty.is_contiguous(), "test is_contiguous() for empty array");
+      check(empty.get_full_data_ptr() == 0, "test get_full_data_ptr() for empty array");
+      empty.release_full_data_ptr();
+      Array<3,float> recycled(test);
+      recycled.recycle();
+      check_if_equal(recycled.size_all(), size_t(0), "test recycle()");
+    }
+  }
+
   {
     cerr << "Testing make_array" <<  endl;
 
@@ -6,11 +6,13 @@
   \brief tests for the stir::ArrayFilter classes
 
   \author Kris Thielemans
+  \author STIR developers
 
 
 */
 /*
     Copyright (C) 2004- 2009, Hammersmith Imanet Ltd
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -34,6 +36,12 @@
 #include "stir/IndexRange2D.h"
 #include "stir/ArrayFilter3DUsingConvolution.h"
 #include "stir/IndexRange3D.h"
+#include "stir/SeparableArrayFunctionObject.h"
+#include "stir/ArrayFunction.h"
+#include "stir/MaximalArrayFilter3D.h"
+#include "stir/MedianArrayFilter3D.h"
+#include "stir/Coordinate3D.h"
+#include "stir/num_threads.h"
 #include "stir/Succeeded.h"
 #include "stir/modulo.h"
 #include "stir/RunTests.h"
@@ -41,6 +49,7 @@
 #include "stir/stream.h"//XXX
 #include <iostream>
 #include <algorithm>
+#include <vector>
 #include <boost/static_assert.hpp>
 
 #ifdef DO_TIMINGS
@@ -438,6 +447,73 @@ ArrayFilterTests::run_tests()
       compare_results_1arg(DFT_filter, conv_filter, test_pos_offset);
     }
   }
+  std::cerr << "\nTesting 3D separable and neighbourhood filters with multiple threads\n";
+  {
+    set_num_threads(4);
+    Array<3,float> test(IndexRange3D(-2,6,1,10,-3,12));
+    // initialise to some arbitrary values (with a few duplicates)
+    {
+      Array<3,float>::full_iterator iter = test.begin_all();
+      for (int i=0; iter != test.end_all(); ++i, ++iter)
+        *iter = static_cast<float>((i*37)%101) - 50.F;
+    }
+    {
+      VectorWithOffset< shared_ptr<ArrayFunctionObject<1,float> > > filters(3);
+      {
+        Array<1,float> kernel(IndexRange<1>(-2,3));
+        for (int i=kernel.get_min_index(); i<=kernel.get_max_index(); ++i)
+          kernel[i] = i*i-3*i+1.F;
+        filters[0].reset(new ArrayFilter1DUsingConvolution<float>(kernel, BoundaryConditions::constant));
+        filters[1].reset(new ArrayFilter1DUsingConvolution<float>(kernel));
+      }
+      {
+        Array<1,float> kernel(IndexRange<1>(0,4));
+        for (int i=kernel.get_min_index(); i<=kernel.get_max_index(); ++i)
+          kernel[i] = 1.F/(i+1);
+        filters[2].reset(new ArrayFilter1DUsingConvolutionSymmetricKernel<float>(kernel));
+      }
+      const SeparableArrayFunctionObject<3,float> separable_filter(filters);
+      Array<3,float> out = test;
+      separable_filter(out);
+      Array<3,float> out_serial = test;
+      in_place_apply_array_functions_on_each_index(out_serial, filters.begin(), filters.end());
+      set_tolerance(out_serial.find_max()*1.E-6);
+      check_if_equal(out, out_serial, "SeparableArrayFunctionObject vs in_place_apply_array_functions_on_each_index");
+    }
+    {
+      const Coordinate3D<int> mask_radius(1,2,1);
+      Array<3,float> max_out(test.get_index_range());
+      Array<3,float> median_out(test.get_index_range());
+      const MaximalArrayFilter3D<float> max_filter(mask_radius);
+      const MedianArrayFilter3D<float> median_filter(mask_radius);
+      max_filter(max_out, test);
+      median_filter(median_out, test);
+
+      // compare with direct computation (only using neighbours inside the array)
+      Array<3,float> max_direct(test.get_index_range());
+      Array<3,float> median_direct(test.get_index_range());
+      std::vector<float> neighbours;
+      for (int z=test.get_min_index(); z<=test.get_max_index(); ++z)
+        for (int y=test[z].get_min_index(); y<=test[z].get_max_index(); ++y)
+          for (int x=test[z][y].get_min_index(); x<=test[z][y].get_max_index(); ++x)
+            {
+              neighbours.clear();
+              for (int nz=std::max(z-mask_radius[1],test.get_min_index()); nz<=std::min(z+mask_radius[1],test.get_max_index()); ++nz)
+                for (int ny=std::max(y-mask_radius[2],test[z].get_min_index()); ny<=std::min(y+mask_radius[2],test[z].get_max_index()); ++ny)
+                  for (int nx=std::max(x-mask_radius[3],test[z][y].get_min_index()); nx<=std::min(x+mask_radius[3],test[z][y].get_max_index()); ++nx)
+                    neighbours.push_back(test[nz][ny][nx]);
+              std::sort(neighbours.begin(), neighbours.end());
+              const std::size_t n = neighbours.size();
+              max_direct[z][y][x] = neighbours[n-1];
+              median_direct[z][y][x] =
+                n%2==1 ? neighbours[n/2] : (neighbours[n/2-1] + neighbours[n/2])/2;
+            }
+      set_tolerance(.001F);
+      check_if_equal(max_out, max_direct, "MaximalArrayFilter3D vs direct computation");
+      check_if_equal(median_out, median_direct, "MedianArrayFilter3D vs direct computation");
+    }
+    set_num_threads();
+  }
 
 }
 
@@ -0,0 +1,176 @@
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::InputStreamWithRecords
+
+  \author STIR developers
+*/
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+
+#include "stir/IO/InputStreamWithRecords.h"
+#include "stir/RunTests.h"
+#include "stir/Succeeded.h"
+#include <sstream>
+#include <iostream>
+#include <string>
+
+START_NAMESPACE_STIR
+
+namespace {
+/*
+  A record with a variable size: the first byte gives the number of bytes
+  that follow (at most 3). The record stores the sum of the data bytes.
+*/
+class TestRecord
+{
+public:
+  TestRecord() : sum(-1), size(0) {}
+
+  std::size_t
+  size_of_record_at_ptr(const char * const data_ptr, const std::size_t,
+                        const bool) const
+  { return static_cast<std::size_t>(data_ptr[0]) + 1; }
+
+  Succeeded
+  init_from_data_ptr(const char * const data_ptr,
+                     const std::size_t size_of_record,
+                     const bool)
+  {
+    this->size = size_of_record;
+    this->sum = 0;
+    for (std::size_t i=1; i<size_of_record; ++i)
+      this->sum += data_ptr[i];
+    return Succeeded::yes;
+  }
+
+  int sum;
+  std::size_t size;
+};
+}
+
+/*!
+  \brief Test class for InputStreamWithRecords
+  \ingroup test
+
+  Uses a stream with records of variable size, and a buffer size that is
+  smaller than the data, such that records straddle buffer boundaries.
+*/
+class InputStreamWithRecordsTests : public RunTests
+{
+public:
+  void run_tests();
+private:
+  void run_tests_for_buffer_size(const std::size_t buffer_size);
+};
+
+void
+InputStreamWithRecordsTests::
+run_tests_for_buffer_size(const std::size_t buffer_size)
+{
+  std::cerr << "Tests for InputStreamWithRecords with buffer size " << buffer_size << "\n";
+  // construct data with records of sizes 1,2,3,4,1,2,...
+  const int num_records = 100;
+  std::string data;
+  int total_sum = 0;
+  for (int r=0; r<num_records; ++r)
+    {
+      const int num_data_bytes = r%4;
+      data.push_back(static_cast<char>(num_data_bytes));
+      for (int i=0; i<num_data_bytes; ++i)
+        {
+          const char value = static_cast<char>((r+i)%10);
+          data.push_back(value);
+          total_sum += value;
+        }
+    }
+  // add some bytes which are not part of the data
+  const std::string prefix("xyz");
+  shared_ptr<std::istream> stream_sptr(new std::istringstream(prefix + data));
+  stream_sptr->seekg(static_cast<std::streamoff>(prefix.size()));
+
+  InputStreamWithRecords<TestRecord, bool> input(stream_sptr, 1, 4, false);
+  input.set_buffer_size(buffer_size);
+  check_if_equal(input.get_buffer_size(), std::max(buffer_size, std::size_t(4)), "buffer size");
+
+  TestRecord record;
+  int sum = 0;
+  int num_records_read = 0;
+  int sum_after_position = 0;
+  InputStreamWithRecords<TestRecord, bool>::SavedPosition saved_position = 0;
+  while (input.get_next_record(record) == Succeeded::yes)
+    {
+      check_if_equal(record.size, static_cast<std::size_t>(num_records_read%4 + 1), "record size");
+      if (num_records_read == num_records/3)
+        saved_position = input.save_get_position();
+      if (num_records_read > num_records/3)
+        sum_after_position += record.sum;
+      sum += record.sum;
+      ++num_records_read;
+    }
+  check_if_equal(num_records_read, num_records, "number of records read");
+  check_if_equal(sum, total_sum, "sum of all records");
+
+  // check position at EOF
+  const InputStreamWithRecords<TestRecord, bool>::SavedPosition eof_position = input.save_get_position();
+  check(input.get_next_record(record) == Succeeded::no, "reading after EOF");
+
+  // go back to saved position
+  check(input.set_get_position(saved_position) == Succeeded::yes, "set_get_position");
+  sum = 0;
+  while (input.get_next_record(record) == Succeeded::yes)
+    sum += record.sum;
+  check_if_equal(sum, sum_after_position, "sum of records after saved position");
+
+  // reset
+  check(input.reset() == Succeeded::yes, "reset");
+  sum = 0;
+  num_records_read = 0;
+  while (input.get_next_record(record) == Succeeded::yes)
+    {
+      sum += record.sum;
+      ++num_records_read;
+    }
+  check_if_equal(num_records_read, num_records, "number of records read after reset");
+  check_if_equal(sum, total_sum, "sum of all records after reset");
+
+  input.set_get_position(eof_position);
+  check(input.get_next_record(record) == Succeeded::no, "reading after going to saved EOF position");
+}
+
+void
+InputStreamWithRecordsTests::
+run_tests()
+{
+  run_tests_for_buffer_size(1);
+  run_tests_for_buffer_size(7);
+  run_tests_for_buffer_size(64);
+  run_tests_for_buffer_size(1000000);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int main()
+{
+  InputStreamWithRecordsTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
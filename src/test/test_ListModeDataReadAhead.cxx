@@ -0,0 +1,235 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+  \ingroup listmode
+
+  \brief Test program for stir::ListModeDataReadAhead
+
+  \par Usage
+  \verbatim
+  test_ListModeDataReadAhead listmode_filename
+  \endverbatim
+  The file should be small, as all records are kept in memory.
+
+  \author STIR developers
+*/
+
+#include "stir/listmode/ListModeDataReadAhead.h"
+#include "stir/listmode/ListModeData.h"
+#include "stir/listmode/ListRecord.h"
+#include "stir/listmode/ListEvent.h"
+#include "stir/listmode/ListTime.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Bin.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/RunTests.h"
+#include "stir/Succeeded.h"
+#include <iostream>
+#include <vector>
+#include <string>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for ListModeDataReadAhead
+
+  The records read with ListModeDataReadAhead (with small batches, such that the
+  reading thread has to wait for the consumer) are compared with those read
+  directly via ListModeData::get_next_record(). This is done for the whole file,
+  after reset(), and after set_get_position() to a position saved while reading
+  (both with ListModeData::save_get_position() and
+  ListModeDataReadAhead::save_get_position()).
+*/
+class ListModeDataReadAheadTests : public RunTests
+{
+public:
+  explicit ListModeDataReadAheadTests(const std::string& filename)
+    : filename(filename)
+  {}
+  void run_tests();
+private:
+  //! summary of a record that can be compared
+  struct RecordInfo
+  {
+    bool is_event;
+    bool is_time;
+    bool is_prompt;
+    double time;
+    int segment_num, axial_pos_num, view_num, tangential_pos_num;
+    bool operator==(const RecordInfo& other) const
+    {
+      return is_event == other.is_event && is_time == other.is_time &&
+        is_prompt == other.is_prompt && time == other.time &&
+        segment_num == other.segment_num && axial_pos_num == other.axial_pos_num &&
+        view_num == other.view_num && tangential_pos_num == other.tangential_pos_num;
+    }
+  };
+  typedef std::vector<RecordInfo> RecordInfos;
+
+  std::string filename;
+  shared_ptr<ListModeData> lm_data_sptr;
+
+  RecordInfo get_record_info(const ListRecord& record) const;
+  //! read (at most) \a max_num_records records directly from the list mode data
+  RecordInfos read_directly(const std::size_t max_num_records);
+  //! read (at most) \a max_num_records records using \a read_ahead
+  RecordInfos read_ahead(ListModeDataReadAhead& read_ahead, const std::size_t max_num_records);
+  void check_if_equal_records(const RecordInfos& expected, const RecordInfos& found, const std::string& str);
+};
+
+ListModeDataReadAheadTests::RecordInfo
+ListModeDataReadAheadTests::
+get_record_info(const ListRecord& record) const
+{
+  RecordInfo info;
+  info.is_event = record.is_event();
+  info.is_time = record.is_time();
+  info.is_prompt = false;
+  info.time = info.is_time ? record.time().get_time_in_secs() : 0.;
+  info.segment_num = info.axial_pos_num = info.view_num = info.tangential_pos_num = 0;
+  if (info.is_event)
+    {
+      info.is_prompt = record.event().is_prompt();
+      Bin bin;
+      record.event().get_bin(bin, *lm_data_sptr->get_proj_data_info_sptr());
+      info.segment_num = bin.segment_num();
+      info.axial_pos_num = bin.axial_pos_num();
+      info.view_num = bin.view_num();
+      info.tangential_pos_num = bin.tangential_pos_num();
+    }
+  return info;
+}
+
+ListModeDataReadAheadTests::RecordInfos
+ListModeDataReadAheadTests::
+read_directly(const std::size_t max_num_records)
+{
+  RecordInfos infos;
+  shared_ptr<ListRecord> record_sptr = lm_data_sptr->get_empty_record_sptr();
+  while (infos.size() < max_num_records &&
+         lm_data_sptr->get_next_record(*record_sptr) == Succeeded::yes)
+    infos.push_back(get_record_info(*record_sptr));
+  return infos;
+}
+
+ListModeDataReadAheadTests::RecordInfos
+ListModeDataReadAheadTests::
+read_ahead(ListModeDataReadAhead& read_ahead, const std::size_t max_num_records)
+{
+  RecordInfos infos;
+  ListModeDataReadAhead::RecordBatch records;
+  while (infos.size() < max_num_records)
+    {
+      const std::size_t num_records = read_ahead.get_next_records(records);
+      if (num_records == 0)
+        break;
+      for (std::size_t i=0; i<num_records; ++i)
+        infos.push_back(get_record_info(*records[i]));
+    }
+  return infos;
+}
+
+void
+ListModeDataReadAheadTests::
+check_if_equal_records(const RecordInfos& expected, const RecordInfos& found, const std::string& str)
+{
+  if (!check_if_equal(expected.size(), found.size(), str + ": number of records"))
+    return;
+  for (std::size_t i=0; i<expected.size(); ++i)
+    if (!check(expected[i] == found[i], str + ": record " + std::to_string(i)))
+      return;
+}
+
+void
+ListModeDataReadAheadTests::
+run_tests()
+{
+  std::cerr << "Testing ListModeDataReadAhead with " << filename << '\n';
+  lm_data_sptr = read_from_file<ListModeData>(filename);
+
+  const RecordInfos all_records = read_directly(std::size_t(-1));
+  if (!check(all_records.size() > 20, "list mode file should have at least 20 records"))
+    return;
+  const std::size_t batch_size = all_records.size()/7;
+  const std::size_t part_size = (all_records.size()/batch_size/2)*batch_size;
+
+  // save a position half-way through the file
+  lm_data_sptr->reset();
+  read_directly(part_size);
+  const ListModeData::SavedPosition half_way_pos = lm_data_sptr->save_get_position();
+  const RecordInfos second_half(all_records.begin() + part_size, all_records.end());
+
+  lm_data_sptr->reset();
+  ListModeDataReadAhead read_ahead_data(lm_data_sptr, batch_size, /* max_num_batches */ 2);
+  {
+    std::cerr << "Reading all records\n";
+    check_if_equal_records(all_records, read_ahead(read_ahead_data, std::size_t(-1)), "all records");
+    ListModeDataReadAhead::RecordBatch records;
+    check_if_equal(read_ahead_data.get_next_records(records), std::size_t(0), "no records after end of file");
+  }
+  {
+    std::cerr << "Reading after reset()\n";
+    check(read_ahead_data.reset() == Succeeded::yes, "reset");
+    check_if_equal_records(all_records, read_ahead(read_ahead_data, std::size_t(-1)), "all records after reset");
+  }
+  {
+    std::cerr << "Reading after set_get_position()\n";
+    check(read_ahead_data.set_get_position(half_way_pos) == Succeeded::yes, "set_get_position");
+    check_if_equal_records(second_half, read_ahead(read_ahead_data, std::size_t(-1)), "records after set_get_position");
+  }
+  {
+    std::cerr << "Reading after save_get_position()\n";
+    read_ahead_data.reset();
+    check_if_equal_records(RecordInfos(all_records.begin(), all_records.begin() + part_size),
+                           read_ahead(read_ahead_data, part_size), "first half");
+    // the reading thread will have read ahead, but the saved position should be where we are
+    const ListModeData::SavedPosition pos = read_ahead_data.save_get_position();
+    check_if_equal_records(second_half, read_ahead(read_ahead_data, std::size_t(-1)), "records after save_get_position");
+    check(read_ahead_data.set_get_position(pos) == Succeeded::yes, "set_get_position to saved position");
+    check_if_equal_records(second_half, read_ahead(read_ahead_data, std::size_t(-1)), "records after returning to saved position");
+    // and once more, now after set_get_position
+    check(read_ahead_data.set_get_position(half_way_pos) == Succeeded::yes, "set_get_position");
+    read_ahead(read_ahead_data, batch_size);
+    const ListModeData::SavedPosition pos2 = read_ahead_data.save_get_position();
+    read_ahead_data.reset();
+    check(read_ahead_data.set_get_position(pos2) == Succeeded::yes, "set_get_position to 2nd saved position");
+    check_if_equal_records(RecordInfos(second_half.begin() + batch_size, second_half.end()),
+                           read_ahead(read_ahead_data, std::size_t(-1)), "records after returning to 2nd saved position");
+  }
+}
+
+END_NAMESPACE_STIR
+
+
+USING_NAMESPACE_STIR
+
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+    {
+      std::cerr << "Usage : " << argv[0] << " listmode_filename\n";
+      return EXIT_FAILURE;
+    }
+  ListModeDataReadAheadTests tests(argv[1]);
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,160 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR developers
+    This file is part of STIR.
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+  \ingroup listmode
+
+  \brief Test program for the integer histogramming of stir::LmToProjData
+
+  \par Usage
+  \verbatim
+  test_LmToProjData listmode_filename template_projdata_filename
+  \endverbatim
+  Output files are written in the current directory.
+
+  \author STIR developers
+*/
+
+#include "stir/listmode/LmToProjData.h"
+#include "stir/ProjData.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/RunTests.h"
+#include "stir/is_null_ptr.h"
+#include <boost/format.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for LmToProjData
+
+  Bins the list mode data with the (multi-pass) floating point histogramming
+  and with the integer histogramming, once with all segments in memory and once with
+  only 1 segment in memory (such that the other segments are written to temporary files).
+  This is done with and without subtraction of the delayeds. All results should be identical.
+*/
+class LmToProjDataTests : public RunTests
+{
+public:
+  LmToProjDataTests(const std::string& list_mode_filename, const std::string& template_filename)
+    : list_mode_filename(list_mode_filename), template_filename(template_filename)
+  {}
+  void run_tests();
+private:
+  std::string list_mode_filename;
+  std::string template_filename;
+
+  //! run LmToProjData and return the output
+  shared_ptr<ProjData> bin_data(const std::string& output_prefix,
+                                const bool use_integer_histogramming,
+                                const int num_segments_in_memory,
+                                const bool store_delayeds);
+  void compare(const ProjData& expected, const ProjData& found, const std::string& str);
+};
+
+shared_ptr<ProjData>
+LmToProjDataTests::
+bin_data(const std::string& output_prefix,
+         const bool use_integer_histogramming,
+         const int num_segments_in_memory,
+         const bool store_delayeds)
+{
+  std::stringstream parameters;
+  parameters <<
+    "lm_to_projdata Parameters:=\n"
+    "input file := " << list_mode_filename << "\n"
+    "template_projdata := " << template_filename << "\n"
+    "output filename prefix := " << output_prefix << "\n"
+    "store prompts := 1\n"
+    "store delayeds := " << (store_delayeds ? 1 : 0) << "\n"
+    "num_segments_in_memory := " << num_segments_in_memory << "\n"
+    "use integer histogramming := " << (use_integer_histogramming ? 1 : 0) << "\n"
+    "End :=\n";
+  LmToProjData lm_to_projdata;
+  if (!check(lm_to_projdata.parse(parameters), "parsing LmToProjData parameters"))
+    return shared_ptr<ProjData>();
+  lm_to_projdata.process_data();
+  return ProjData::read_from_file(output_prefix + "_f1g1d0b0.hs");
+}
+
+void
+LmToProjDataTests::
+compare(const ProjData& expected, const ProjData& found, const std::string& str)
+{
+  if (!check_if_equal(expected.get_min_segment_num(), found.get_min_segment_num(), str + ": min segment") ||
+      !check_if_equal(expected.get_max_segment_num(), found.get_max_segment_num(), str + ": max segment"))
+    return;
+  for (int segment_num = expected.get_min_segment_num(); segment_num <= expected.get_max_segment_num(); ++segment_num)
+    {
+      const SegmentBySinogram<float> expected_segment = expected.get_segment_by_sinogram(segment_num);
+      const SegmentBySinogram<float> found_segment = found.get_segment_by_sinogram(segment_num);
+      check_if_equal(expected_segment, found_segment,
+                     boost::str(boost::format("%1%: segment %2%") % str % segment_num));
+    }
+}
+
+void
+LmToProjDataTests::
+run_tests()
+{
+  std::cerr << "Testing LmToProjData with " << list_mode_filename << '\n';
+  for (int store_delayeds = 0; store_delayeds <= 1; ++store_delayeds)
+    {
+      const std::string suffix = store_delayeds ? "_delayeds" : "";
+      std::cerr << "\nFloating point histogramming" << suffix << '\n';
+      const shared_ptr<ProjData> reference_sptr =
+        bin_data("test_LmToProjData_float" + suffix, false, -1, store_delayeds != 0);
+      if (is_null_ptr(reference_sptr))
+        return;
+      check(reference_sptr->get_segment_by_sinogram(0).find_max() > 0, "binned data should be non-zero");
+
+      std::cerr << "\nInteger histogramming" << suffix << '\n';
+      const shared_ptr<ProjData> integer_sptr =
+        bin_data("test_LmToProjData_integer" + suffix, true, -1, store_delayeds != 0);
+      if (!is_null_ptr(integer_sptr))
+        compare(*reference_sptr, *integer_sptr, "integer histogramming" + suffix);
+
+      std::cerr << "\nInteger histogramming with 1 segment in memory" << suffix << '\n';
+      const shared_ptr<ProjData> spilled_sptr =
+        bin_data("test_LmToProjData_integer_1seg" + suffix, true, 1, store_delayeds != 0);
+      if (!is_null_ptr(spilled_sptr))
+        compare(*reference_sptr, *spilled_sptr, "integer histogramming with 1 segment in memory" + suffix);
+    }
+}
+
+END_NAMESPACE_STIR
+
+
+USING_NAMESPACE_STIR
+
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+    {
+      std::cerr << "Usage : " << argv[0] << " listmode_filename template_projdata_filename\n";
+      return EXIT_FAILURE;
+    }
+  LmToProjDataTests tests(argv[1], argv[2]);
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -7,11 +7,13 @@
 
   \author Kris Thielemans
   \author Daniel Deidda
+  \author STIR developers
 
 */
 /*
     Copyright (C) 2015, 2020 University College London
     Copyright (C) 2020, National Physical Laboratory
+    Copyright (C) 2026, STIR developers
     This file is part of STIR.
 
     This file is free software; you can redistribute it and/or modify
@@ -33,12 +35,18 @@
 #include "stir/ProjDataInfo.h"
 #include "stir/Sinogram.h"
 #include "stir/Viewgram.h"
+#include "stir/ViewSegmentNumbers.h"
 #include "stir/Succeeded.h"
 #include "stir/RunTests.h"
 #include "stir/Scanner.h"
 #include "stir/copy_fill.h"
 #include "stir/IndexRange3D.h"
 #include "stir/CPUTimer.h"
+#include "stir/is_null_ptr.h"
+#include "stir/num_threads.h"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -54,6 +62,9 @@ public:
 private:
   void run_tests_on_proj_data(ProjData&);
   void run_tests_in_memory_only(ProjDataInMemory&);
+  //! checks get_viewgram and get_sinogram from multiple threads against serial access
+  /*! If \a test_writing is \c true, set_viewgram is checked as well. */
+  void run_tests_concurrent_access(ProjData&, const bool test_writing);
 };
 
 void
@@ -212,6 +223,18 @@ ProjDataTests::run_tests_in_memory_only(ProjDataInMemory& proj_data)
       const Viewgram<float> viewgram=proj_data.get_viewgram(bin.view_num(), bin.segment_num());
       check_if_equal(bin.get_bin_value(),viewgram[bin.axial_pos_num()][bin.tangential_pos_num()],
             "ProjDataInMemory::set_bin_value/get_viewgram not consistent");
+      // check get_bin_value in oblique segments (which are not stored in order of segment number)
+      for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
+        {
+          const Bin oblique_bin(segment_num, proj_data.get_max_view_num()/3,
+                                proj_data.get_max_axial_pos_num(segment_num),
+                                proj_data.get_min_tangential_pos_num()+1);
+          const Viewgram<float> oblique_viewgram=proj_data.get_viewgram(oblique_bin.view_num(), segment_num);
+          if (!check_if_equal(proj_data.get_bin_value(oblique_bin),
+                              oblique_viewgram[oblique_bin.axial_pos_num()][oblique_bin.tangential_pos_num()],
+                              "ProjDataInMemory::get_bin_value/get_viewgram not consistent for oblique segment"))
+            break;
+        }
   }
   std::cerr << "test if copy_to is consistent with iterators\n";
   {
@@ -236,6 +259,68 @@ ProjDataTests::run_tests_in_memory_only(ProjDataInMemory& proj_data)
   }
 }
 
+void
+ProjDataTests::run_tests_concurrent_access(ProjData& proj_data, const bool test_writing)
+{
+  std::cerr << "\ntest concurrent access\n";
+  std::vector<ViewSegmentNumbers> vs_nums;
+  for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
+    for (int view_num = proj_data.get_min_view_num(); view_num <= proj_data.get_max_view_num(); ++view_num)
+      vs_nums.push_back(ViewSegmentNumbers(view_num, segment_num));
+  const int num_vs = static_cast<int>(vs_nums.size());
+
+  if (test_writing)
+    {
+      std::vector<Succeeded> write_succeeded(vs_nums.size(), Succeeded::no);
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int i=0; i<num_vs; ++i)
+        {
+          Viewgram<float> viewgram = proj_data.get_empty_viewgram(vs_nums[i].view_num(), vs_nums[i].segment_num());
+          viewgram.fill(static_cast<float>(i));
+          write_succeeded[i] = proj_data.set_viewgram(viewgram);
+        }
+      check(std::count(write_succeeded.begin(), write_succeeded.end(), Succeeded::yes) == num_vs,
+            "concurrent set_viewgram succeeded");
+    }
+
+  std::vector<shared_ptr<Viewgram<float> > > viewgrams(vs_nums.size());
+#ifdef STIR_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i=0; i<num_vs; ++i)
+    viewgrams[i].reset(new Viewgram<float>(proj_data.get_viewgram(vs_nums[i].view_num(), vs_nums[i].segment_num())));
+
+  for (int i=0; i<num_vs; ++i)
+    {
+      const Viewgram<float> expected = proj_data.get_viewgram(vs_nums[i].view_num(), vs_nums[i].segment_num());
+      if (!check_if_equal(*viewgrams[i], expected,
+                          boost::str(boost::format("concurrent get_viewgram for view %1% segment %2%")
+                                     % vs_nums[i].view_num() % vs_nums[i].segment_num())))
+        break;
+      if (test_writing &&
+          !check_if_equal(expected.find_max(), static_cast<float>(i),
+                          "value written by concurrent set_viewgram"))
+        break;
+    }
+
+  const int segment_num = proj_data.get_max_segment_num();
+  const int min_axial_pos_num = proj_data.get_min_axial_pos_num(segment_num);
+  const int num_axial_poss = proj_data.get_num_axial_poss(segment_num);
+  std::vector<shared_ptr<Sinogram<float> > > sinograms(num_axial_poss);
+#ifdef STIR_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i=0; i<num_axial_poss; ++i)
+    sinograms[i].reset(new Sinogram<float>(proj_data.get_sinogram(min_axial_pos_num + i, segment_num)));
+
+  for (int i=0; i<num_axial_poss; ++i)
+    if (!check_if_equal(*sinograms[i], proj_data.get_sinogram(min_axial_pos_num + i, segment_num),
+                        "concurrent get_sinogram"))
+      break;
+}
+
 void
 ProjDataTests::
 run_tests()
@@ -269,6 +354,34 @@ run_tests()
                     "test_proj_data.hs", std::ios::in|std::ios::out|std::ios::trunc);
   run_tests_on_proj_data(proj_data_in_memory);
 
+  std::cerr<< "\n-----------------Concurrent access tests\n";
+  {
+    shared_ptr<ProjDataInfo> small_proj_data_info_sptr
+      (ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                     /*span*/1, 4,/*views*/ 48, /*tang_pos*/64, /*arc_corrected*/ true)
+       );
+    set_num_threads(std::max(get_default_num_threads(), 4));
+
+    ProjDataInMemory small_proj_data_in_memory(exam_info_sptr, small_proj_data_info_sptr);
+    std::cerr << "\nProjDataInMemory";
+    run_tests_concurrent_access(small_proj_data_in_memory, true);
+
+    {
+      std::cerr << "\nProjDataInterfile (read/write)";
+      ProjDataInterfile proj_data_interfile(exam_info_sptr, small_proj_data_info_sptr,
+                                            "test_proj_data_concurrent.hs",
+                                            std::ios::in|std::ios::out|std::ios::trunc);
+      run_tests_concurrent_access(proj_data_interfile, true);
+    }
+    // read-only data from file uses a stream per thread
+    shared_ptr<ProjData> proj_data_from_file_sptr = ProjData::read_from_file("test_proj_data_concurrent.hs");
+    if (check(!is_null_ptr(proj_data_from_file_sptr), "reading test_proj_data_concurrent.hs"))
+      {
+        std::cerr << "\nProjDataFromStream (read-only)";
+        run_tests_concurrent_access(*proj_data_from_file_sptr, false);
+      }
+    set_default_num_threads();
+  }
 }
 END_NAMESPACE_STIR
 
@@ -7,6 +7,13 @@
 
   \brief Program that writes a projection matrix by bin to file
 
+  \par Usage
+  \verbatim
+    write_proj_matrix_by_bin [--version 1.0|2.0] \
+       output-filename [proj_data_file [projmatrixbybin-parfile [template-image]]]
+  \endverbatim
+  The default is to write version 2.0 files, see stir::ProjMatrixByBinFromFile.
+
   \author Kris Thielemans
   
 */
@@ -50,10 +57,18 @@ int
 main(int argc, char **argv)
 {  
   USING_NAMESPACE_STIR
-  if (argc==1 || argc>5)
+  const char * const program_name = argv[0];
+  std::string version = "2.0";
+  if (argc>2 && std::string(argv[1]) == "--version")
+    {
+      version = argv[2];
+      argc -= 2; argv += 2;
+    }
+  if (argc==1 || argc>5 || (version != "1.0" && version != "2.0"))
   {
-    cerr <<"Usage: " << argv[0] << " \\\n"
-	 << "\toutput-filename [proj_data_file [projmatrixbybin-parfile [template-image]]]\n";
+    cerr <<"Usage: " << program_name << " [--version 1.0|2.0] \\\n"
+	 << "\toutput-filename [proj_data_file [projmatrixbybin-parfile [template-image]]]\n"
+	 << "The default is to write version 2.0 files.\n";
     exit(EXIT_FAILURE);
   }
   const std::string output_filename_prefix=
@@ -122,7 +137,8 @@ main(int argc, char **argv)
     write_to_file(output_filename_prefix, 
 		  *proj_matrix_sptr, 
 		  proj_data_info_sptr,
-		  *image_sptr) == Succeeded::yes ?
+		  *image_sptr,
+		  version) == Succeeded::yes ?
     EXIT_SUCCESS : EXIT_FAILURE;
 }
 